@@ -1,8 +1,8 @@
 /**
  * @file BoardConf.h
  * @author Planeson, Red Bird Racing
- * @date 2026-01-15
- * @version 2.0
+ * @date 2026-10-17
+ * @version 2.4
  * @brief Board configuration for the VCU (Vehicle Control Unit)
  * @details This file defines the board configuration and pin mappings for different versions of the VCU and for Arduino Uno.
  * Define the appropriate macro to select the desired board configuration.
@@ -16,11 +16,28 @@
  * - Undefined: no pins defined, intentional compilation error
  *
  * @note Only one option should be uncommented at a time.
+ *
+ * @par MCP2515 INT pins
+ * Define @c INT_CAN_MOTOR, @c INT_CAN_BMS, @c INT_CAN_DL (here or as build flags) to the pin wired to that controller's INT line,
+ * it must be an external interrupt pin (PD2/INT0 or PD3/INT1). That bus is then received by interrupt, see CanRx.
+ * Leave undefined if not wired, that bus is polled.
+ *
+ * @par CAN channels
+ * @c CAN_CHANNEL_MOTOR, @c CAN_CHANNEL_BMS, @c CAN_CHANNEL_DL and @c CAN_CHANNEL_DEBUG pick the controller carrying that
+ * logical bus (the McpIndex value: 0 @c CS_CAN_MOTOR, 1 @c CS_CAN_BMS, 2 @c CS_CAN_DL), see CanChannelMap.
+ * Point a bus at another controller if its transceiver isn't fitted or doesn't work. Only the controllers in use
+ * (@c CAN_USES_MCP) get queues, health polling and a Scheduler lane.
+ *
+ * @par ADC
+ * @c ADC_FREE_RUNNING and @c ADC_OVERSAMPLE_BITS pick how the analog inputs are sampled, see AdcSampler.
+ * ADC_BITS is the resolution the pedal inputs, Curves.hpp and the telemetry work in.
  */
 
 #ifndef BOARDCONF_H
 #define BOARDCONF_H
 
+#include <stdint.h>
+
 // select the board configuration to use
 #define USE_VCU_V3_2
 
@@ -57,6 +74,10 @@
 
 // === MCP2515 crystal frequency ===
 #define MCP2515_CRYSTAL_FREQ MCP_20MHZ
+
+// === MCP2515 INT pins, PD2/PD3 are free, uncomment once wired ===
+// #define INT_CAN_DL PIN_PD2
+// #define INT_CAN_MOTOR PIN_PD3
 #endif // USE_VCU_V3_2
 
 // VCU v3
@@ -195,5 +216,47 @@
 #endif // USE_ARDUINO_PINS
 
 #define CAN_RATE CAN_500KBPS
+#define CAN_RATE_KBPS 500 // CAN_RATE in kbit/s, for the bus load in CanHealth
+
+// === logical CAN bus -> controller, all on the datalogger controller until the motor and BMS transceivers work ===
+#ifndef CAN_CHANNEL_MOTOR
+#define CAN_CHANNEL_MOTOR 2
+#endif
+#ifndef CAN_CHANNEL_BMS
+#define CAN_CHANNEL_BMS 2
+#endif
+#ifndef CAN_CHANNEL_DL
+#define CAN_CHANNEL_DL 2
+#endif
+#ifndef CAN_CHANNEL_DEBUG
+#define CAN_CHANNEL_DEBUG 2
+#endif
+#define CAN_USES_MCP(index) (CAN_CHANNEL_MOTOR == (index) || CAN_CHANNEL_BMS == (index) || \
+                             CAN_CHANNEL_DL == (index) || CAN_CHANNEL_DEBUG == (index))
+
+// === ADC, if ADC_FREE_RUNNING is 0 main.cpp calls analogRead() for every sample as before, blocking ~110us each ===
+#ifndef ADC_FREE_RUNNING
+#define ADC_FREE_RUNNING 1
+#endif
+// extra bits the oversampled inputs get, 4^n conversions are summed per value, n bits kept:
+// 2 (default) gives 12 bit values from a window of the last 16 conversions, 0 without the free-running ADC
+#ifndef ADC_OVERSAMPLE_BITS
+#if ADC_FREE_RUNNING
+#define ADC_OVERSAMPLE_BITS 2
+#else
+#define ADC_OVERSAMPLE_BITS 0
+#endif
+#endif
+static_assert(ADC_FREE_RUNNING || ADC_OVERSAMPLE_BITS == 0, "oversampling needs ADC_FREE_RUNNING");
+static_assert(ADC_OVERSAMPLE_BITS <= 3, "the window sum of more than 64 conversions doesn't fit 16 bits");
+
+constexpr uint8_t ADC_BITS = 10 + ADC_OVERSAMPLE_BITS; /**< Bits of the oversampled inputs, what Pedal and Curves.hpp work in */
+
+/**
+ * @brief Scales a 10 bit ADC value to ADC_BITS, for limits and tables calibrated with analogRead().
+ * @param raw 10 bit ADC value.
+ * @return Value in ADC_BITS.
+ */
+constexpr uint16_t adcScale(const uint16_t raw) { return raw << ADC_OVERSAMPLE_BITS; }
 
 #endif // BOARDCONF_H
\ No newline at end of file
@@ -2,8 +2,8 @@
  * @file CarState.hpp
  * @author Planeson, Red Bird Racing
  * @brief Definition of the CarState structure representing the state of the car
- * @version 1.4.1
- * @date 2026-02-09
+ * @version 1.10
+ * @date 2026-10-17
  * @see can.h, Enums.h
  */
 
@@ -11,22 +11,26 @@
 #define CAR_STATE_HPP
 
 #include "Enums.hpp"
+#include "BoardConf.h" // ADC_OVERSAMPLE_BITS
 #include <can.h>
 #include <stdint.h>
 
 constexpr canid_t TELEMETRY_PEDAL_MSG = 0x700; /**< Telemetry: Pedal readings message */
 constexpr canid_t TELEMETRY_MOTOR_MSG = 0x701; /**< Telemetry: Digital signals message */
 constexpr canid_t TELEMETRY_BMS_MSG = 0x710;   /**< Telemetry: Car state message */
+constexpr canid_t TELEMETRY_SCHEDULER_MSG = 0x720; /**< Telemetry: Scheduler timing stats message */
+constexpr canid_t TELEMETRY_CAN_MSG = 0x730;       /**< Telemetry: CAN controller health message */
+constexpr canid_t TELEMETRY_LATENCY_MSG = 0x740;   /**< Telemetry: pedal to torque command latency message */
 
 /**
  * @brief Telemetry frame structure for the Pedals.
  */
 struct TelemetryFramePedal
 {
-    uint16_t apps_5v;  /**< ADC reading for 5V APPS */
-    uint16_t apps_3v3; /**< ADC reading for 3.3V APPS */
-    uint16_t brake;       /**< ADC reading for brake pedal */
-    uint16_t hall_sensor; /**< ADC reading for hall sensor */
+    uint16_t apps_5v;  /**< ADC reading for 5V APPS, ADC_BITS */
+    uint16_t apps_3v3; /**< ADC reading for 3.3V APPS, ADC_BITS */
+    uint16_t brake;       /**< ADC reading for brake pedal, ADC_BITS */
+    uint16_t hall_sensor; /**< ADC reading for hall sensor, 10 bit */
 
     /** @brief Union of bits for car status besides Pedal */
     union StateByteStatus
@@ -72,17 +76,18 @@ struct TelemetryFramePedal
 
     /**
      * @brief Converts the TelemetryFramePedal to a CAN frame.
+     * The pedal readings are sent as 10 bit, the oversampled bits are dropped to keep the frame layout.
      * @return CAN frame representing the Pedal telemetry signals.
      */
     constexpr can_frame toCanFrame() const
     {
         return can_frame{
-            TELEMETRY_PEDAL_MSG,               // can_id
-            8,                                 // can_dlc
-            static_cast<__u8>(apps_5v & 0xFF), // data
-            static_cast<__u8>(((apps_5v >> 8) & 0x03) | ((apps_3v3 & 0x3F) << 2)),
-            static_cast<__u8>(((apps_3v3 >> 6) & 0x0F) | ((brake & 0x0F) << 4)),
-            static_cast<__u8>(((brake >> 4) & 0x3F) | ((hall_sensor & 0x03) << 6)),
+            TELEMETRY_PEDAL_MSG,                                          // can_id
+            8,                                                            // can_dlc
+            static_cast<__u8>((apps_5v >> ADC_OVERSAMPLE_BITS) & 0xFF), // data
+            static_cast<__u8>(((apps_5v >> (8 + ADC_OVERSAMPLE_BITS)) & 0x03) | (((apps_3v3 >> ADC_OVERSAMPLE_BITS) & 0x3F) << 2)),
+            static_cast<__u8>(((apps_3v3 >> (6 + ADC_OVERSAMPLE_BITS)) & 0x0F) | (((brake >> ADC_OVERSAMPLE_BITS) & 0x0F) << 4)),
+            static_cast<__u8>(((brake >> (4 + ADC_OVERSAMPLE_BITS)) & 0x3F) | ((hall_sensor & 0x03) << 6)),
             static_cast<__u8>((hall_sensor >> 2) & 0xFF),
             status.byte,
             faults.byte,
@@ -148,18 +153,117 @@ struct TelemetryFrameBms
     }
 };
 
+/**
+ * @brief Telemetry frame structure for the Scheduler timing stats.
+ * Multiplexed, one stats entry per frame.
+ * @see Scheduler::getStatsEntry
+ */
+struct TelemetryFrameScheduler
+{
+    uint8_t mux;        /**< Which entry the values belong to, see Scheduler::getStatsEntry */
+    uint16_t values[3]; /**< Values of the entry */
+
+    /**
+     * @brief Converts the TelemetryFrameScheduler to a CAN frame.
+     * @return CAN frame representing the telemetry Scheduler stats.
+     */
+    constexpr can_frame toCanFrame() const
+    {
+        return can_frame{
+            TELEMETRY_SCHEDULER_MSG, // can_id
+            7,                       // can_dlc
+            mux,
+            static_cast<__u8>(values[0] & 0xFF),
+            static_cast<__u8>((values[0] >> 8) & 0xFF),
+            static_cast<__u8>(values[1] & 0xFF),
+            static_cast<__u8>((values[1] >> 8) & 0xFF),
+            static_cast<__u8>(values[2] & 0xFF),
+            static_cast<__u8>((values[2] >> 8) & 0xFF)};
+    }
+};
+
+/**
+ * @brief Telemetry frame structure for the health of one CAN controller.
+ * Multiplexed, one controller per frame.
+ * @see CanHealth::report
+ */
+struct TelemetryFrameCan
+{
+    McpIndex bus;      /**< Controller the values belong to */
+    CanBusState state; /**< Error state at the last poll */
+    uint8_t tec;       /**< Transmit error counter at the last poll */
+    uint8_t rec;       /**< Receive error counter at the last poll */
+    uint8_t load;      /**< Bus load between the last two polls, in %, frames sent and received by this controller */
+    uint8_t bus_off;   /**< Bus-off events, saturating */
+    uint8_t reinits;   /**< Reinitialisations after bus-off, saturating */
+    uint16_t lost;     /**< Frames lost: sends refused or dropped, RX ring drops and RX buffer overflows, saturating */
+
+    /**
+     * @brief Converts the TelemetryFrameCan to a CAN frame.
+     * @return CAN frame representing the telemetry CAN health.
+     */
+    constexpr can_frame toCanFrame() const
+    {
+        return can_frame{
+            TELEMETRY_CAN_MSG, // can_id
+            8,                 // can_dlc
+            static_cast<__u8>(static_cast<uint8_t>(bus) | (static_cast<uint8_t>(state) << 4)),
+            tec,
+            rec,
+            load,
+            bus_off,
+            reinits,
+            static_cast<__u8>(lost & 0xFF),
+            static_cast<__u8>((lost >> 8) & 0xFF)};
+    }
+};
+
+/**
+ * @brief Telemetry frame structure for the pedal to torque command latency.
+ * Multiplexed, one stage per frame.
+ * @see LatencyProbe::report
+ */
+struct TelemetryFrameLatency
+{
+    LatencyStage stage; /**< Stage the values belong to, time from the stage before it, Sample for the whole latency */
+    uint16_t min_us;    /**< Shortest, in microseconds */
+    uint16_t avg_us;    /**< Average, in microseconds */
+    uint16_t max_us;    /**< Longest, in microseconds */
+
+    /**
+     * @brief Converts the TelemetryFrameLatency to a CAN frame.
+     * @return CAN frame representing the telemetry latency.
+     */
+    constexpr can_frame toCanFrame() const
+    {
+        return can_frame{
+            TELEMETRY_LATENCY_MSG, // can_id
+            7,                     // can_dlc
+            static_cast<__u8>(stage),
+            static_cast<__u8>(min_us & 0xFF),
+            static_cast<__u8>((min_us >> 8) & 0xFF),
+            static_cast<__u8>(avg_us & 0xFF),
+            static_cast<__u8>((avg_us >> 8) & 0xFF),
+            static_cast<__u8>(max_us & 0xFF),
+            static_cast<__u8>((max_us >> 8) & 0xFF)};
+    }
+};
+
 /**
  * @brief Represents the state of the car.
  * Holds telemetry data and status, used as central data sharing structure.
  *
- * @see TelemetryFramePedal, TelemetryFrameMotor, TelemetryFrameBms
+ * @see TelemetryFramePedal, TelemetryFrameMotor, TelemetryFrameBms, TelemetryFrameScheduler, TelemetryFrameCan, TelemetryFrameLatency
  */
 struct CarState
 {
     TelemetryFramePedal pedal; /**< Struct holding pedal telemetry data, ready for sending over CAN */
     TelemetryFrameMotor motor; /**< Struct holding motor telemetry data, ready for sending over CAN */
     TelemetryFrameBms bms;     /**< Struct holding BMS telemetry data, ready for sending over CAN */
+    TelemetryFrameScheduler scheduler; /**< Struct holding one Scheduler stats entry, ready for sending over CAN */
+    TelemetryFrameCan can;     /**< Struct holding the health of one CAN controller, ready for sending over CAN */
+    TelemetryFrameLatency latency; /**< Struct holding one pedal latency stage, ready for sending over CAN */
     uint32_t status_millis;    /**< Millisecond counter for the current car status (for state transitions) */
-    uint32_t millis;           /**< Current time in milliseconds for the current loop iteration */
+    uint32_t millis;           /**< Current time in milliseconds, the Scheduler timebase (Scheduler::nowMs()) at the start of the tick */
 };
 #endif // CAR_STATE_HPP
\ No newline at end of file
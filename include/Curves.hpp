@@ -2,23 +2,26 @@
  * @file Curves.hpp
  * @author Planeson, Red Bird Racing
  * @brief Definition of throttle and brake mapping tables
- * @version 1.5
- * @date 2026-02-09
+ * @version 1.7
+ * @date 2026-10-17
  * @see Interp.hpp, Pedal
  */
 
 #ifndef CURVES_HPP
 #define CURVES_HPP
 #include "Interp.hpp"
+#include "BoardConf.h" // adcScale()
 #include <stdint.h>
 
+// All ADC values are calibrated in 10 bit (analogRead()) and scaled to ADC_BITS with adcScale(), the pedal inputs are oversampled
+
 // === APPS Limits ===
 
-constexpr uint16_t APPS_5V_MIN = 50;  /**< value below which apps_5v is considered shorted to ground */
-constexpr uint16_t APPS_5V_MAX = 950; /**< value above which apps_5v is considered shorted to rail */
+constexpr uint16_t APPS_5V_MIN = adcScale(50);  /**< value below which apps_5v is considered shorted to ground */
+constexpr uint16_t APPS_5V_MAX = adcScale(950); /**< value above which apps_5v is considered shorted to rail */
 
-constexpr uint16_t APPS_3V3_MIN = 50;            /**< value below which apps_3v3 is considered shorted to ground */
-constexpr uint16_t APPS_3V3_MAX = 950;           /**< value above which apps_3v3 is considered shorted to rail */
+constexpr uint16_t APPS_3V3_MIN = adcScale(50);  /**< value below which apps_3v3 is considered shorted to ground */
+constexpr uint16_t APPS_3V3_MAX = adcScale(950); /**< value above which apps_3v3 is considered shorted to rail */
 
 /**
  * @brief Ratio between 5V APPS and 3.3V APPS, use integer math to avoid float operations.
@@ -39,32 +42,32 @@ constexpr TablePoint<uint16_t, int16_t> CURVE_TABLE[5] = {
 
 // === Brake Limits ===
 
-constexpr uint16_t brake_min = 50;  /**< value below which brake is considered shorted to ground */
-constexpr uint16_t brake_max = 950; /**< value above which brake is considered shorted to rail */
+constexpr uint16_t brake_min = adcScale(50);  /**< value below which brake is considered shorted to ground */
+constexpr uint16_t brake_max = adcScale(950); /**< value above which brake is considered shorted to rail */
 
 /**
  * @brief Brake mapping table, negative values for regen
  */
 constexpr TablePoint<uint16_t, int16_t> BRAKE_TABLE[5] = {
-    {120, 0},
-    {150, -15000},
-    {180, -26000},
-    {210, -31000},
-    {240, -32500}}; // make sure this point doesn't exceed +-32767
+    {adcScale(120), 0},
+    {adcScale(150), -15000},
+    {adcScale(180), -26000},
+    {adcScale(210), -31000},
+    {adcScale(240), -32500}}; // make sure this point doesn't exceed +-32767
 
 /**
  * @brief APPS_3V3 mapping table, maps 3V3 readings to 5V readings
  */
 constexpr TablePoint<uint16_t, uint16_t> APPS_3V3_SCALE_TABLE[2] = {
-    {220, 325},
-    {410, 621}};
+    {adcScale(220), adcScale(325)},
+    {adcScale(410), adcScale(621)}};
 
 /**
  * @brief APPS_5V to percent mapping table, maps 5V readings to percent throttle (0-60000) 
  */
 constexpr TablePoint<uint16_t, uint16_t> APPS_5V_PERCENT_TABLE[2] = {
-    {325, 0},
-    {621, 60000}};
+    {adcScale(325), 0},
+    {adcScale(621), 60000}};
 
 // === calculated tables
 /**
@@ -2,8 +2,8 @@
  * @file Enums.hpp
  * @author Planeson, Red Bird Racing
  * @brief Enumeration definitions for the VCU
- * @version 1.3.1
- * @date 2026-02-09
+ * @version 1.11
+ * @date 2026-10-17
  */
 
 #ifndef ENUMS_HPP
@@ -69,6 +69,85 @@ enum class McpIndex : uint8_t
     Datalogger = 2 /**< Datalogger CAN MCP2515 instance */
 };
 
+/**
+ * @brief Scheduler lane, the task queue of one MCP2515 in use.
+ *
+ * Lanes count only the controllers in use, so lane 0 is not McpIndex::Motor unless the motor controller is in use.
+ * @see CanChannelMap::lane()
+ */
+using LaneIndex = uint8_t;
+
+/**
+ * @brief Logical CAN buses, what a frame is for rather than which MCP2515 sends it.
+ * @see CanChannelMap
+ */
+enum class CanBus : uint8_t
+{
+    Motor = 0,      /**< Inverter commands and readings */
+    Bms = 1,        /**< Accumulator commands and status */
+    Datalogger = 2, /**< Telemetry */
+    Debug = 3       /**< Debug_CAN frames */
+};
+
+/**
+ * @brief Error state of a CAN controller, from its EFLG register.
+ * @see CanHealth
+ */
+enum class CanBusState : uint8_t
+{
+    Active = 0,  /**< Error active, TEC and REC below 96 */
+    Warning = 1, /**< TEC or REC at 96 or more */
+    Passive = 2, /**< TEC or REC at 128 or more, sends are refused while TEC is */
+    BusOff = 3   /**< TEC over 255, offline until reinitialised */
+};
+
+/**
+ * @brief Points on the way from an APPS sample to its torque command, in order.
+ * @see LatencyProbe
+ */
+enum class LatencyStage : uint8_t
+{
+    Sample = 0, /**< APPS ADC read, also the whole sample to Sent latency in LatencyProbe stats */
+    Filter = 1, /**< Sample added to the pedal filters, the stats add the filters' group delay, see LatencyProbe */
+    Map = 2,    /**< Filtered pedal mapped to torque, frame queued */
+    Sent = 3    /**< Frame requested in the MCP2515 (TXREQ set), it goes out once it wins arbitration */
+};
+
+/**
+ * @brief Analog inputs in AdcSampler slot order, see ADC_PINS in main.cpp.
+ */
+enum class AdcChannel : uint8_t
+{
+    Apps5v = 0,  /**< APPS_5V */
+    Apps3v3 = 1, /**< APPS_3V3 */
+    Brake = 2,   /**< BRAKE_IN */
+    Hall = 3     /**< HALL_SENSOR */
+};
+
+/**
+ * @brief Scheduler task priorities.
+ *
+ * Tasks run in priority order every tick. Only Critical tasks ignore the per-tick CPU budget,
+ * the others are deferred to the next tick once it is used up.
+ */
+enum class TaskPriority : uint8_t
+{
+    Critical = 0, /**< Always runs first and on time, e.g. the torque command */
+    High = 1,     /**< Car state related, e.g. BMS HV start */
+    Normal = 2,   /**< Regular telemetry */
+    Low = 3       /**< Slow telemetry and diagnostics */
+};
+
+/**
+ * @brief Rate groups of the Scheduler.
+ * The fast lane runs every sub-tick, the CAN lane once per period, with its tasks spread over the sub-ticks.
+ */
+enum class TaskLane : uint8_t
+{
+    Fast = 0, /**< Every sub-tick, e.g. 1ms pedal sampling and plausibility */
+    Can = 1   /**< Every period, e.g. 10ms CAN traffic */
+};
+
 // === CAN IDs ===
 
 /**
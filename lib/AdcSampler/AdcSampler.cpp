@@ -0,0 +1,236 @@
+/**
+ * @file AdcSampler.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the AdcSampler namespace
+ * @version 1.1
+ * @date 2026-10-16
+ * @see AdcSampler.hpp
+ */
+
+#include "AdcSampler.hpp"
+#include <Arduino.h>
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#else
+#include "NativeHost.hpp"
+#endif
+
+namespace
+{
+    constexpr uint8_t MAX_SEQUENCE = ADC_SAMPLER_MAX_CHANNELS * ADC_SLOW_DIVIDER; /**< Longest rotation, all inputs but one oversampled */
+
+    uint8_t sequence[MAX_SEQUENCE] = {0};                             /**< Slot of each conversion of a rotation */
+    uint8_t sequence_length = 0;                                      /**< Conversions per rotation */
+    uint8_t channel_count = 0;                                        /**< Slots in use */
+    uint8_t oversampled_count = 0;                                    /**< Slots 0 to oversampled_count - 1 are oversampled */
+    volatile uint16_t latest[ADC_SAMPLER_MAX_CHANNELS] = {0};         /**< Window sum of an oversampled slot, last conversion of the others */
+    uint16_t window[ADC_SAMPLER_MAX_OVERSAMPLED][ADC_OVERSAMPLE_SIZE]; /**< Last conversions of each oversampled slot */
+    uint8_t window_pos[ADC_SAMPLER_MAX_OVERSAMPLED] = {0};            /**< Oldest conversion in window */
+    uint8_t primed = 0;                                               /**< Bit n set once slot n has its first conversion */
+
+    /**
+     * @brief Stores a conversion, sliding the window of an oversampled slot.
+     * The first conversion fills the whole window, so the value is right from the start.
+     * @param slot Slot converted.
+     * @param value 10 bit result.
+     */
+    inline void store(const uint8_t slot, const uint16_t value)
+    {
+        if (slot >= oversampled_count)
+        {
+            latest[slot] = value;
+            return;
+        }
+        if (!(primed & (1 << slot)))
+        {
+            for (uint8_t i = 0; i < ADC_OVERSAMPLE_SIZE; ++i)
+                window[slot][i] = value;
+            latest[slot] = value * ADC_OVERSAMPLE_SIZE;
+            primed |= 1 << slot;
+            return;
+        }
+        const uint8_t pos = window_pos[slot];
+        latest[slot] = latest[slot] + value - window[slot][pos];
+        window[slot][pos] = value;
+        window_pos[slot] = (pos + 1) & (ADC_OVERSAMPLE_SIZE - 1);
+    }
+
+    /**
+     * @brief Plans the rotation: the oversampled slots ADC_SLOW_DIVIDER times, then the others once.
+     * @param count Slots.
+     * @param oversampled Oversampled slots.
+     */
+    void planSequence(const uint8_t count, const uint8_t oversampled)
+    {
+        sequence_length = 0;
+        const uint8_t repeats = (oversampled == 0 || oversampled == count) ? 1 : ADC_SLOW_DIVIDER;
+        for (uint8_t r = 0; r < repeats; ++r)
+            for (uint8_t i = 0; i < oversampled; ++i)
+                sequence[sequence_length++] = i;
+        for (uint8_t i = oversampled; i < count; ++i)
+            sequence[sequence_length++] = i;
+    }
+} // namespace
+
+/**
+ * @brief Returns the conversion rate of a slot.
+ * @param slot Index of the pin given to begin().
+ * @return Conversions per second of that input, 0 for unknown slots.
+ */
+uint32_t AdcSampler::rateHz(uint8_t slot)
+{
+    uint8_t occurrences = 0;
+    for (uint8_t i = 0; i < sequence_length; ++i)
+        occurrences += sequence[i] == slot;
+    return sequence_length != 0 ? ADC_CONVERSION_HZ * occurrences / sequence_length : 0;
+}
+
+#ifdef __AVR__
+
+namespace
+{
+    uint8_t admux[ADC_SAMPLER_MAX_CHANNELS] = {0}; /**< ADMUX value of each slot, AVcc reference as analogRead() */
+    volatile uint32_t conversions = 0;            /**< Conversions since begin() */
+    uint8_t done_slot = 0;                        /**< Slot of the conversion in progress, only used by the ISR */
+    uint8_t sequence_pos = 0;                     /**< Position in sequence of the slot in ADMUX, converted after the one in progress, only used by the ISR */
+} // namespace
+
+/**
+ * @brief ADC conversion complete, the next conversion has already started on the slot in ADMUX.
+ */
+ISR(ADC_vect)
+{
+    store(done_slot, ADC);
+    done_slot = sequence[sequence_pos];
+    sequence_pos = (sequence_pos + 1 == sequence_length) ? 0 : sequence_pos + 1;
+    ADMUX = admux[sequence[sequence_pos]];
+    ++conversions;
+}
+
+/**
+ * @brief Starts the ADC free running through the given pins, restarting it if already running.
+ * Waits for a conversion of every slot (one rotation, up to 3.4ms), so read() never returns the 0 of an unconverted input.
+ * The first rotation converts the first slot twice, as the channel change only applies from the third conversion.
+ * @param pins Analog pins (A0-A7 or PIN_PC0-PIN_A7), the slot of each is its index.
+ * @param count Number of pins, 1 to ADC_SAMPLER_MAX_CHANNELS.
+ * @param oversampled Number of pins, from the first, that are oversampled, at most ADC_SAMPLER_MAX_OVERSAMPLED.
+ * @return false if count or oversampled is out of range, the ADC is left as it was.
+ */
+bool AdcSampler::begin(const uint8_t *pins, uint8_t count, uint8_t oversampled)
+{
+    if (pins == nullptr || count == 0 || count > ADC_SAMPLER_MAX_CHANNELS || oversampled > count || oversampled > ADC_SAMPLER_MAX_OVERSAMPLED)
+        return false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        ADCSRA = 0; // stop a running conversion before changing the mux
+        for (uint8_t i = 0; i < count; ++i)
+        {
+            const uint8_t channel = pins[i] >= A0 ? pins[i] - A0 : pins[i]; // pin or channel number, as analogRead()
+            admux[i] = _BV(REFS0) | (channel & 0x07);
+            latest[i] = 0;
+        }
+        channel_count = count;
+        oversampled_count = oversampled;
+        primed = 0;
+        planSequence(count, oversampled);
+        sequence_pos = 0;
+        done_slot = sequence[0];
+        conversions = 0;
+        ADMUX = admux[sequence[0]];
+        ADCSRB = 0; // auto trigger source: free running
+        ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0); // prescaler 128
+    }
+    while (getConversions() <= sequence_length)
+        ; // one rotation plus the repeated first conversion
+    return true;
+}
+
+/**
+ * @brief Returns the latest value of a slot, without waiting.
+ * @param slot Index of the pin given to begin().
+ * @return ADC_BITS value for an oversampled slot, 10 bit for the others, 0 before the first conversion or for unknown slots.
+ */
+uint16_t AdcSampler::read(uint8_t slot)
+{
+    if (slot >= channel_count)
+        return 0;
+    uint16_t value;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        value = latest[slot];
+    }
+    return slot < oversampled_count ? value >> ADC_OVERSAMPLE_BITS : value;
+}
+
+/**
+ * @brief Returns the conversions done since begin(), of all slots.
+ * @return Conversions, wrapping.
+ */
+uint32_t AdcSampler::getConversions()
+{
+    uint32_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        count = conversions;
+    }
+    return count;
+}
+
+#else // native build, emulate the ADC from the virtual clock
+
+namespace
+{
+    uint8_t pins_in[ADC_SAMPLER_MAX_CHANNELS] = {0}; /**< Pin of each slot */
+    uint64_t start_us = 0;                           /**< Virtual time of begin() */
+    uint32_t emulated = 0;                           /**< Conversions stored and charged */
+} // namespace
+
+bool AdcSampler::begin(const uint8_t *pins, uint8_t count, uint8_t oversampled)
+{
+    if (pins == nullptr || count == 0 || count > ADC_SAMPLER_MAX_CHANNELS || oversampled > count || oversampled > ADC_SAMPLER_MAX_OVERSAMPLED)
+        return false;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        pins_in[i] = pins[i];
+        latest[i] = 0;
+    }
+    channel_count = count;
+    oversampled_count = oversampled;
+    primed = 0;
+    planSequence(count, oversampled);
+    start_us = NativeHost::now();
+    emulated = 0;
+    NativeHost::advanceMicros((sequence_length + 1) * 1000000UL / ADC_CONVERSION_HZ + 1); // wait for one rotation
+    read(0);
+    return true;
+}
+
+uint16_t AdcSampler::read(uint8_t slot)
+{
+    if (slot >= channel_count)
+        return 0;
+    // the conversions since the last call, with the pins as they are now; more than a window per slot changes nothing
+    const uint32_t done = getConversions();
+    const uint32_t needed = static_cast<uint32_t>(sequence_length) * ADC_OVERSAMPLE_SIZE;
+    for (uint32_t i = done - emulated > needed ? done - needed : emulated; i < done; ++i)
+    {
+        const uint8_t s = sequence[i % sequence_length];
+        store(s, NativeHost::getAnalog(pins_in[s]));
+    }
+    NativeHost::advanceMicros((done - emulated) * NativeHost::costs.adc_isr);
+    emulated = done;
+    return slot < oversampled_count ? latest[slot] >> ADC_OVERSAMPLE_BITS : latest[slot];
+}
+
+uint32_t AdcSampler::getConversions()
+{
+    if (channel_count == 0)
+        return 0;
+    return static_cast<uint32_t>((NativeHost::now() - start_us) * ADC_CONVERSION_HZ / 1000000ULL);
+}
+
+#endif // __AVR__
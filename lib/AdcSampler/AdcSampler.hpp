@@ -0,0 +1,79 @@
+/**
+ * @file AdcSampler.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the AdcSampler namespace, a free-running ADC that rotates through the analog inputs in its interrupt
+ * @version 1.3
+ * @date 2026-10-17
+ * @see AdcSampler.cpp
+ * @dir AdcSampler @brief The AdcSampler library keeps the ADC converting the analog inputs in the background, so their latest values are read without waiting for a conversion.
+ */
+
+#ifndef ADC_SAMPLER_HPP
+#define ADC_SAMPLER_HPP
+
+#include <stdint.h>
+#include "BoardConf.h" // ADC_FREE_RUNNING, ADC_OVERSAMPLE_BITS, ADC_BITS
+
+#ifdef F_CPU
+constexpr uint32_t ADC_CPU_HZ = F_CPU;
+#else
+constexpr uint32_t ADC_CPU_HZ = 16000000UL; // native build, ATmega328P @ 16MHz
+#endif
+constexpr uint8_t ADC_SAMPLER_MAX_CHANNELS = 4;                         /**< Analog inputs one AdcSampler rotates through */
+constexpr uint8_t ADC_SAMPLER_MAX_OVERSAMPLED = 3;                      /**< Inputs with an oversampling window, ADC_OVERSAMPLE_SIZE * 2 bytes of SRAM each */
+constexpr uint8_t ADC_PRESCALER = 128;                                  /**< ADC clock 125kHz at 16MHz, within the 50-200kHz for 10 bit results */
+constexpr uint32_t ADC_CONVERSION_HZ = ADC_CPU_HZ / ADC_PRESCALER / 13; /**< Conversions per second, 13 ADC clocks each when free running */
+constexpr uint8_t ADC_OVERSAMPLE_SIZE = 1 << (2 * ADC_OVERSAMPLE_BITS); /**< Conversions in the window of an oversampled input */
+constexpr uint8_t ADC_SLOW_DIVIDER = 8;                                 /**< Inputs that aren't oversampled are converted once every this many rotations */
+
+/**
+ * @brief Conversion rate of each oversampled input, as begin() plans the rotation.
+ * @param count Inputs given to begin().
+ * @param oversampled Oversampled inputs given to begin().
+ * @return Conversions per second of one oversampled input.
+ */
+constexpr uint32_t adcOversampledHz(const uint8_t count, const uint8_t oversampled)
+{
+    return (oversampled == 0 || oversampled == count)
+               ? ADC_CONVERSION_HZ / count
+               : ADC_CONVERSION_HZ * ADC_SLOW_DIVIDER / (ADC_SLOW_DIVIDER * oversampled + count - oversampled);
+}
+
+/**
+ * @brief Delay of the oversampling window, half the window at the input's conversion rate.
+ * @param count Inputs given to begin().
+ * @param oversampled Oversampled inputs given to begin().
+ * @return Delay of an oversampled input in us, 0 without oversampling.
+ */
+constexpr uint32_t adcWindowDelayUs(const uint8_t count, const uint8_t oversampled)
+{
+    return (ADC_OVERSAMPLE_SIZE / 2) * 1000000UL / adcOversampledHz(count, oversampled);
+}
+
+/**
+ * @brief Namespace for the background ADC.
+ * @details The ADC free runs at ADC_CONVERSION_HZ (9615 at 16MHz). Its conversion complete interrupt stores the result
+ * and selects the next input, so read() returns the latest value at once, instead of the ~110us an analogRead() blocks for.
+ * In free running mode the next conversion starts before the interrupt runs, so a channel change applies to the one after:
+ * the interrupt keeps track of which input each result belongs to.
+ *
+ * The first inputs given to begin() are oversampled: they are converted every rotation, and read() returns the sum of
+ * their last ADC_OVERSAMPLE_SIZE conversions shifted to ADC_BITS (oversampling and decimation, the ADC noise dithers the
+ * extra bits). The window slides with every conversion, so the value is fresh at any read rate and only delays by half
+ * the window. The other inputs are converted once every ADC_SLOW_DIVIDER rotations and read() returns 10 bits.
+ * With APPS 5V, APPS 3V3 and brake oversampled and the hall sensor not, the pedal inputs are each converted at ~3kHz,
+ * a 16 conversion window spans 5.2ms (2.6ms delay), the hall sensor at ~380Hz.
+ *
+ * The interrupt costs ~60 cycles per conversion, about 4% of the CPU. analogRead() must not be used while it runs.
+ * On the native build the ADC is emulated from the virtual clock: read() fills the window with the value on the pin for the
+ * conversions since the last call and charges their interrupts, see NativeHost::CostModel::adc_isr.
+ */
+namespace AdcSampler
+{
+    bool begin(const uint8_t *pins, uint8_t count, uint8_t oversampled);
+    uint16_t read(uint8_t slot);
+    uint32_t getConversions();
+    uint32_t rateHz(uint8_t slot);
+} // namespace AdcSampler
+
+#endif // ADC_SAMPLER_HPP
@@ -2,8 +2,8 @@
  * @file BMS.cpp
  * @author Planeson, Red Bird Racing
  * @brief Implementation of the BMS class for managing the Accumulator (Kclear BMS) via CAN bus
- * @version 1.3.1
- * @date 2026-02-12
+ * @version 1.9
+ * @date 2026-10-16
  * @see BMS.hpp
  */
 
@@ -26,15 +26,14 @@
 
 /**
  * @brief Construct a new BMS object, initing car.pedal.status.bits.hv_ready to false
- * @param bms_can_ Reference to MCP2515 for BMS CAN bus
+ * The acceptance filters are planned from the CAN routes in main.cpp, see CanFilter.
+ * @param bms_port_ Reference to the port of the BMS CAN bus
  * @param car_ Reference to CarState, for the status flags and setting BMS data
  */
-BMS::BMS(MCP2515 &bms_can_, CarState &car_)
-    : bms_can(bms_can_), car(car_)
+BMS::BMS(CanPort &bms_port_, CarState &car_)
+    : bms_port(bms_port_), car(car_)
 {
     car.pedal.status.bits.hv_ready = false;
-    while (bms_can.setFilter(MCP2515::RXF0,true,BMS_INFO_EXT) != MCP2515::ERROR_OK)
-        ;
 }
 
 /**
@@ -42,7 +41,7 @@ BMS::BMS(MCP2515 &bms_can_, CarState &car_)
  * First check BMS is in standby(3) state, then send the HV start command.
  * Keep sending the command until the BMS state changes to precharge(4).
  * Sets car.pedal.status.bits.hv_ready to true when BMS state changes to run(5).
- *
+ * The newest info frame received since the last call decides, see onInfo().
  */
 void BMS::checkHv()
 {
@@ -50,14 +49,15 @@ void BMS::checkHv()
     if (car.pedal.status.bits.hv_ready)
     return; // already started
     car.pedal.status.bits.hv_ready = false;
-    if (bms_can.readMessage(&rx_bms_msg) == MCP2515::ERROR_NOMSG)
+    if (!info_received)
     {
         DBG_BMS_STATUS(BmsStatus::NoMsg);
         car.pedal.status.bits.bms_no_msg = true;
         return;
     }
+    info_received = false;
 
-    /* now that we set filter on MCP2515, it's impossible to get wrong ID
+    /* only BMS_INFO_EXT is routed to onInfo(), it's impossible to get wrong ID
     // Check if the BMS is in standby state (0x3 in upper 4 bits)
     if (rx_bms_msg.can_id != BMS_INFO_EXT)
     {
@@ -71,13 +71,13 @@ void BMS::checkHv()
     {
     case 0x30: // Standby state
         DBG_BMS_STATUS(BmsStatus::Waiting);
-        bms_can.sendMessage(&start_hv_msg);
+        bms_port.send(&start_hv_msg);
         DBGLN_GENERAL("BMS in standby state, sent start HV cmd");
         // sent start HV cmd, wait for BMS to change state
         return;
     case 0x40: // Precharge state
         DBG_BMS_STATUS(BmsStatus::Starting);
-        bms_can.sendMessage(&start_hv_msg);
+        bms_port.send(&start_hv_msg);
         DBGLN_GENERAL("BMS in precharge state, HV starting");
         return; // BMS is in precharge state, wait
     case 0x50:  // Run state
@@ -91,3 +91,13 @@ void BMS::checkHv()
         return; // Unknown state, retry
     }
 }
+
+/**
+ * @brief Stores a BMS info frame for the next checkHv(), routed by the CAN dispatch table.
+ * @param frame BMS_INFO_EXT frame, at least 7 bytes.
+ */
+void BMS::onInfo(const can_frame &frame)
+{
+    rx_bms_msg = frame;
+    info_received = true;
+}
@@ -2,8 +2,8 @@
  * @file BMS.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of the BMS class for managing the Accumulator (Kclear BMS) via CAN bus
- * @version 1.2
- * @date 2026-02-04
+ * @version 1.7
+ * @date 2026-10-16
  * @see BMS.cpp
  * @dir BMS @brief The BMS library contains the BMS class for managing the Accumulator (Kclear BMS) via CAN bus, including starting HV and checking BMS status.
  */
@@ -13,6 +13,7 @@
 
 #include "Scheduler.hpp"
 #include "CarState.hpp"
+#include "CanPort.hpp"
 
 // ignore -Wpedantic warnings for mcp2515.h
 #pragma GCC diagnostic push
@@ -46,17 +47,19 @@ constexpr can_frame stop_hv_msg = {
 class BMS
 {
 public:
-    BMS(MCP2515 &bms_can_, CarState &car_);
+    BMS(CanPort &bms_port_, CarState &car_);
     /**
      * @brief Returns true if HV has been started
      * @return true if HV started, false otherwise
      */
     bool hvReady() const { return car.pedal.status.bits.hv_ready; };
     void checkHv();
+    void onInfo(const can_frame &frame);
 
 private:
-    MCP2515 &bms_can; /**< Reference to MCP2515 for BMS CAN bus */
-    /** Local storage for received BMS CAN frame */
+    CanPort &bms_port; /**< Port of the BMS CAN bus */
+    bool info_received = false; /**< An info frame arrived since the last checkHv() */
+    /** Latest received BMS info frame, see onInfo() */
     can_frame rx_bms_msg = {
         0,   /**< can_id */
         0,   /**< can_dlc */
@@ -0,0 +1,105 @@
+/**
+ * @file CanChannel.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration and definition of CanChannelMap, the mapping of logical CAN buses to MCP2515 controllers
+ * @version 1.1
+ * @date 2026-10-17
+ * @dir CanChannel @brief The CanChannel library contains CanChannelMap, which maps the logical CAN buses (motor, BMS, datalogger, debug) to the MCP2515 controllers that carry them, so a board with fewer working transceivers only changes its configuration.
+ */
+
+#ifndef CAN_CHANNEL_HPP
+#define CAN_CHANNEL_HPP
+
+#include <stdint.h>
+#include "Enums.hpp"
+
+constexpr uint8_t NUM_CAN_BUSES = 4;       /**< Values of CanBus */
+constexpr uint8_t NUM_CAN_CONTROLLERS = 3; /**< Values of McpIndex */
+
+/**
+ * @brief Which MCP2515 carries each logical bus, fixed at compile time.
+ * @details Modules ask for the controller of their CanBus instead of naming a controller, and every controller that
+ * carries no bus is left without queues and tasks. The Scheduler gets one lane per controller in use, lane() numbers them,
+ * so its round robin and phase balancing work on the chips that really share an SPI transfer and a bus,
+ * not on buses that end up on the same chip. Declare the map constexpr and check valid() with a static_assert.
+ */
+struct CanChannelMap
+{
+    McpIndex controller[NUM_CAN_BUSES]; /**< Controller of each bus, indexed by CanBus */
+
+    /**
+     * @brief Returns the controller carrying a bus.
+     * @param bus Logical bus.
+     * @return Controller, e.g. to index the MCP2515, CanTx and CanRx of a board.
+     */
+    constexpr McpIndex physical(const CanBus bus) const { return controller[static_cast<uint8_t>(bus)]; }
+
+    /**
+     * @brief Returns whether a controller carries at least one bus.
+     * @param mcp Controller.
+     * @return true if it needs its queues initialised.
+     */
+    constexpr bool uses(const McpIndex mcp) const
+    {
+        for (uint8_t i = 0; i < NUM_CAN_BUSES; ++i)
+        {
+            if (controller[i] == mcp)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Returns the number of controllers in use, the Scheduler lanes needed.
+     * @return 1 to NUM_CAN_CONTROLLERS for a valid map.
+     */
+    constexpr uint8_t controllers() const
+    {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < NUM_CAN_CONTROLLERS; ++i)
+        {
+            if (uses(static_cast<McpIndex>(i)))
+                ++count;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Returns the Scheduler lane of a controller, its position among the controllers in use.
+     * @param mcp Controller in use.
+     * @return Lane, 0 to controllers() - 1, passed to Scheduler::addTask().
+     */
+    constexpr LaneIndex lane(const McpIndex mcp) const
+    {
+        uint8_t index = 0;
+        for (uint8_t i = 0; i < static_cast<uint8_t>(mcp); ++i)
+        {
+            if (uses(static_cast<McpIndex>(i)))
+                ++index;
+        }
+        return index;
+    }
+
+    /**
+     * @brief Returns the Scheduler lane of the controller carrying a bus.
+     * @param bus Logical bus.
+     * @return Lane, 0 to controllers() - 1.
+     */
+    constexpr LaneIndex lane(const CanBus bus) const { return lane(physical(bus)); }
+
+    /**
+     * @brief Returns whether every bus is mapped to an existing controller.
+     * @return true if the map can be used.
+     */
+    constexpr bool valid() const
+    {
+        for (uint8_t i = 0; i < NUM_CAN_BUSES; ++i)
+        {
+            if (static_cast<uint8_t>(controller[i]) >= NUM_CAN_CONTROLLERS)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif // CAN_CHANNEL_HPP
@@ -0,0 +1,183 @@
+/**
+ * @file CanDispatch.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration and definition of the CanDispatch class template, a received frame dispatch table built at compile time
+ * @version 1.1
+ * @date 2026-10-16
+ * @dir CanDispatch @brief The CanDispatch library contains the CanDispatch class template, which maps received frames by bus, CAN ID and mux byte to their handlers through a table sorted at compile time.
+ */
+
+#ifndef CAN_DISPATCH_HPP
+#define CAN_DISPATCH_HPP
+
+#include <stdint.h>
+#include "Enums.hpp"
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+using CanHandler = void (*)(const can_frame &frame); /**< Handler of a received frame */
+
+constexpr int16_t CAN_NO_MUX = -1; /**< CanRoute mux: any data[0], e.g. frames that aren't multiplexed */
+
+/**
+ * @brief One entry of a CanDispatch table.
+ */
+struct CanRoute
+{
+    McpIndex bus;       /**< Bus the frame is received on */
+    canid_t id;         /**< CAN ID, with CAN_EFF_FLAG for extended frames */
+    int16_t mux;        /**< data[0] to match (e.g. Bamocar register ID), CAN_NO_MUX for any */
+    uint8_t min_dlc;    /**< Shorter frames are not handed to the handler */
+    CanHandler handler; /**< Called with every matching frame */
+};
+
+/**
+ * @brief The distinct CAN IDs routed on one bus, e.g. for planCanFilters().
+ * @tparam N Capacity, the number of routes
+ */
+template <uint8_t N>
+struct CanIdSet
+{
+    canid_t ids[N]; /**< IDs, sorted */
+    uint8_t count;  /**< IDs in use */
+};
+
+/**
+ * @brief Dispatch table of received frames, sorted at compile time.
+ * @details The routes are sorted by (bus, ID, mux) in the constexpr constructor, so dispatch() is a binary search:
+ * one for the exact mux, and if that misses one for a CAN_NO_MUX route of the ID. Adding routes costs
+ * log2(N) compares per frame, not another branch in a module. Declare the table constexpr and check
+ * unique() with a static_assert.
+ * @tparam N Number of routes
+ */
+template <uint8_t N>
+class CanDispatch
+{
+public:
+    static_assert(N > 0, "CanDispatch needs at least one route");
+
+    /**
+     * @brief Copies and sorts the routes.
+     * @param routes_ Routes, in any order.
+     */
+    explicit constexpr CanDispatch(const CanRoute (&routes_)[N]) : routes{}
+    {
+        // insertion sort, N is small and this runs in the compiler
+        for (uint8_t i = 0; i < N; ++i)
+        {
+            uint8_t j = i;
+            while (j > 0 && compare(routes[j - 1], routes_[i].bus, routes_[i].id, muxKey(routes_[i].mux)) > 0)
+            {
+                routes[j] = routes[j - 1];
+                --j;
+            }
+            routes[j] = routes_[i];
+        }
+    }
+
+    /**
+     * @brief Returns whether every (bus, ID, mux) has one route only, for a static_assert.
+     * @return true if no route shadows another.
+     */
+    constexpr bool unique() const
+    {
+        for (uint8_t i = 1; i < N; ++i)
+        {
+            if (compare(routes[i - 1], routes[i].bus, routes[i].id, muxKey(routes[i].mux)) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lists the IDs routed on a bus, each once, so the acceptance filters can follow the routes.
+     * @param bus Bus.
+     * @return IDs of the routes on bus.
+     */
+    constexpr CanIdSet<N> ids(const McpIndex bus) const
+    {
+        CanIdSet<N> set = {};
+        for (uint8_t i = 0; i < N; ++i)
+        {
+            // sorted, so routes of one ID are next to each other
+            if (routes[i].bus == bus && (set.count == 0 || set.ids[set.count - 1] != routes[i].id))
+                set.ids[set.count++] = routes[i].id;
+        }
+        return set;
+    }
+
+    /**
+     * @brief Finds the route of an exact (bus, ID, mux).
+     * @param bus Bus.
+     * @param id CAN ID, with flags.
+     * @param mux data[0], or CAN_NO_MUX.
+     * @return Index into the sorted routes, N if there is none.
+     */
+    constexpr uint8_t find(const McpIndex bus, const canid_t id, const int16_t mux) const
+    {
+        const uint16_t key = muxKey(mux);
+        uint8_t low = 0;
+        uint8_t high = N;
+        while (low < high)
+        {
+            const uint8_t mid = (low + high) / 2;
+            const int8_t order = compare(routes[mid], bus, id, key);
+            if (order == 0)
+                return mid;
+            if (order < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return N;
+    }
+
+    /**
+     * @brief Hands a received frame to its handler.
+     * @param bus Bus the frame was received on.
+     * @param frame Received frame.
+     * @return true if a handler took it, false if no route matches or the frame is too short.
+     */
+    bool dispatch(const McpIndex bus, const can_frame &frame) const
+    {
+        uint8_t index = frame.can_dlc > 0 ? find(bus, frame.can_id, frame.data[0]) : N;
+        if (index == N)
+            index = find(bus, frame.can_id, CAN_NO_MUX);
+        if (index == N || frame.can_dlc < routes[index].min_dlc)
+            return false;
+        routes[index].handler(frame);
+        return true;
+    }
+
+private:
+    CanRoute routes[N]; /**< Routes sorted by (bus, ID, mux), CAN_NO_MUX last */
+
+    /**
+     * @brief Sort key of a mux, CAN_NO_MUX after every data[0] value.
+     * @param mux data[0] or CAN_NO_MUX.
+     * @return 0-255, 256 for CAN_NO_MUX.
+     */
+    static constexpr uint16_t muxKey(const int16_t mux) { return mux == CAN_NO_MUX ? 0x100 : static_cast<uint8_t>(mux); }
+
+    /**
+     * @brief Orders a route against a (bus, ID, mux key).
+     * @param route Route.
+     * @param bus Bus.
+     * @param id CAN ID, with flags.
+     * @param mux_key muxKey() of the mux.
+     * @return Negative if the route sorts first, 0 if equal, positive if it sorts after.
+     */
+    static constexpr int8_t compare(const CanRoute &route, const McpIndex bus, const canid_t id, const uint16_t mux_key)
+    {
+        return route.bus != bus           ? (route.bus < bus ? -1 : 1)
+               : route.id != id           ? (route.id < id ? -1 : 1)
+               : muxKey(route.mux) != mux_key ? (muxKey(route.mux) < mux_key ? -1 : 1)
+                                              : 0;
+    }
+};
+
+#endif // CAN_DISPATCH_HPP
@@ -0,0 +1,379 @@
+/**
+ * @file CanFilter.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration and definition of CanFilterPlan and planCanFilters(), MCP2515 acceptance masks and filters computed at compile time
+ * @version 1.0
+ * @date 2026-10-16
+ * @dir CanFilter @brief The CanFilter library contains planCanFilters(), which turns the CAN IDs a bus subscribes to into MCP2515 masks and filters at compile time, so unwanted frames are rejected by the chip instead of costing SPI reads.
+ */
+
+#ifndef CAN_FILTER_HPP
+#define CAN_FILTER_HPP
+
+#include <stdint.h>
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+constexpr uint8_t CAN_FILTER_MAX_IDS = 16; /**< Most IDs one plan can take, bounds the planner's work in the compiler */
+
+/**
+ * @brief Masks and filters of one MCP2515, in the form MCP2515::setFilterMask() and setFilter() take them.
+ * @details RXM0 serves RXF0-1 (RXB0), RXM1 serves RXF2-5 (RXB1, and RXB0 rollover). Each mask only serves filters of
+ * one frame type: a mask written for standard frames has its EID bits clear, which the chip would otherwise compare
+ * against the first two data bytes of standard frames.
+ */
+struct CanFilterPlan
+{
+    uint32_t masks[2];   /**< RXM0, RXM1, 11 bits for a standard mask, 29 for extended */
+    bool mask_ext[2];    /**< Mask written in the extended layout */
+    uint32_t filters[6]; /**< RXF0-RXF5, 11 or 29 bits */
+    bool filter_ext[6];  /**< Filter applies to extended frames only */
+    uint32_t wanted;     /**< Distinct subscribed IDs, all of them pass */
+    uint32_t unwanted;   /**< Other IDs that pass too (residual pass-through), upper bound */
+    bool valid;          /**< false if there were no IDs or more than CAN_FILTER_MAX_IDS, apply() refuses */
+
+    /**
+     * @brief Acceptance check as the chip does it, to list or test the residual pass-through set.
+     * @param id CAN ID, with CAN_EFF_FLAG for extended frames.
+     * @return true if a frame with this ID reaches the RX buffers.
+     */
+    constexpr bool accepts(const canid_t id) const
+    {
+        const bool ext = id & CAN_EFF_FLAG;
+        const uint32_t value = id & (ext ? CAN_EFF_MASK : CAN_SFF_MASK);
+        for (uint8_t i = 0; i < 6; ++i)
+        {
+            if (filter_ext[i] == ext && ((value ^ filters[i]) & masks[i < 2 ? 0 : 1]) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Writes the masks and filters to the MCP2515, call between setBitrate() and setNormalMode().
+     * @details Inline and without loops, so for a constexpr plan the values become immediates and the plan takes no SRAM.
+     * @param mcp Controller, left in configuration mode.
+     * @return MCP2515::ERROR_OK, the first error of the autowp calls, or MCP2515::ERROR_FAIL if the plan isn't valid.
+     */
+    inline MCP2515::ERROR apply(MCP2515 &mcp) const
+    {
+        if (!valid)
+            return MCP2515::ERROR_FAIL;
+        MCP2515::ERROR result = mcp.setFilterMask(MCP2515::MASK0, mask_ext[0], masks[0]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilterMask(MCP2515::MASK1, mask_ext[1], masks[1]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF0, filter_ext[0], filters[0]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF1, filter_ext[1], filters[1]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF2, filter_ext[2], filters[2]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF3, filter_ext[3], filters[3]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF4, filter_ext[4], filters[4]);
+        if (result == MCP2515::ERROR_OK)
+            result = mcp.setFilter(MCP2515::RXF5, filter_ext[5], filters[5]);
+        return result;
+    }
+};
+
+/**
+ * @brief Planner internals, see planCanFilters().
+ */
+namespace CanFilterPlanner
+{
+    /**
+     * @brief IDs one filter has to pass: the bits they share, and the bits that vary between them.
+     */
+    struct Cluster
+    {
+        uint32_t base; /**< One of the IDs, 11 or 29 bits */
+        uint32_t diff; /**< Bits that differ between the IDs, the mask must clear them */
+        bool ext;      /**< Extended frame IDs */
+    };
+
+    /**
+     * @brief Clusters being planned, a struct so it can be copied to try alternatives.
+     */
+    struct ClusterSet
+    {
+        Cluster c[CAN_FILTER_MAX_IDS]; /**< Clusters */
+        uint8_t n;                     /**< Clusters in use */
+    };
+
+    /**
+     * @brief Number of set bits.
+     * @param value Value.
+     * @return Set bits.
+     */
+    constexpr uint8_t popcount(uint32_t value)
+    {
+        uint8_t count = 0;
+        for (; value != 0; value &= value - 1)
+            ++count;
+        return count;
+    }
+
+    /**
+     * @brief ID bits of a frame type.
+     * @param ext Extended frames.
+     * @return CAN_EFF_MASK or CAN_SFF_MASK.
+     */
+    constexpr uint32_t width(const bool ext) { return ext ? CAN_EFF_MASK : CAN_SFF_MASK; }
+
+    /**
+     * @brief Bits that vary in a cluster made by merging two.
+     * @param a First cluster.
+     * @param b Second cluster.
+     * @return diff of the merged cluster.
+     */
+    constexpr uint32_t mergedDiff(const Cluster &a, const Cluster &b) { return a.diff | b.diff | (a.base ^ b.base); }
+
+    /**
+     * @brief Removes cluster b, which was merged into another.
+     * @param set Clusters.
+     * @param b Index of the cluster to remove.
+     */
+    constexpr void remove(ClusterSet &set, const uint8_t b)
+    {
+        for (uint8_t i = b; i + 1 < set.n; ++i)
+            set.c[i] = set.c[i + 1];
+        --set.n;
+    }
+
+    /**
+     * @brief Merges clusters that together pass exactly their own IDs (same varying bits, bases one bit apart), e.g. 0x700-0x703 and 0x704-0x707.
+     * @param set Clusters.
+     */
+    constexpr void combine(ClusterSet &set)
+    {
+        for (uint8_t a = 0; a < set.n; ++a)
+        {
+            for (uint8_t b = a + 1; b < set.n; ++b)
+            {
+                const uint32_t apart = set.c[a].base ^ set.c[b].base;
+                if (set.c[a].ext != set.c[b].ext || set.c[a].diff != set.c[b].diff || popcount(apart & ~set.c[a].diff) != 1)
+                    continue;
+                set.c[a].diff |= apart;
+                remove(set, b);
+                a = 0xFF; // start over, a wraps to 0
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Merges clusters of one type, the pair whose merge frees the fewest bits first, until at most limit are left.
+     * @param set Clusters.
+     * @param ext Type to merge.
+     * @param limit Clusters of that type to keep at most.
+     */
+    constexpr void reduce(ClusterSet &set, const bool ext, const uint8_t limit)
+    {
+        for (;;)
+        {
+            uint8_t count = 0;
+            for (uint8_t i = 0; i < set.n; ++i)
+                count += set.c[i].ext == ext;
+            if (count <= limit)
+                return;
+
+            uint8_t best_a = 0, best_b = 0, best_bits = 0xFF;
+            for (uint8_t a = 0; a < set.n; ++a)
+            {
+                for (uint8_t b = a + 1; b < set.n; ++b)
+                {
+                    if (set.c[a].ext != ext || set.c[b].ext != ext)
+                        continue;
+                    const uint8_t bits = popcount(mergedDiff(set.c[a], set.c[b]));
+                    if (bits < best_bits)
+                    {
+                        best_bits = bits;
+                        best_a = a;
+                        best_b = b;
+                    }
+                }
+            }
+            set.c[best_a].diff = mergedDiff(set.c[best_a], set.c[best_b]);
+            remove(set, best_b);
+        }
+    }
+
+    /**
+     * @brief Fills one mask and its filters from the clusters selected for it.
+     * @param plan Plan to fill.
+     * @param set Clusters.
+     * @param select Bit i set if cluster i belongs to this mask.
+     * @param mask_num 0 for RXM0/RXF0-1, 1 for RXM1/RXF2-5.
+     * @return IDs the mask and filters pass, 0 if no cluster is selected.
+     */
+    constexpr uint32_t fillMask(CanFilterPlan &plan, const ClusterSet &set, const uint8_t select, const uint8_t mask_num)
+    {
+        const uint8_t first_filter = mask_num == 0 ? 0 : 2;
+        const uint8_t slots = mask_num == 0 ? 2 : 4;
+        uint32_t varying = 0;
+        bool ext = false;
+        for (uint8_t i = 0; i < set.n; ++i)
+        {
+            if (select & (1 << i))
+            {
+                varying |= set.c[i].diff;
+                ext = set.c[i].ext;
+            }
+        }
+        if (select == 0)
+            return 0;
+
+        const uint32_t mask = width(ext) & ~varying;
+        plan.masks[mask_num] = mask;
+        plan.mask_ext[mask_num] = ext;
+        uint8_t used = 0;
+        for (uint8_t i = 0; i < set.n; ++i)
+        {
+            if (!(select & (1 << i)))
+                continue;
+            const uint32_t pattern = set.c[i].base & mask;
+            bool repeated = false;
+            for (uint8_t f = 0; f < used; ++f)
+                repeated = repeated || plan.filters[first_filter + f] == pattern;
+            if (repeated)
+                continue;
+            plan.filters[first_filter + used] = pattern;
+            plan.filter_ext[first_filter + used] = ext;
+            ++used;
+        }
+        for (uint8_t f = used; f < slots; ++f)
+        {
+            // spare filters repeat the first, passing nothing new
+            plan.filters[first_filter + f] = plan.filters[first_filter];
+            plan.filter_ext[first_filter + f] = ext;
+        }
+        return static_cast<uint32_t>(used) << popcount(width(ext) & ~mask);
+    }
+
+    /**
+     * @brief Builds the plan for a split of the clusters between the two masks.
+     * @param set Clusters, at most 6.
+     * @param select Bit i set if cluster i goes to RXM0, at most 2 bits, at most 4 left for RXM1, one type per mask.
+     * @param wanted Distinct subscribed IDs.
+     * @return Plan.
+     */
+    constexpr CanFilterPlan build(const ClusterSet &set, const uint8_t select, const uint32_t wanted)
+    {
+        CanFilterPlan plan = {};
+        const uint8_t all = static_cast<uint8_t>((1 << set.n) - 1);
+        const uint32_t passed = fillMask(plan, set, select, 0) + fillMask(plan, set, all & ~select, 1);
+        // an empty mask takes the type of the other and passes exactly the other's first filter
+        const uint8_t empty = select == 0 ? 0 : (all & ~select) == 0 ? 1 : 2;
+        if (empty != 2)
+        {
+            const uint8_t other = 1 - empty;
+            const uint8_t source = other == 0 ? 0 : 2;
+            plan.masks[empty] = width(plan.mask_ext[other]);
+            plan.mask_ext[empty] = plan.mask_ext[other];
+            for (uint8_t f = (empty == 0 ? 0 : 2); f < (empty == 0 ? 2 : 6); ++f)
+            {
+                plan.filters[f] = plan.filters[source];
+                plan.filter_ext[f] = plan.filter_ext[source];
+            }
+        }
+        plan.wanted = wanted;
+        plan.unwanted = passed - wanted;
+        plan.valid = true;
+        return plan;
+    }
+
+    /**
+     * @brief Splits the clusters between the masks, trying every split that fits.
+     * @param set Clusters of one type only, at most 6.
+     * @param wanted Distinct subscribed IDs.
+     * @return Plan passing the fewest IDs.
+     */
+    constexpr CanFilterPlan bestSplit(const ClusterSet &set, const uint32_t wanted)
+    {
+        CanFilterPlan best = {};
+        for (uint8_t select = 0; select < (1 << set.n); ++select)
+        {
+            const uint8_t in_mask0 = popcount(select);
+            if (in_mask0 > 2 || set.n - in_mask0 > 4)
+                continue;
+            const CanFilterPlan plan = build(set, select, wanted);
+            if (!best.valid || plan.unwanted < best.unwanted)
+                best = plan;
+        }
+        return best;
+    }
+
+    /**
+     * @brief Plans with one frame type on RXM0 and the other on RXM1.
+     * @param set Clusters of both types.
+     * @param ext_on_mask0 Extended IDs on RXM0 (2 filters), standard on RXM1 (4 filters), or the other way round.
+     * @param wanted Distinct subscribed IDs.
+     * @return Plan.
+     */
+    constexpr CanFilterPlan mixedSplit(ClusterSet set, const bool ext_on_mask0, const uint32_t wanted)
+    {
+        reduce(set, ext_on_mask0, 2);
+        reduce(set, !ext_on_mask0, 4);
+        uint8_t select = 0;
+        for (uint8_t i = 0; i < set.n; ++i)
+        {
+            if (set.c[i].ext == ext_on_mask0)
+                select |= 1 << i;
+        }
+        return build(set, select, wanted);
+    }
+} // namespace CanFilterPlanner
+
+/**
+ * @brief Computes RXM0/RXM1 and RXF0-RXF5 that pass every given ID and as few others as possible.
+ * @details Up to 6 IDs (one frame type) get a filter each with all mask bits set, nothing else passes. Aligned blocks
+ * (e.g. 0x700-0x707) become one filter at no cost. If still more, the IDs sharing the most bits are merged onto one
+ * filter, clearing the mask bits they differ in, until they fit;
+ * then every split between the two masks is tried. Standard and extended IDs never share a mask. The result's
+ * unwanted field is the residual pass-through, accepts() lists it.
+ * @param ids Subscribed CAN IDs, with CAN_EFF_FLAG for extended frames, duplicates allowed.
+ * @param count Number of IDs.
+ * @return Plan, valid false if count is 0 or the distinct IDs exceed CAN_FILTER_MAX_IDS.
+ */
+constexpr CanFilterPlan planCanFilters(const canid_t *ids, const uint8_t count)
+{
+    using namespace CanFilterPlanner;
+    ClusterSet set = {};
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        const bool ext = ids[i] & CAN_EFF_FLAG;
+        const uint32_t value = ids[i] & width(ext);
+        bool repeated = false;
+        for (uint8_t j = 0; j < set.n; ++j)
+            repeated = repeated || (set.c[j].ext == ext && set.c[j].base == value);
+        if (repeated)
+            continue;
+        if (set.n == CAN_FILTER_MAX_IDS)
+            return CanFilterPlan{};
+        set.c[set.n++] = Cluster{value, 0, ext};
+    }
+    if (set.n == 0)
+        return CanFilterPlan{};
+
+    const uint32_t wanted = set.n;
+    combine(set);
+    uint8_t ext_count = 0;
+    for (uint8_t i = 0; i < set.n; ++i)
+        ext_count += set.c[i].ext;
+    if (ext_count == 0 || ext_count == set.n)
+    {
+        reduce(set, ext_count != 0, 6);
+        return bestSplit(set, wanted);
+    }
+    const CanFilterPlan ext_first = mixedSplit(set, true, wanted);
+    const CanFilterPlan std_first = mixedSplit(set, false, wanted);
+    return ext_first.unwanted <= std_first.unwanted ? ext_first : std_first;
+}
+
+#endif // CAN_FILTER_HPP
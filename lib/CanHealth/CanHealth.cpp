@@ -0,0 +1,161 @@
+/**
+ * @file CanHealth.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the CanHealth class
+ * @version 1.0
+ * @date 2026-10-16
+ * @see CanHealth.hpp
+ */
+
+#include "CanHealth.hpp"
+#include "SpiStats.hpp"
+
+namespace
+{
+    // SPI bytes of the autowp 1.3 calls of poll(), for SpiStats: three register READs
+    constexpr uint8_t POLL_SPI_BYTES = 9;
+    constexpr uint8_t POLL_SPI_SELECTS = 3;
+} // namespace
+
+/**
+ * @brief Construct a new CanHealth, error active and online until the first poll says otherwise.
+ * @param bus_ Controller index, for the telemetry mux.
+ * @param mcp_ Controller to poll.
+ * @param tx_ Transmit queue of the controller.
+ * @param rx_ Receive queue of the controller, nullptr if it has none.
+ * @param init_ Reinitialisation after bus-off, the same steps as in setup().
+ * @param kbps_ Bitrate in kbit/s, for the bus load.
+ */
+CanHealth::CanHealth(const McpIndex bus_, MCP2515 &mcp_, CanTx &tx_, CanRx *rx_, const CanInit init_, const uint16_t kbps_)
+    : bus(bus_),
+      mcp(mcp_),
+      tx(tx_),
+      rx(rx_),
+      init(init_),
+      kbps(kbps_),
+      state(CanBusState::Active),
+      tec(0),
+      rec(0),
+      load(0),
+      bus_offs(0),
+      reinits(0),
+      stable_polls(0),
+      backoff_ms(CAN_HEALTH_RETRY_MS),
+      retry_ms(0),
+      last_poll_ms(0),
+      last_bits(0)
+{
+}
+
+/**
+ * @brief Reads the error state and updates the bus load, or reinitialises the controller once its bus-off wait is over.
+ * Call periodically from the main loop, e.g. a Scheduler task every 100ms.
+ * @param now_ms Current time in ms.
+ */
+void CanHealth::poll(const uint32_t now_ms)
+{
+    if (state == CanBusState::BusOff)
+    {
+        if (static_cast<int32_t>(now_ms - retry_ms) < 0)
+            return; // no SPI traffic while waiting
+        CanTx::waitIdle();
+        if (reinits < 0xFF)
+            ++reinits;
+        if (init == nullptr || !init(mcp))
+        {
+            retry_ms = now_ms + backoff_ms;
+            backoff_ms = backoff_ms > CAN_HEALTH_RETRY_MAX_MS / 2 ? CAN_HEALTH_RETRY_MAX_MS : backoff_ms * 2;
+            return;
+        }
+        state = CanBusState::Active;
+        tec = 0;
+        rec = 0;
+        stable_polls = 0;
+        setOnline(true, true);
+        last_poll_ms = now_ms;
+        last_bits = wireBits();
+        return;
+    }
+
+    CanTx::waitIdle();
+    SpiStats::add(POLL_SPI_BYTES, POLL_SPI_SELECTS);
+    const uint8_t eflg = mcp.getErrorFlags();
+    tec = mcp.errorCountTX();
+    rec = mcp.errorCountRX();
+
+    const uint32_t bits = wireBits();
+    const uint32_t bits_per_percent = static_cast<uint32_t>(kbps) * (now_ms - last_poll_ms) / 100;
+    if (bits_per_percent != 0)
+    {
+        const uint32_t percent = (bits - last_bits) / bits_per_percent;
+        load = percent > 100 ? 100 : percent;
+        last_bits = bits;
+        last_poll_ms = now_ms;
+    }
+
+    if (eflg & MCP2515::EFLG_TXBO)
+    {
+        state = CanBusState::BusOff;
+        if (bus_offs < 0xFF)
+            ++bus_offs;
+        stable_polls = 0;
+        setOnline(false, false);
+        retry_ms = now_ms + backoff_ms;
+        backoff_ms = backoff_ms > CAN_HEALTH_RETRY_MAX_MS / 2 ? CAN_HEALTH_RETRY_MAX_MS : backoff_ms * 2;
+        return;
+    }
+
+    if (eflg & (MCP2515::EFLG_TXEP | MCP2515::EFLG_RXEP))
+        state = CanBusState::Passive;
+    else if (eflg & MCP2515::EFLG_EWARN)
+        state = CanBusState::Warning;
+    else
+        state = CanBusState::Active;
+    setOnline(!(eflg & MCP2515::EFLG_TXEP), true);
+
+    if (state != CanBusState::Active)
+        stable_polls = 0;
+    else if (stable_polls < CAN_HEALTH_STABLE_POLLS && ++stable_polls == CAN_HEALTH_STABLE_POLLS)
+        backoff_ms = CAN_HEALTH_RETRY_MS;
+}
+
+/**
+ * @brief Fills the telemetry frame of this controller.
+ * @param frame Frame to fill.
+ */
+void CanHealth::report(TelemetryFrameCan &frame) const
+{
+    uint32_t lost = static_cast<uint32_t>(tx.getDropped()) + tx.getRefused();
+    if (rx != nullptr)
+        lost += static_cast<uint32_t>(rx->getDropped()) + rx->getOverruns();
+    frame.bus = bus;
+    frame.state = state;
+    frame.tec = tec;
+    frame.rec = rec;
+    frame.load = load;
+    frame.bus_off = bus_offs;
+    frame.reinits = reinits;
+    frame.lost = lost > 0xFFFF ? 0xFFFF : lost;
+}
+
+/**
+ * @brief Returns the bus bits sent and received by this controller so far.
+ * @return Bits, wrapping.
+ */
+uint32_t CanHealth::wireBits() const
+{
+    return tx.getWireBits() + (rx != nullptr ? rx->getWireBits() : 0);
+}
+
+/**
+ * @brief Switches CanTx and CanRx, CanTx only when it changes, as going online forgets its TX buffer priorities.
+ * @param tx_online CanTx accepts frames.
+ * @param rx_online CanRx reads the controller.
+ */
+void CanHealth::setOnline(const bool tx_online, const bool rx_online)
+{
+    if (tx.isOnline() != tx_online)
+        tx.setOnline(tx_online);
+    if (rx != nullptr)
+        rx->setOnline(rx_online);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file CanHealth.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the CanHealth class, error state polling and bus-off recovery of one MCP2515
+ * @version 1.0
+ * @date 2026-10-16
+ * @see CanHealth.cpp
+ * @dir CanHealth @brief The CanHealth library contains the CanHealth class, which polls the error counters of an MCP2515, takes it offline when its bus is dead and reinitialises it with exponential backoff after bus-off.
+ */
+
+#ifndef CAN_HEALTH_HPP
+#define CAN_HEALTH_HPP
+
+#include <stdint.h>
+#include "CarState.hpp"
+#include "CanRx.hpp"
+#include "CanTx.hpp"
+#include "Enums.hpp"
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+/**
+ * @brief First retry after a bus-off, in ms, doubled on every bus-off that follows a retry up to CAN_HEALTH_RETRY_MAX_MS.
+ */
+#ifndef CAN_HEALTH_RETRY_MS
+#define CAN_HEALTH_RETRY_MS 100
+#endif
+
+/**
+ * @brief Longest wait between retries, in ms.
+ */
+#ifndef CAN_HEALTH_RETRY_MAX_MS
+#define CAN_HEALTH_RETRY_MAX_MS 6400
+#endif
+
+constexpr uint8_t CAN_HEALTH_STABLE_POLLS = 10; /**< Error active polls in a row that reset the backoff */
+static_assert(CAN_HEALTH_RETRY_MS > 0 && CAN_HEALTH_RETRY_MS <= CAN_HEALTH_RETRY_MAX_MS, "CAN_HEALTH_RETRY_MS out of range");
+static_assert(CAN_HEALTH_RETRY_MAX_MS <= 0x7FFF, "CAN_HEALTH_RETRY_MAX_MS must fit the 16-bit backoff");
+
+/**
+ * @brief Reinitialises a controller after bus-off: reset, bitrate, masks and filters, normal mode.
+ * @return true if every step succeeded.
+ */
+using CanInit = bool (*)(MCP2515 &mcp);
+
+/**
+ * @brief Error state and bus-off recovery of one MCP2515, polled from a Scheduler task.
+ * @details poll() reads EFLG, TEC and REC (9 SPI bytes). While the controller can't send, bus-off or transmit error
+ * passive (nothing acknowledges its frames, e.g. a dead transceiver or nobody else on the bus), the CanTx of the bus
+ * refuses frames at once instead of queuing them behind buffers that never empty. Transmit error passive clears by
+ * itself once frames are acknowledged again. After bus-off the CanRx stops reading too, polls stop, and the controller
+ * is reinitialised after CAN_HEALTH_RETRY_MS, waiting twice as long after every bus-off that follows, until
+ * CAN_HEALTH_STABLE_POLLS error active polls in a row reset the wait.
+ * Bus load is taken from the bits CanTx and CanRx moved between polls, so it only counts this controller's frames.
+ */
+class CanHealth
+{
+public:
+    CanHealth(const McpIndex bus_, MCP2515 &mcp_, CanTx &tx_, CanRx *rx_, const CanInit init_, const uint16_t kbps_);
+    void poll(const uint32_t now_ms);
+    void report(TelemetryFrameCan &frame) const;
+
+    /**
+     * @brief Returns the error state of the last poll.
+     * @return Error state, BusOff until the reinitialisation succeeded.
+     */
+    CanBusState getState() const { return state; }
+
+    /**
+     * @brief Returns how many times the controller went bus-off.
+     * @return Bus-off events, saturating.
+     */
+    uint8_t getBusOffs() const { return bus_offs; }
+
+    /**
+     * @brief Returns how many times the controller was reinitialised after bus-off.
+     * @return Reinitialisations, saturating.
+     */
+    uint8_t getReinits() const { return reinits; }
+
+private:
+    McpIndex bus;            /**< Controller, for the telemetry mux */
+    MCP2515 &mcp;            /**< Controller polled */
+    CanTx &tx;               /**< Transmit queue of the controller */
+    CanRx *rx;               /**< Receive queue of the controller, nullptr if it has none */
+    CanInit init;            /**< Reinitialisation after bus-off */
+    uint16_t kbps;           /**< Bitrate, for the bus load */
+    CanBusState state;       /**< Error state of the last poll */
+    uint8_t tec;             /**< TEC of the last poll */
+    uint8_t rec;             /**< REC of the last poll */
+    uint8_t load;            /**< Bus load between the last two polls, in % */
+    uint8_t bus_offs;        /**< Bus-off events */
+    uint8_t reinits;         /**< Reinitialisations */
+    uint8_t stable_polls;    /**< Error active polls in a row */
+    uint16_t backoff_ms;     /**< Wait before the next reinitialisation */
+    uint32_t retry_ms;       /**< Time of the next reinitialisation, while bus-off */
+    uint32_t last_poll_ms;   /**< Time of the last poll */
+    uint32_t last_bits;      /**< CanTx and CanRx bits at the last poll */
+
+    uint32_t wireBits() const;
+    void setOnline(const bool tx_online, const bool rx_online);
+};
+
+#endif // CAN_HEALTH_HPP
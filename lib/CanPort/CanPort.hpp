@@ -0,0 +1,76 @@
+/**
+ * @file CanPort.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration and definition of the CanPort interface and Mcp2515Port, its MCP2515 backend
+ * @version 1.0
+ * @date 2026-10-16
+ * @see VirtualCanBus.hpp, SocketCanPort.hpp
+ * @dir CanPort @brief The CanPort library contains the CanPort interface the modules send and receive frames through, with backends for the MCP2515 (Mcp2515Port), an in-process bus of simulated nodes (VirtualCanBus) and Linux SocketCAN (SocketCanPort).
+ */
+
+#ifndef CAN_PORT_HPP
+#define CAN_PORT_HPP
+
+#include <stdint.h>
+#include "CanTx.hpp"
+#include "CanRx.hpp"
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+/**
+ * @brief One node's access to a CAN bus, what Pedal, BMS, Telemetry and Debug_CAN send through.
+ * @details The error codes are the MCP2515 ones, so the backends are drop-ins for CanTx and CanRx.
+ */
+class CanPort
+{
+public:
+    /**
+     * @brief Sends a frame, or queues it and returns.
+     * @param frame Frame to send.
+     * @param stamp true to keep the time it leaves the node for takeStamp().
+     * @return MCP2515::ERROR_OK if sent or queued, MCP2515::ERROR_ALLTXBUSY if there is no room, MCP2515::ERROR_FAILTX otherwise.
+     */
+    virtual MCP2515::ERROR send(const can_frame *frame, const bool stamp = false) = 0;
+
+    /**
+     * @brief Takes the next received frame.
+     * @param[out] frame Received frame.
+     * @return MCP2515::ERROR_OK if a frame was read, MCP2515::ERROR_NOMSG if there is none.
+     */
+    virtual MCP2515::ERROR read(can_frame *frame) = 0;
+
+    /**
+     * @brief Takes the stamp of the last frame sent with stamp set.
+     * @param[out] sent_us micros() it left the node at, unchanged if false is returned.
+     * @return true if there was a new stamp.
+     */
+    virtual bool takeStamp(uint32_t &sent_us) = 0;
+};
+
+/**
+ * @brief CanPort of an MCP2515, sending through its CanTx and receiving from its CanRx.
+ */
+class Mcp2515Port : public CanPort
+{
+public:
+    /**
+     * @brief Construct a new Mcp2515Port.
+     * @param tx_ Transmit queue of the controller.
+     * @param rx_ Receive queue of the controller, nullptr if it only sends.
+     */
+    Mcp2515Port(CanTx &tx_, CanRx *rx_) : tx(tx_), rx(rx_) {}
+
+    MCP2515::ERROR send(const can_frame *frame, const bool stamp = false) override { return tx.send(frame, stamp); }
+    MCP2515::ERROR read(can_frame *frame) override { return rx != nullptr ? rx->read(frame) : MCP2515::ERROR_NOMSG; }
+    bool takeStamp(uint32_t &sent_us) override { return tx.takeStamp(sent_us); }
+
+private:
+    CanTx &tx; /**< Transmit queue */
+    CanRx *rx; /**< Receive queue, nullptr if none */
+};
+
+#endif // CAN_PORT_HPP
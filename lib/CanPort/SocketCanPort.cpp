@@ -0,0 +1,151 @@
+/**
+ * @file SocketCanPort.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the SocketCanPort class
+ * @version 1.0
+ * @date 2026-10-16
+ * @see SocketCanPort.hpp
+ */
+
+#include "SocketCanPort.hpp"
+
+#if CAN_PORT_SOCKETCAN
+
+#include <Arduino.h> // micros()
+#include <errno.h>
+#include <net/if.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    // <linux/can.h> can't be included next to can.h, both define can_frame, so the few kernel names are mirrored here
+    constexpr int CAN_RAW_PROTOCOL = 1; /**< CAN_RAW */
+
+    /**
+     * @brief struct sockaddr_can, family and interface index, the protocol addresses are unused for CAN_RAW.
+     */
+    struct SockaddrCan
+    {
+        sa_family_t can_family; /**< AF_CAN */
+        int can_ifindex;        /**< Interface index */
+        uint64_t can_addr[2];   /**< Transport protocol addresses, zero */
+    };
+
+    // the kernel's struct can_frame has the same layout: ID, length, 3 reserved bytes, 8 data bytes
+    static_assert(sizeof(can_frame) == 16, "can_frame must match the SocketCAN frame layout");
+} // namespace
+
+/**
+ * @brief Construct a closed SocketCanPort, see open().
+ */
+SocketCanPort::SocketCanPort()
+    : fd(-1),
+      stamped(false),
+      stamp_us(0)
+{
+}
+
+/**
+ * @brief Closes the socket.
+ */
+SocketCanPort::~SocketCanPort()
+{
+    close();
+}
+
+/**
+ * @brief Opens a raw CAN socket bound to an interface, closing any socket opened before.
+ * @param ifname Interface name, e.g. "vcan0".
+ * @return false if the interface doesn't exist or the socket can't be opened, the port stays closed.
+ */
+bool SocketCanPort::open(const char *ifname)
+{
+    close();
+    const unsigned int ifindex = ifname != nullptr ? if_nametoindex(ifname) : 0;
+    if (ifindex == 0)
+        return false;
+
+    fd = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW_PROTOCOL);
+    if (fd < 0)
+        return false;
+    SockaddrCan addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = static_cast<int>(ifindex);
+    if (::bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) < 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Closes the socket, the port can be opened again.
+ */
+void SocketCanPort::close()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+}
+
+/**
+ * @brief Writes a frame to the interface.
+ * @param frame Frame to send.
+ * @param stamp true to keep the write time for takeStamp().
+ * @return MCP2515::ERROR_OK if written, MCP2515::ERROR_ALLTXBUSY if the interface queue is full,
+ * MCP2515::ERROR_FAILTX if the port is closed, the frame invalid or the write failed.
+ */
+MCP2515::ERROR SocketCanPort::send(const can_frame *frame, const bool stamp)
+{
+    if (fd < 0 || frame == nullptr || frame->can_dlc > CAN_MAX_DLEN)
+        return MCP2515::ERROR_FAILTX;
+    can_frame out;
+    memset(&out, 0, sizeof(out)); // reserved bytes must be zero
+    out.can_id = frame->can_id;
+    out.can_dlc = frame->can_dlc;
+    memcpy(out.data, frame->data, frame->can_dlc);
+    if (::write(fd, &out, sizeof(out)) != static_cast<ssize_t>(sizeof(out)))
+        return (errno == EAGAIN || errno == ENOBUFS) ? MCP2515::ERROR_ALLTXBUSY : MCP2515::ERROR_FAILTX;
+    if (stamp)
+    {
+        stamp_us = micros();
+        stamped = true;
+    }
+    return MCP2515::ERROR_OK;
+}
+
+/**
+ * @brief Reads a frame from the interface without waiting.
+ * @param[out] frame Received frame.
+ * @return MCP2515::ERROR_OK if a frame was read, MCP2515::ERROR_NOMSG if none is waiting or the port is closed.
+ */
+MCP2515::ERROR SocketCanPort::read(can_frame *frame)
+{
+    if (fd < 0 || frame == nullptr)
+        return MCP2515::ERROR_NOMSG;
+    if (::read(fd, frame, sizeof(*frame)) != static_cast<ssize_t>(sizeof(*frame)))
+        return MCP2515::ERROR_NOMSG;
+    if (frame->can_dlc > CAN_MAX_DLEN)
+        frame->can_dlc = CAN_MAX_DLEN;
+    return MCP2515::ERROR_OK;
+}
+
+/**
+ * @brief Takes the stamp of the last frame sent with stamp set.
+ * @param[out] sent_us micros() it was written at, unchanged if false is returned.
+ * @return true if there was a new stamp.
+ */
+bool SocketCanPort::takeStamp(uint32_t &sent_us)
+{
+    if (!stamped)
+        return false;
+    sent_us = stamp_us;
+    stamped = false;
+    return true;
+}
+
+#endif // CAN_PORT_SOCKETCAN
@@ -0,0 +1,64 @@
+/**
+ * @file SocketCanPort.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the SocketCanPort class, a CanPort on a Linux SocketCAN interface
+ * @version 1.0
+ * @date 2026-10-16
+ * @see SocketCanPort.cpp, CanPort.hpp
+ */
+
+#ifndef SOCKET_CAN_PORT_HPP
+#define SOCKET_CAN_PORT_HPP
+
+/**
+ * @brief 1 where SocketCAN exists (Linux host builds), SocketCanPort is only declared then.
+ */
+#ifndef CAN_PORT_SOCKETCAN
+#if defined(__linux__) && !defined(__AVR__)
+#define CAN_PORT_SOCKETCAN 1
+#else
+#define CAN_PORT_SOCKETCAN 0
+#endif
+#endif
+
+#if CAN_PORT_SOCKETCAN
+
+#include <stdint.h>
+#include "CanPort.hpp"
+
+/**
+ * @brief CanPort on a raw CAN socket, e.g. a local vcan interface:
+ * `ip link add dev vcan0 type vcan && ip link set up vcan0`, then candump and cansend see the frames.
+ * @details The socket is non-blocking: send() returns MCP2515::ERROR_ALLTXBUSY when the interface queue is full,
+ * read() returns MCP2515::ERROR_NOMSG when nothing is waiting. Own frames are not received back.
+ */
+class SocketCanPort : public CanPort
+{
+public:
+    SocketCanPort();
+    ~SocketCanPort();
+    SocketCanPort(const SocketCanPort &) = delete;
+    SocketCanPort &operator=(const SocketCanPort &) = delete;
+
+    bool open(const char *ifname);
+    void close();
+
+    /**
+     * @brief Returns whether the socket is bound to an interface.
+     * @return true after a successful open().
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    MCP2515::ERROR send(const can_frame *frame, const bool stamp = false) override;
+    MCP2515::ERROR read(can_frame *frame) override;
+    bool takeStamp(uint32_t &sent_us) override;
+
+private:
+    int fd;            /**< Socket, -1 if closed */
+    bool stamped;      /**< stamp_us holds a stamp takeStamp() hasn't taken */
+    uint32_t stamp_us; /**< micros() the last stamped frame was written at */
+};
+
+#endif // CAN_PORT_SOCKETCAN
+
+#endif // SOCKET_CAN_PORT_HPP
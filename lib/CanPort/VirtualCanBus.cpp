@@ -0,0 +1,119 @@
+/**
+ * @file VirtualCanBus.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the VirtualCanBus and VirtualCanPort classes
+ * @version 1.0
+ * @date 2026-10-16
+ * @see VirtualCanBus.hpp
+ */
+
+#include "VirtualCanBus.hpp"
+#include <Arduino.h> // micros()
+
+/**
+ * @brief Construct a new VirtualCanBus without ports.
+ */
+VirtualCanBus::VirtualCanBus()
+    : ports{nullptr},
+      port_count(0),
+      frames(0)
+{
+}
+
+/**
+ * @brief Links a port to the bus, VirtualCanPort does this on construction.
+ * @param port Port to attach.
+ * @return false if the bus already has VIRTUAL_CAN_MAX_NODES ports.
+ */
+bool VirtualCanBus::attach(VirtualCanPort &port)
+{
+    if (port_count >= VIRTUAL_CAN_MAX_NODES)
+        return false;
+    ports[port_count++] = &port;
+    return true;
+}
+
+/**
+ * @brief Hands a frame to every port except the sender.
+ * @param from Sending port.
+ * @param frame Frame sent.
+ */
+void VirtualCanBus::deliver(const VirtualCanPort &from, const can_frame &frame)
+{
+    ++frames;
+    for (uint8_t i = 0; i < port_count; ++i)
+    {
+        if (ports[i] != &from)
+            ports[i]->receive(frame);
+    }
+}
+
+/**
+ * @brief Construct a new VirtualCanPort and attach it to a bus.
+ * @param bus_ Bus to attach to, must have room, see VIRTUAL_CAN_MAX_NODES.
+ */
+VirtualCanPort::VirtualCanPort(VirtualCanBus &bus_)
+    : bus(bus_)
+{
+    bus.attach(*this);
+}
+
+/**
+ * @brief Sends a frame to the other ports of the bus, it is received before this returns.
+ * @param frame Frame to send.
+ * @param stamp true to keep the send time for takeStamp().
+ * @return MCP2515::ERROR_OK, MCP2515::ERROR_FAILTX if the frame is invalid.
+ */
+MCP2515::ERROR VirtualCanPort::send(const can_frame *frame, const bool stamp)
+{
+    if (frame == nullptr || frame->can_dlc > CAN_MAX_DLEN)
+        return MCP2515::ERROR_FAILTX;
+    if (stamp)
+    {
+        stamp_us = micros();
+        stamped = true;
+    }
+    bus.deliver(*this, *frame);
+    return MCP2515::ERROR_OK;
+}
+
+/**
+ * @brief Takes the oldest received frame.
+ * @param[out] frame Received frame.
+ * @return MCP2515::ERROR_OK if a frame was read, MCP2515::ERROR_NOMSG if there is none.
+ */
+MCP2515::ERROR VirtualCanPort::read(can_frame *frame)
+{
+    if (frame == nullptr || !queue.pop(*frame))
+        return MCP2515::ERROR_NOMSG;
+    return MCP2515::ERROR_OK;
+}
+
+/**
+ * @brief Takes the stamp of the last frame sent with stamp set.
+ * @param[out] sent_us micros() it was sent at, unchanged if false is returned.
+ * @return true if there was a new stamp.
+ */
+bool VirtualCanPort::takeStamp(uint32_t &sent_us)
+{
+    if (!stamped)
+        return false;
+    sent_us = stamp_us;
+    stamped = false;
+    return true;
+}
+
+/**
+ * @brief Queues a frame from another port of the bus, called by VirtualCanBus::deliver().
+ * @param frame Frame received.
+ */
+void VirtualCanPort::receive(const can_frame &frame)
+{
+    if (queue.full())
+    {
+        if (dropped < 0xFFFF)
+            ++dropped;
+        return;
+    }
+    queue.push(frame);
+}
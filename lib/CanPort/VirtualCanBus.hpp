@@ -0,0 +1,73 @@
+/**
+ * @file VirtualCanBus.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the VirtualCanBus and VirtualCanPort classes, an in-process CAN bus of simulated nodes
+ * @version 1.0
+ * @date 2026-10-16
+ * @see VirtualCanBus.cpp, CanPort.hpp
+ */
+
+#ifndef VIRTUAL_CAN_BUS_HPP
+#define VIRTUAL_CAN_BUS_HPP
+
+#include <stdint.h>
+#include "CanPort.hpp"
+#include "Queue.hpp"
+
+constexpr uint8_t VIRTUAL_CAN_MAX_NODES = 8; /**< Ports one VirtualCanBus links */
+constexpr uint8_t VIRTUAL_CAN_RX_SIZE = 16;  /**< Frames a VirtualCanPort holds until read */
+
+class VirtualCanPort;
+
+/**
+ * @brief In-process CAN bus, every frame sent by one port is received by all the others at once.
+ * @details No arbitration, bit timing or error handling: a frame is delivered inside send(), so multi-node scenarios
+ * (VCU, Bamocar, BMS, datalogger) run as fast as the host does. A port whose receive queue is full loses the frame,
+ * counted in its getDropped(), like an MCP2515 RX overflow.
+ */
+class VirtualCanBus
+{
+public:
+    VirtualCanBus();
+    bool attach(VirtualCanPort &port);
+    void deliver(const VirtualCanPort &from, const can_frame &frame);
+
+    /**
+     * @brief Returns the frames sent on the bus.
+     * @return Frames, wrapping.
+     */
+    uint32_t getFrames() const { return frames; }
+
+private:
+    VirtualCanPort *ports[VIRTUAL_CAN_MAX_NODES]; /**< Attached ports, in attach order */
+    uint8_t port_count;                           /**< Number of attached ports */
+    uint32_t frames;                              /**< Frames sent on the bus */
+};
+
+/**
+ * @brief CanPort of one node on a VirtualCanBus.
+ */
+class VirtualCanPort : public CanPort
+{
+public:
+    explicit VirtualCanPort(VirtualCanBus &bus_);
+    MCP2515::ERROR send(const can_frame *frame, const bool stamp = false) override;
+    MCP2515::ERROR read(can_frame *frame) override;
+    bool takeStamp(uint32_t &sent_us) override;
+    void receive(const can_frame &frame);
+
+    /**
+     * @brief Returns how many frames were lost because the receive queue was full.
+     * @return Dropped frames, saturating.
+     */
+    uint16_t getDropped() const { return dropped; }
+
+private:
+    VirtualCanBus &bus;                                  /**< Bus the port is attached to */
+    RingBuffer<can_frame, VIRTUAL_CAN_RX_SIZE> queue{}; /**< Received frames not read yet */
+    uint16_t dropped = 0;                                /**< Frames lost to a full queue */
+    bool stamped = false;                                /**< stamp_us holds a stamp takeStamp() hasn't taken */
+    uint32_t stamp_us = 0;                               /**< micros() the last stamped frame was sent at */
+};
+
+#endif // VIRTUAL_CAN_BUS_HPP
@@ -0,0 +1,356 @@
+/**
+ * @file CanRx.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the CanRx class
+ * @version 1.5
+ * @date 2026-10-17
+ * @see CanRx.hpp
+ */
+
+#include "CanRx.hpp"
+#include "CanTx.hpp"
+#include "SpiStats.hpp"
+#include <Arduino.h>
+#include <SPI.h>
+#include <string.h>
+
+#ifdef __AVR__
+#include <util/atomic.h>
+#define CAN_RX_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#include "NativeHost.hpp"
+// native: the ISR only runs when the host injects a frame, never in the middle of read()
+#define CAN_RX_ATOMIC
+#endif
+
+namespace
+{
+    constexpr uint8_t INSTRUCTION_RX_STATUS = 0xB0; /**< RX STATUS, status byte follows */
+    constexpr uint8_t INSTRUCTION_READ_RX0 = 0x90;  /**< READ RX BUFFER at RXB0SIDH, + 4 for RXB1 */
+    constexpr uint8_t RX_STATUS_RXB0 = 0x40;        /**< RX STATUS, message in RXB0 */
+    constexpr uint8_t RX_STATUS_RXB1 = 0x80;        /**< RX STATUS, message in RXB1 */
+    constexpr uint8_t SIDL_SRR = 0x10;              /**< RXBnSIDL standard frame remote request */
+    constexpr uint8_t SIDL_IDE = 0x08;              /**< RXBnSIDL extended identifier */
+    constexpr uint8_t DLC_RTR = 0x40;               /**< RXBnDLC extended frame remote request */
+
+    // SPI bytes of the autowp 1.3 calls, for SpiStats: READ is 2 + n bytes, BIT MODIFY 4
+    constexpr uint8_t AUTOWP_READ_REGISTER = 3;      /**< getInterrupts(), getErrorFlags() */
+    constexpr uint8_t AUTOWP_MODIFY_REGISTER = 4;    /**< clearRXnOVRFlags(), clearERRIF(), clearMERR() */
+    constexpr uint8_t AUTOWP_READ_MESSAGE = 16;      /**< readMessage(RXBn) without data: SIDH-DLC, CTRL, data address, clear RXnIF */
+    constexpr uint8_t AUTOWP_READ_MESSAGE_SELECTS = 4;
+} // namespace
+
+CanRx *CanRx::instances[CanRx::NUM_EXT_INTERRUPTS] = {nullptr};
+
+/**
+ * @brief Construct a new CanRx on a ring, see the public constructor.
+ * @param mcp_ Controller to receive from.
+ * @param cs_pin_ Chip select pin of the controller.
+ * @param ring_ Storage of the ring.
+ * @param size Frames in ring_, a power of 2.
+ */
+CanRx::CanRx(MCP2515 &mcp_, const uint8_t cs_pin_, can_frame *ring_, const uint8_t size)
+    : mcp(mcp_),
+      ring(ring_),
+      ring_mask(size - 1),
+      head(0),
+      count(0),
+      dropped(0),
+      overruns(0),
+      wire_bits(0),
+      online(true),
+      int_pin(0),
+      int_num(-1),
+#ifdef __AVR__
+      cs_port(portOutputRegister(digitalPinToPort(cs_pin_))),
+      cs_mask(digitalPinToBitMask(cs_pin_))
+#else
+      cs_port(nullptr),
+      cs_mask(0)
+#endif
+{
+#ifndef __AVR__
+    (void)cs_pin_;
+#endif
+}
+
+/**
+ * @brief Attaches the INT line of the MCP2515, call after the MCP2515 is in normal mode.
+ * @param int_pin_ Pin wired to the MCP2515 INT line, must be an external interrupt pin (PD2/PD3).
+ * @return true if interrupt-driven, false if the pin has no external interrupt or it's taken, reads keep polling.
+ */
+bool CanRx::begin(const uint8_t int_pin_)
+{
+    const int8_t num = digitalPinToInterrupt(int_pin_);
+    if (num < 0 || num >= NUM_EXT_INTERRUPTS || instances[num] != nullptr)
+        return false;
+
+    int_pin = int_pin_;
+    int_num = num;
+    instances[num] = this;
+    pinMode(int_pin, INPUT_PULLUP); // INT is open-drain-like, active low
+    SPI.usingInterrupt(num);        // mask INT during every other SPI transaction
+    drain();                        // frames received before now would never produce an edge
+    attachInterrupt(num, num == 0 ? isr0 : isr1, FALLING);
+    return true;
+}
+
+/**
+ * @brief Reads the oldest received frame, drop-in for MCP2515::readMessage().
+ * @param frame Output frame.
+ * @return MCP2515::ERROR_OK if a frame was read, MCP2515::ERROR_NOMSG otherwise.
+ */
+MCP2515::ERROR CanRx::read(can_frame *frame)
+{
+    if (frame == nullptr)
+        return MCP2515::ERROR_FAIL;
+    if (!online)
+        return MCP2515::ERROR_NOMSG;
+    if (int_num < 0)
+    {
+        if (count == 0)
+        {
+            CanTx::waitIdle(); // SPI may still be shifting out a queued frame
+            drain();
+        }
+        return pop(*frame) ? MCP2515::ERROR_OK : MCP2515::ERROR_NOMSG;
+    }
+
+    if (count == 0 && digitalRead(int_pin) == LOW)
+    {
+        // INT is low but no edge reached us, e.g. an error flag held it low when a frame arrived
+        CanTx::waitIdle();
+        CAN_RX_ATOMIC
+        {
+            drain();
+        }
+    }
+
+    MCP2515::ERROR result = MCP2515::ERROR_NOMSG;
+    CAN_RX_ATOMIC
+    {
+        if (pop(*frame))
+            result = MCP2515::ERROR_OK;
+    }
+    return result;
+}
+
+/**
+ * @brief Moves every received frame from the MCP2515 into the ring, from the ISR or from read() when polling.
+ * One status read tells which RX buffers are full, both are read before checking again.
+ * Clears ERRIF/MERRF if set, so INT goes high again and the next frame produces an edge, counting RX overflows.
+ */
+void CanRx::drain()
+{
+#if CAN_RX_FAST_SPI
+    bool both_full = false;
+    for (;;)
+    {
+        const uint8_t status = rxStatus() & (RX_STATUS_RXB0 | RX_STATUS_RXB1);
+        if (status == 0)
+            break;
+        if (status == (RX_STATUS_RXB0 | RX_STATUS_RXB1))
+            both_full = true;
+        // RXB0 rolls over into RXB1, so RXB0 holds the older frame
+        if (status & RX_STATUS_RXB0)
+            store(MCP2515::RXB0);
+        if (status & RX_STATUS_RXB1)
+            store(MCP2515::RXB1);
+    }
+    // an overflow needs both buffers full, any other error flag only matters if it holds INT low
+    if (!both_full && (int_num < 0 || digitalRead(int_pin) != LOW))
+        return;
+    SpiStats::add(AUTOWP_READ_REGISTER);
+    checkErrors(mcp.getInterrupts());
+#else
+    SpiStats::add(AUTOWP_READ_REGISTER);
+    uint8_t intf = mcp.getInterrupts();
+    while (intf & (MCP2515::CANINTF_RX0IF | MCP2515::CANINTF_RX1IF))
+    {
+        // RXB0 rolls over into RXB1, so RXB0 holds the older frame
+        if (intf & MCP2515::CANINTF_RX0IF)
+            store(MCP2515::RXB0);
+        if (intf & MCP2515::CANINTF_RX1IF)
+            store(MCP2515::RXB1);
+        SpiStats::add(AUTOWP_READ_REGISTER);
+        intf = mcp.getInterrupts();
+    }
+    checkErrors(intf);
+#endif
+}
+
+/**
+ * @brief Counts and clears RX overflows and clears ERRIF/MERRF.
+ * @param intf CANINTF, as read by MCP2515::getInterrupts().
+ */
+void CanRx::checkErrors(const uint8_t intf)
+{
+    if (intf & MCP2515::CANINTF_ERRIF)
+    {
+        SpiStats::add(AUTOWP_READ_REGISTER);
+        if (mcp.getErrorFlags() & (MCP2515::EFLG_RX0OVR | MCP2515::EFLG_RX1OVR))
+        {
+            if (overruns < 0xFFFF)
+                overruns = overruns + 1;
+            SpiStats::add(AUTOWP_MODIFY_REGISTER);
+            mcp.clearRXnOVRFlags();
+        }
+        SpiStats::add(AUTOWP_MODIFY_REGISTER);
+        mcp.clearERRIF();
+    }
+    if (intf & MCP2515::CANINTF_MERRF)
+    {
+        SpiStats::add(AUTOWP_MODIFY_REGISTER);
+        mcp.clearMERR();
+    }
+}
+
+/**
+ * @brief Reads one RX buffer, releasing it, into the ring. When the ring is full the frame is dropped and counted.
+ * @param rxbn RX buffer flagged full.
+ */
+void CanRx::store(const MCP2515::RXBn rxbn)
+{
+    can_frame frame;
+#if CAN_RX_FAST_SPI
+    if (!readRxBuffer(rxbn, frame))
+        return;
+#else
+    if (mcp.readMessage(rxbn, &frame) != MCP2515::ERROR_OK)
+        return;
+    SpiStats::add(AUTOWP_READ_MESSAGE + frame.can_dlc, AUTOWP_READ_MESSAGE_SELECTS);
+#endif
+    wire_bits = wire_bits + CanTx::wireBits(frame.can_id, frame.can_dlc);
+    if (count > ring_mask)
+    {
+        if (dropped < 0xFFFF)
+            dropped = dropped + 1;
+        return;
+    }
+    ring[head] = frame;
+    head = (head + 1) & ring_mask;
+    count = count + 1;
+}
+
+/**
+ * @brief Takes the oldest frame out of the ring, the caller masks the interrupt if there is one.
+ * @param frame Output frame, untouched if the ring is empty.
+ * @return true if a frame was taken.
+ */
+bool CanRx::pop(can_frame &frame)
+{
+    if (count == 0)
+        return false;
+    frame = ring[(head - count) & ring_mask];
+    count = count - 1;
+    return true;
+}
+
+/**
+ * @brief Returns the bus bits of all frames read from the controller so far, for the bus load.
+ * @return Bits, wrapping.
+ */
+uint32_t CanRx::getWireBits() const
+{
+    uint32_t bits;
+    CAN_RX_ATOMIC
+    {
+        bits = wire_bits;
+    }
+    return bits;
+}
+
+/**
+ * @brief RX STATUS instruction, 2 bytes.
+ * @return Status byte, RX_STATUS_RXB0/RX_STATUS_RXB1 set for full buffers.
+ */
+uint8_t CanRx::rxStatus()
+{
+#ifdef __AVR__
+    SPI.beginTransaction(SPISettings(CAN_RX_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+    *cs_port &= ~cs_mask;
+    SPI.transfer(INSTRUCTION_RX_STATUS);
+    const uint8_t status = SPI.transfer(0x00);
+    *cs_port |= cs_mask;
+    SPI.endTransaction();
+#else
+    const uint8_t status = mcp.rxStatusInstruction();
+    NativeHost::advanceMicros(2 * NativeHost::costs.spi_byte);
+#endif
+    SpiStats::add(2);
+    return status;
+}
+
+/**
+ * @brief READ RX BUFFER instruction, clocking only the data bytes given by the DLC. Raising CS releases the buffer.
+ * @param rxbn Buffer to read.
+ * @param frame Output frame.
+ * @return true if a frame was read.
+ */
+bool CanRx::readRxBuffer(const MCP2515::RXBn rxbn, can_frame &frame)
+{
+    uint8_t regs[REGS_MAX];
+#ifdef __AVR__
+    SPI.beginTransaction(SPISettings(CAN_RX_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+    *cs_port &= ~cs_mask;
+    SPI.transfer(INSTRUCTION_READ_RX0 | (rxbn << 2));
+    for (uint8_t i = 0; i < 5; ++i)
+        regs[i] = SPI.transfer(0x00);
+    const uint8_t dlc = regs[4] & 0x0F;
+    const uint8_t len = 5 + (dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : dlc);
+    for (uint8_t i = 5; i < len; ++i)
+        regs[i] = SPI.transfer(0x00);
+    *cs_port |= cs_mask;
+    SPI.endTransaction();
+#else
+    const uint8_t len = mcp.readRxBuffer(rxbn, regs);
+    if (len == 0)
+        return false;
+    NativeHost::advanceMicros((1 + len) * NativeHost::costs.spi_byte);
+#endif
+    SpiStats::add(1 + len);
+    unpack(regs, len, frame);
+    return true;
+}
+
+/**
+ * @brief Unpacks the RX buffer register layout into a frame, the same as MCP2515::readMessage() returns.
+ * @param regs SIDH, SIDL, EID8, EID0, DLC, then the data bytes.
+ * @param len Bytes in regs, 5 + data length.
+ * @param frame Output frame.
+ */
+void CanRx::unpack(const uint8_t *regs, const uint8_t len, can_frame &frame)
+{
+    const uint8_t sidl = regs[1];
+    canid_t id = (static_cast<canid_t>(regs[0]) << 3) | (sidl >> 5);
+    if (sidl & SIDL_IDE)
+    {
+        id = (id << 18) | (static_cast<canid_t>(sidl & 0x03) << 16) | (static_cast<canid_t>(regs[2]) << 8) | regs[3];
+        id |= CAN_EFF_FLAG;
+        if (regs[4] & DLC_RTR)
+            id |= CAN_RTR_FLAG;
+    }
+    else if (sidl & SIDL_SRR)
+    {
+        id |= CAN_RTR_FLAG;
+    }
+    frame.can_id = id;
+    frame.can_dlc = len - 5;
+    memcpy(frame.data, regs + 5, frame.can_dlc);
+}
+
+/**
+ * @brief INT0 handler.
+ */
+void CanRx::isr0()
+{
+    instances[0]->drain();
+}
+
+/**
+ * @brief INT1 handler.
+ */
+void CanRx::isr1()
+{
+    instances[1]->drain();
+}
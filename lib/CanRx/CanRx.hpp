@@ -0,0 +1,131 @@
+/**
+ * @file CanRx.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the CanRx class, interrupt-driven receive queue for one MCP2515
+ * @version 1.5
+ * @date 2026-10-17
+ * @see CanRx.cpp
+ * @dir CanRx @brief The CanRx library contains the CanRx class, which drains an MCP2515 into a software queue from its INT line, so CAN consumers don't poll over SPI.
+ */
+
+#ifndef CAN_RX_HPP
+#define CAN_RX_HPP
+
+#include <stdint.h>
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+/**
+ * @brief CanRx SPI mode, if 1 drain() uses the RX STATUS and READ RX BUFFER instructions, if 0 the generic autowp register reads.
+ */
+#ifndef CAN_RX_FAST_SPI
+#define CAN_RX_FAST_SPI 1
+#endif
+
+/**
+ * @brief SPI clock of the CanRx fast path, in Hz, the same as the autowp calls use (the AVR runs it at 8MHz).
+ */
+#ifndef CAN_RX_SPI_CLOCK
+#define CAN_RX_SPI_CLOCK 10000000UL
+#endif
+
+constexpr uint8_t CAN_RX_QUEUE_SIZE = 8;          /**< Frames held for a controller taking any traffic, 16 bytes of SRAM each */
+constexpr uint8_t CAN_RX_QUEUE_SIZE_FILTERED = 4; /**< Frames held for a controller whose filters pass only a few routed IDs */
+
+/**
+ * @brief Receive queue for one MCP2515, filled from its INT line or in batches when polled.
+ * @details drain() empties both RX buffers (RXB0, RXB1) into the ring in one go. Without begin(), or if the pin has
+ * no external interrupt, read() drains whenever the ring is empty, so a consumer reading until ERROR_NOMSG once per
+ * tick sees every frame that arrived since the last tick, not just one per call.
+ * After begin(), the INT falling edge runs drain() in the ISR and read() pops from the ring without any SPI traffic.
+ * Frames lost to a full ring count in getDropped(), frames lost to full RX buffers on the chip in getOverruns().
+ * The ring is an array given to the constructor, so each bus is sized for its traffic, a power of 2 so the index is a mask.
+ * SPI.usingInterrupt() masks the INT while any other SPI transaction runs, so the ISR never cuts into one.
+ * If an edge was missed (e.g. INT still low from an error flag), read() sees INT low with an empty queue and drains itself.
+ * The SPI traffic from read() waits for CanTx to release the bus first.
+ *
+ * With CAN_RX_FAST_SPI, a frame costs one READ RX BUFFER of 6 + DLC bytes (e.g. 9 for a 3-byte frame), which releases
+ * the buffer when CS goes high, instead of the 16 + DLC bytes in 4 selects of MCP2515::readMessage(), and each check
+ * for full buffers is a 2-byte RX STATUS. CANINTF and EFLG are only read when an overflow was possible (both buffers
+ * were full) or the INT line is still low after the buffers are empty. Traffic is counted in SpiStats.
+ */
+class CanRx
+{
+public:
+    /**
+     * @brief Construct a new CanRx, polling until begin() is called.
+     * @tparam SIZE Frames the ring holds, a power of 2.
+     * @param mcp_ Controller to receive from, constructed (CS pin set up) before this.
+     * @param cs_pin_ Chip select pin of the controller, the same as given to mcp_.
+     * @param ring_ Storage of the ring, only used by this CanRx.
+     */
+    template <uint8_t SIZE>
+    CanRx(MCP2515 &mcp_, const uint8_t cs_pin_, can_frame (&ring_)[SIZE]) : CanRx(mcp_, cs_pin_, ring_, SIZE)
+    {
+        static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "CanRx ring size must be a power of 2");
+    }
+    bool begin(const uint8_t int_pin_);
+    MCP2515::ERROR read(can_frame *frame);
+    void drain();
+
+    /**
+     * @brief Returns whether the INT line is in use.
+     * @return true if frames come from the ISR, false if read() polls the MCP2515.
+     */
+    bool interruptDriven() const { return int_num >= 0; }
+
+    /**
+     * @brief Returns how many frames were dropped because the queue was full.
+     * @return Dropped frames, saturating.
+     */
+    uint16_t getDropped() const { return dropped; }
+
+    /**
+     * @brief Returns how many times the MCP2515 flagged an RX buffer overflow (EFLG.RX0OVR/RX1OVR), i.e. it wasn't drained in time.
+     * @return Overflows seen by drain(), saturating.
+     */
+    uint16_t getOverruns() const { return overruns; }
+
+    /**
+     * @brief Stops or resumes reading, from CanHealth. While offline read() returns ERROR_NOMSG without any SPI traffic.
+     * @param online_ false while the controller is bus-off.
+     */
+    void setOnline(const bool online_) { online = online_; }
+
+    uint32_t getWireBits() const;
+
+private:
+    static constexpr uint8_t NUM_EXT_INTERRUPTS = 2; /**< INT0, INT1 on the ATmega328P */
+    static constexpr uint8_t REGS_MAX = 5 + CAN_MAX_DLEN; /**< SIDH, SIDL, EID8, EID0, DLC, data */
+
+    MCP2515 &mcp;                         /**< Controller to drain */
+    can_frame *const ring;                /**< Received frames, pushed by drain(), popped by read() */
+    const uint8_t ring_mask;              /**< Ring size - 1 */
+    uint8_t head;                         /**< Slot the next frame goes to */
+    volatile uint8_t count;               /**< Frames in the ring */
+    volatile uint16_t dropped;            /**< Frames lost to a full ring */
+    volatile uint16_t overruns;           /**< RX buffer overflows flagged by the MCP2515 */
+    volatile uint32_t wire_bits;          /**< Bus bits of the frames read, see CanTx::wireBits() */
+    bool online;                          /**< read() talks to the controller, see setOnline() */
+    uint8_t int_pin;                      /**< Pin of the INT line */
+    int8_t int_num;                       /**< External interrupt number, -1 if polling */
+    volatile uint8_t *cs_port;            /**< Output register of the chip select pin, for the fast path */
+    uint8_t cs_mask;                      /**< Bit of the chip select pin in cs_port */
+
+    static CanRx *instances[NUM_EXT_INTERRUPTS]; /**< CanRx attached to each external interrupt */
+    CanRx(MCP2515 &mcp_, const uint8_t cs_pin_, can_frame *ring_, const uint8_t size);
+    bool pop(can_frame &frame);
+    void store(const MCP2515::RXBn rxbn);
+    void checkErrors(const uint8_t intf);
+    uint8_t rxStatus();
+    bool readRxBuffer(const MCP2515::RXBn rxbn, can_frame &frame);
+    static void unpack(const uint8_t *regs, const uint8_t len, can_frame &frame);
+    static void isr0();
+    static void isr1();
+};
+
+#endif // CAN_RX_HPP
@@ -0,0 +1,526 @@
+/**
+ * @file CanTx.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the CanTx class
+ * @version 1.4
+ * @date 2026-10-16
+ * @see CanTx.hpp
+ */
+
+#include "CanTx.hpp"
+#include "SpiStats.hpp"
+#include <Arduino.h>
+#include <string.h>
+
+#ifdef __AVR__
+#include <SPI.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+#define CAN_TX_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#include "NativeHost.hpp"
+// native: the engine runs to completion inside send(), nothing can interrupt it
+#define CAN_TX_ATOMIC
+#endif
+
+namespace
+{
+    constexpr uint8_t INSTRUCTION_READ_STATUS = 0xA0; /**< READ STATUS, status byte follows */
+    constexpr uint8_t INSTRUCTION_LOAD_TX0 = 0x40;    /**< LOAD TX BUFFER at TXB0SIDH, + 2 per buffer */
+    constexpr uint8_t INSTRUCTION_WRITE = 0x02;       /**< WRITE, address and data follow */
+    constexpr uint8_t INSTRUCTION_RTS = 0x80;         /**< RTS, bit n requests TXBn */
+    constexpr uint8_t TXP_UNKNOWN = 0xFF;             /**< CanTx::txp before the first WRITE to the buffer */
+    constexpr uint8_t TXB0CTRL = 0x30;                /**< TXB0CTRL address, TXB1/TXB2 are 0x10 apart */
+    constexpr uint8_t TXBCTRL_TXREQ = 0x08;           /**< TXBnCTRL transmit request, TXP is bits 1-0 */
+    constexpr uint8_t STATUS_TXREQ0 = 0x04;           /**< READ STATUS TXB0CNTRL.TXREQ, TXB1/TXB2 are 2 and 4 bits higher */
+    constexpr uint8_t TX_BUFFERS = 3;                 /**< TXB0-TXB2 */
+    constexpr uint8_t SIDL_EXIDE = 0x08;              /**< TXBnSIDL extended identifier enable */
+    constexpr uint8_t DLC_RTR = 0x40;                 /**< TXBnDLC remote transmission request */
+
+    static_assert(CanTx::txPriority(0x201) > CanTx::txPriority(0x700), "torque command must outrank telemetry");
+    static_assert(CanTx::txPriority(0x201) > CanTx::txPriority(0x690), "torque command must outrank debug");
+} // namespace
+
+CanTx *CanTx::buses[CAN_TX_MAX_BUSES] = {nullptr};
+uint8_t CanTx::bus_count = 0;
+uint8_t CanTx::next_bus = 0;
+CanTx *volatile CanTx::active = nullptr;
+CanTx::Step CanTx::step = CanTx::Step::Status;
+uint8_t CanTx::txb = 0;
+uint8_t CanTx::cmd[3] = {0};
+const uint8_t *CanTx::job_bytes = nullptr;
+uint8_t CanTx::job_len = 0;
+uint8_t CanTx::job_pos = 0;
+bool CanTx::in_transaction = false;
+
+/**
+ * @brief Construct a new CanTx and register it with the engine.
+ * @param mcp_ Controller to send through, constructed (CS pin set up) before this.
+ * @param cs_pin_ Chip select pin of the controller, the same as given to mcp_.
+ */
+CanTx::CanTx(MCP2515 &mcp_, const uint8_t cs_pin_)
+    : mcp(mcp_),
+      queue{},
+      used(0),
+      sending(0),
+      next_seq(0),
+      stalled(false),
+      dropped(0),
+      refused(0),
+      online(true),
+      wire_bits(0),
+      high_water(0),
+      stamp_slot(CAN_TX_QUEUE_SIZE),
+      stamped(false),
+      stamp_us(0),
+      txp{TXP_UNKNOWN, TXP_UNKNOWN, TXP_UNKNOWN},
+      index(bus_count),
+      cs_pin(cs_pin_),
+#ifdef __AVR__
+      cs_port(portOutputRegister(digitalPinToPort(cs_pin_))),
+      cs_mask(digitalPinToBitMask(cs_pin_))
+#else
+      cs_port(nullptr),
+      cs_mask(0)
+#endif
+{
+    if (bus_count < CAN_TX_MAX_BUSES)
+        buses[bus_count++] = this;
+}
+
+/**
+ * @brief Queues a frame and returns without waiting for SPI, drop-in for MCP2515::sendMessage().
+ * @param frame Frame to send.
+ * @param stamp true to keep the time its TXREQ is set for takeStamp(), replacing the stamp of a frame still queued.
+ * @return MCP2515::ERROR_OK if queued, MCP2515::ERROR_ALLTXBUSY if the queue is full (counted as dropped), MCP2515::ERROR_FAILTX if the frame is invalid.
+ */
+MCP2515::ERROR CanTx::send(const can_frame *frame, const bool stamp)
+{
+    if (frame == nullptr || frame->can_dlc > CAN_MAX_DLEN)
+        return MCP2515::ERROR_FAILTX;
+    if (!online)
+    {
+        if (refused < 0xFFFF)
+            ++refused;
+        return MCP2515::ERROR_FAILTX;
+    }
+#if CAN_TX_ASYNC
+    if (index >= CAN_TX_MAX_BUSES)
+        return MCP2515::ERROR_ALLTXBUSY;
+
+    // the engine only clears bits, so a stale copy can only miss a slot freed just now
+    const uint8_t in_use = used;
+    uint8_t slot = 0;
+    while (slot < CAN_TX_QUEUE_SIZE && (in_use & (1 << slot)))
+        ++slot;
+    if (slot == CAN_TX_QUEUE_SIZE)
+    {
+        if (dropped < 0xFFFF)
+            dropped = dropped + 1;
+        return MCP2515::ERROR_ALLTXBUSY;
+    }
+
+#ifndef __AVR__
+    NativeHost::advanceMicros(NativeHost::costs.tx_enqueue);
+#endif
+    pack(queue[slot], *frame);
+    queue[slot].seq = next_seq++;
+    uint8_t count = 0;
+    CAN_TX_ATOMIC
+    {
+        if (stamp)
+            stamp_slot = slot;
+        used = used | (1 << slot);
+        for (uint8_t bits = used; bits != 0; bits &= bits - 1)
+            ++count;
+    }
+    if (count > high_water)
+        high_water = count;
+    stalled = false;
+    kick();
+    return MCP2515::ERROR_OK;
+#else
+    // autowp 1.3: read TXBnCTRL of a free buffer, load it, set TXREQ, read TXBnCTRL back
+    SpiStats::add(17 + frame->can_dlc, 4);
+    const MCP2515::ERROR result = mcp.sendMessage(frame);
+    if (result == MCP2515::ERROR_OK)
+    {
+        wire_bits = wire_bits + wireBits(frame->can_id, frame->can_dlc);
+        if (stamp)
+        {
+            stamp_us = micros();
+            stamped = true;
+        }
+    }
+    return result;
+#endif
+}
+
+/**
+ * @brief Takes the stamp of the last stamped frame, once it was requested in the controller.
+ * @param[out] sent_us micros() its TXREQ was set at, unchanged if false is returned.
+ * @return true if there was a new stamp.
+ */
+bool CanTx::takeStamp(uint32_t &sent_us)
+{
+    bool taken = false;
+    CAN_TX_ATOMIC
+    {
+        if (stamped)
+        {
+            sent_us = stamp_us;
+            stamped = false;
+            taken = true;
+        }
+    }
+    return taken;
+}
+
+/**
+ * @brief Takes the controller offline or back online, from CanHealth.
+ * Going offline drops the queued frames, so nothing stale is sent once the bus is back. Call with online_ true after
+ * the controller was reinitialised, as the TX buffer priorities it had are gone.
+ * @param online_ true to accept frames again.
+ */
+void CanTx::setOnline(const bool online_)
+{
+    CAN_TX_ATOMIC
+    {
+        online = online_;
+        if (!online_)
+        {
+            used = 0;
+            stamp_slot = CAN_TX_QUEUE_SIZE;
+        }
+        stalled = false;
+        for (uint8_t i = 0; i < TX_BUFFERS; ++i)
+            txp[i] = TXP_UNKNOWN;
+    }
+}
+
+/**
+ * @brief Returns the bus bits of all frames handed to the controller so far, for the bus load.
+ * @return Bits, wrapping.
+ */
+uint32_t CanTx::getWireBits() const
+{
+    uint32_t bits;
+    CAN_TX_ATOMIC
+    {
+        bits = wire_bits;
+    }
+    return bits;
+}
+
+/**
+ * @brief Retries controllers skipped because all their TX buffers were busy, call once per loop().
+ */
+void CanTx::service()
+{
+    for (uint8_t i = 0; i < bus_count; ++i)
+        buses[i]->stalled = false;
+    kick();
+}
+
+/**
+ * @brief Waits until the engine has released SPI, call before any other SPI transaction from the main loop.
+ */
+void CanTx::waitIdle()
+{
+    while (active != nullptr)
+        ;
+}
+
+/**
+ * @brief Returns whether the engine holds SPI.
+ * @return true if a frame is being shifted out.
+ */
+bool CanTx::busy()
+{
+    return active != nullptr;
+}
+
+/**
+ * @brief Packs a frame into the TX buffer register layout, the same as MCP2515::sendMessage() writes.
+ * @param job Queue entry to fill.
+ * @param frame Frame to pack.
+ */
+void CanTx::pack(TxJob &job, const can_frame &frame)
+{
+    uint8_t *regs = job.bytes + 1;
+    if (frame.can_id & CAN_EFF_FLAG)
+    {
+        const uint32_t id = frame.can_id & CAN_EFF_MASK;
+        const uint16_t high = id >> 16;
+        // base ID, then IDE (a standard frame wins over an extended one with the same base ID), then the extension
+        job.key = ((id >> 18) << 19) | (1UL << 18) | (id & 0x3FFFF);
+        regs[0] = high >> 5;                                          // SIDH, ID 28-21
+        regs[1] = ((high & 0x1C) << 3) | SIDL_EXIDE | (high & 0x03); // SIDL, ID 20-18, EXIDE, ID 17-16
+        regs[2] = (id >> 8) & 0xFF;                                   // EID8
+        regs[3] = id & 0xFF;                                          // EID0
+    }
+    else
+    {
+        const uint16_t id = frame.can_id & CAN_SFF_MASK;
+        job.key = static_cast<uint32_t>(id) << 19;
+        regs[0] = id >> 3;
+        regs[1] = (id & 0x07) << 5;
+        regs[2] = 0;
+        regs[3] = 0;
+    }
+    regs[4] = frame.can_dlc | ((frame.can_id & CAN_RTR_FLAG) ? DLC_RTR : 0);
+    memcpy(regs + 5, frame.data, frame.can_dlc);
+    job.len = 1 + 5 + frame.can_dlc;
+    job.bits = wireBits(frame.can_id, frame.can_dlc);
+}
+
+/**
+ * @brief Finds the queued frame that goes first, the lowest arbitration key, the oldest of equal keys.
+ * @return Slot in queue, CAN_TX_QUEUE_SIZE if empty.
+ */
+uint8_t CanTx::firstSlot() const
+{
+    uint8_t first = CAN_TX_QUEUE_SIZE;
+    for (uint8_t slot = 0; slot < CAN_TX_QUEUE_SIZE; ++slot)
+    {
+        if (!(used & (1 << slot)))
+            continue;
+        if (first == CAN_TX_QUEUE_SIZE || queue[slot].key < queue[first].key ||
+            (queue[slot].key == queue[first].key && static_cast<int8_t>(queue[slot].seq - queue[first].seq) < 0))
+            first = slot;
+    }
+    return first;
+}
+
+/**
+ * @brief Starts the engine if it is idle.
+ */
+void CanTx::kick()
+{
+    CAN_TX_ATOMIC
+    {
+        if (active == nullptr)
+            start();
+    }
+}
+
+/**
+ * @brief Moves on to the bus after the active one, so a busy bus can't starve the others, and starts the next frame.
+ */
+void CanTx::next()
+{
+    next_bus = (active->index + 1) % bus_count;
+    active = nullptr;
+    start();
+}
+
+/**
+ * @brief Fills cmd with the instruction requesting the loaded TX buffer txb: RTS if it already has the frame's TXP,
+ * otherwise a WRITE to TXBnCTRL setting TXP and TXREQ. TXP stays in TXBnCTRL after the frame is sent.
+ * @param bus Bus being sent for, its current frame decides TXP, from the top 2 bits of the key, see txPriority().
+ * @return Instruction length.
+ */
+uint8_t CanTx::request(CanTx &bus)
+{
+    const uint8_t prio = 3 - (bus.queue[bus.sending].key >> 28);
+    if (bus.txp[txb] == prio)
+    {
+        cmd[0] = INSTRUCTION_RTS | (1 << txb);
+        return 1;
+    }
+    bus.txp[txb] = prio;
+    cmd[0] = INSTRUCTION_WRITE;
+    cmd[1] = TXB0CTRL + 0x10 * txb;
+    cmd[2] = TXBCTRL_TXREQ | prio;
+    return 3;
+}
+
+#ifdef __AVR__
+
+/**
+ * @brief Picks the next bus with a queued frame and starts its READ STATUS, or releases SPI if there is none.
+ * Called with interrupts disabled, from kick() or the SPI interrupt.
+ */
+void CanTx::start()
+{
+    for (uint8_t i = 0; i < bus_count; ++i)
+    {
+        CanTx *const bus = buses[(next_bus + i) % bus_count];
+        if (bus->used == 0 || bus->stalled)
+            continue;
+
+        active = bus;
+        if (!in_transaction)
+        {
+            // masks the CanRx INT handlers until endTransaction()
+            SPI.beginTransaction(SPISettings(CAN_TX_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+            SPCR |= _BV(SPIE);
+            in_transaction = true;
+        }
+        step = Step::Status;
+        cmd[0] = INSTRUCTION_READ_STATUS;
+        cmd[1] = 0;
+        transfer(cmd, 2);
+        return;
+    }
+
+    active = nullptr;
+    if (in_transaction)
+    {
+        SPCR &= ~_BV(SPIE);
+        SPI.endTransaction();
+        in_transaction = false;
+    }
+}
+
+/**
+ * @brief Selects the active controller and shifts out the first byte of an instruction, the interrupt does the rest.
+ * @param bytes Instruction bytes, must stay valid until the instruction is done.
+ * @param len Number of bytes.
+ */
+void CanTx::transfer(const uint8_t *bytes, const uint8_t len)
+{
+    job_bytes = bytes;
+    job_len = len;
+    job_pos = 0;
+    *active->cs_port &= ~active->cs_mask;
+    SPDR = bytes[0];
+}
+
+/**
+ * @brief SPI transfer complete, shifts out the next byte, or ends the instruction and moves to the next step.
+ */
+void CanTx::spiIsr()
+{
+    const uint8_t received = SPDR;
+    if (++job_pos < job_len)
+    {
+        SPDR = job_bytes[job_pos];
+        return;
+    }
+
+    CanTx *const bus = active;
+    *bus->cs_port |= bus->cs_mask;
+    SpiStats::add(job_len);
+    switch (step)
+    {
+    case Step::Status:
+        for (txb = 0; txb < TX_BUFFERS; ++txb)
+        {
+            if (!(received & (STATUS_TXREQ0 << (2 * txb))))
+                break;
+        }
+        if (txb == TX_BUFFERS)
+        {
+            // all TX buffers wait for the bus, try again on the next send() or service()
+            bus->stalled = true;
+            next();
+            return;
+        }
+        // pick the frame now, frames queued during READ STATUS may go first
+        bus->sending = bus->firstSlot();
+        bus->queue[bus->sending].bytes[0] = INSTRUCTION_LOAD_TX0 | (txb << 1);
+        step = Step::Load;
+        transfer(bus->queue[bus->sending].bytes, bus->queue[bus->sending].len);
+        return;
+    case Step::Load:
+        step = Step::Request;
+        transfer(cmd, request(*bus));
+        return;
+    case Step::Request:
+        bus->wire_bits = bus->wire_bits + bus->queue[bus->sending].bits;
+        if (bus->sending == bus->stamp_slot)
+        {
+            bus->stamp_us = micros();
+            bus->stamped = true;
+            bus->stamp_slot = CAN_TX_QUEUE_SIZE;
+        }
+        bus->used = bus->used & ~(1 << bus->sending);
+        next();
+        return;
+    }
+}
+
+#if CAN_TX_ASYNC
+/**
+ * @brief SPI serial transfer complete.
+ */
+ISR(SPI_STC_vect)
+{
+    CanTx::spiIsr();
+}
+#endif
+
+#else // native build, SPI transfers complete instantly on the MCP2515 stand-in
+
+/**
+ * @brief Runs the engine until every queue is empty or stalled, charging the interrupts the transfers would take.
+ */
+void CanTx::start()
+{
+    for (;;)
+    {
+        CanTx *bus = nullptr;
+        for (uint8_t i = 0; i < bus_count && bus == nullptr; ++i)
+        {
+            CanTx *const candidate = buses[(next_bus + i) % bus_count];
+            if (candidate->used != 0 && !candidate->stalled)
+                bus = candidate;
+        }
+        if (bus == nullptr)
+        {
+            active = nullptr;
+            return;
+        }
+        active = bus;
+
+        const uint8_t status = bus->mcp.readStatusInstruction();
+        NativeHost::advanceMicros(2 * NativeHost::costs.spi_isr_byte);
+        SpiStats::add(2);
+        for (txb = 0; txb < TX_BUFFERS; ++txb)
+        {
+            if (!(status & (STATUS_TXREQ0 << (2 * txb))))
+                break;
+        }
+        if (txb == TX_BUFFERS)
+        {
+            bus->stalled = true;
+            next_bus = (bus->index + 1) % bus_count;
+            continue;
+        }
+
+        bus->sending = bus->firstSlot();
+        TxJob &job = bus->queue[bus->sending];
+        job.bytes[0] = INSTRUCTION_LOAD_TX0 | (txb << 1);
+        bus->mcp.loadTxBuffer(static_cast<MCP2515::TXBn>(txb), job.bytes + 1, job.len - 1);
+        const uint8_t request_len = request(*bus);
+        if (request_len == 1)
+            bus->mcp.requestToSend(1 << txb);
+        else
+            bus->mcp.writeTxControl(static_cast<MCP2515::TXBn>(txb), cmd[2]);
+        NativeHost::advanceMicros((job.len + request_len) * NativeHost::costs.spi_isr_byte);
+        SpiStats::add(job.len + request_len, 2);
+        bus->wire_bits = bus->wire_bits + job.bits;
+        if (bus->sending == bus->stamp_slot)
+        {
+            bus->stamp_us = micros();
+            bus->stamped = true;
+            bus->stamp_slot = CAN_TX_QUEUE_SIZE;
+        }
+        bus->used = bus->used & ~(1 << bus->sending);
+        next_bus = (bus->index + 1) % bus_count;
+    }
+}
+
+void CanTx::transfer(const uint8_t *bytes, const uint8_t len)
+{
+    job_bytes = bytes;
+    job_len = len;
+}
+
+void CanTx::spiIsr()
+{
+}
+
+#endif // __AVR__
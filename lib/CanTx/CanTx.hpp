@@ -0,0 +1,203 @@
+/**
+ * @file CanTx.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the CanTx class, interrupt-driven SPI transmit queue for one MCP2515
+ * @version 1.4
+ * @date 2026-10-16
+ * @see CanTx.cpp
+ * @dir CanTx @brief The CanTx library contains the CanTx class, which queues frames per MCP2515 and shifts them out over SPI from the SPI interrupt, so senders don't wait for the transfer.
+ */
+
+#ifndef CAN_TX_HPP
+#define CAN_TX_HPP
+
+#include <stdint.h>
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+/**
+ * @brief CanTx mode, if 0 send() calls MCP2515::sendMessage() directly and blocks as before.
+ */
+#ifndef CAN_TX_ASYNC
+#define CAN_TX_ASYNC 1
+#endif
+
+/**
+ * @brief SPI clock of the CanTx engine, in Hz.
+ * @details Every byte costs one interrupt (~2us @ 16MHz). At 8MHz a byte shifts out in 1us, so the interrupts would
+ * take all the CPU; at 2MHz a byte takes 4us and about half of it is left for the code that queued the frame.
+ */
+#ifndef CAN_TX_SPI_CLOCK
+#define CAN_TX_SPI_CLOCK 2000000UL
+#endif
+
+constexpr uint8_t CAN_TX_QUEUE_SIZE = 4; /**< Frames held per bus, on top of the 3 TX buffers of the MCP2515 */
+static_assert(CAN_TX_QUEUE_SIZE > 0 && CAN_TX_QUEUE_SIZE <= 8, "CAN_TX_QUEUE_SIZE must fit the 8-bit slot mask");
+constexpr uint8_t CAN_TX_MAX_BUSES = 3;  /**< MCP2515 the engine can serve */
+
+/**
+ * @brief Transmit queue for one MCP2515, sent from the SPI transfer complete interrupt.
+ * @details send() packs the frame into the TX buffer register layout, queues it and returns. One engine shared by
+ * all CanTx (there is one SPI) then, per frame: READ STATUS to find a free TX buffer, LOAD TX BUFFER with only the
+ * DLC data bytes, then a WRITE to TXBnCTRL setting TXREQ and the priority from txPriority(), or just the 1-byte RTS
+ * if the buffer already has that priority, one byte per SPI interrupt, going round the buses with queued frames.
+ * A 3-byte torque command is 2 + 9 + 1 = 12 bytes when it keeps its TX buffer. Traffic is counted in SpiStats. If all three TX buffers of a controller are still waiting for the bus, that controller is
+ * skipped until the next send() or service().
+ *
+ * Frames leave the queue in CAN arbitration order (lowest ID first, oldest first for equal IDs), and TXP follows the
+ * ID too, so e.g. the 0x201 torque command is loaded and sent ahead of queued 0x700 telemetry or 0x69x debug frames.
+ * A frame is only lost when the queue is full, counted in getDropped(); getHighWater() shows how close that came.
+ * While the controller is offline (setOnline(), from CanHealth) send() refuses frames at once, counted in getRefused().
+ * A frame sent with stamp set has the micros() its TXREQ was set at kept for takeStamp(), e.g. for LatencyProbe;
+ * only the newest stamped frame is tracked.
+ *
+ * While the engine runs it holds an SPI transaction, so SPI.usingInterrupt() keeps CanRx INT handlers out of it.
+ * Anything else using the SPI bus from the main loop (the autowp calls) must call waitIdle() first.
+ */
+class CanTx
+{
+public:
+    CanTx(MCP2515 &mcp_, const uint8_t cs_pin_);
+    MCP2515::ERROR send(const can_frame *frame, const bool stamp = false);
+    bool takeStamp(uint32_t &sent_us);
+
+    /**
+     * @brief Returns whether frames of this bus are still queued.
+     * @return true if the queue isn't empty.
+     */
+    bool pending() const { return used != 0; }
+
+    /**
+     * @brief Returns how many frames were refused because the queue was full.
+     * @return Dropped frames, saturating.
+     */
+    uint16_t getDropped() const { return dropped; }
+
+    /**
+     * @brief Returns the most frames the queue has held at once.
+     * @return High-water mark, CAN_TX_QUEUE_SIZE means it was full at some point.
+     */
+    uint8_t getHighWater() const { return high_water; }
+
+    /**
+     * @brief Returns how many frames were refused because the controller was offline.
+     * @return Refused frames, saturating.
+     */
+    uint16_t getRefused() const { return refused; }
+
+    /**
+     * @brief Clears the drop and refuse counters and the high-water mark.
+     */
+    void resetStats()
+    {
+        dropped = 0;
+        refused = 0;
+        high_water = 0;
+    }
+
+    /**
+     * @brief Returns whether send() accepts frames.
+     * @return false while the controller is bus-off or can't get a frame acknowledged.
+     */
+    bool isOnline() const { return online; }
+
+    void setOnline(const bool online_);
+    uint32_t getWireBits() const;
+
+    /**
+     * @brief Bits a frame takes on the bus, without bit stuffing: SOF to the end of interframe space.
+     * @param id CAN ID, with CAN_EFF_FLAG for extended frames.
+     * @param dlc Data length, 0 for remote frames.
+     * @return 47 for a standard frame, 67 for an extended one, plus 8 per data byte.
+     */
+    static constexpr uint16_t wireBits(const canid_t id, const uint8_t dlc)
+    {
+        return ((id & CAN_EFF_FLAG) ? 67 : 47) + ((id & CAN_RTR_FLAG) ? 0 : 8 * dlc);
+    }
+
+    /**
+     * @brief TXBnCTRL.TXP of a frame, from the top 2 bits of its 11-bit base ID, so it follows CAN arbitration.
+     * @param id CAN ID, with CAN_EFF_FLAG for extended frames.
+     * @return 3 (highest) for base IDs 0x000-0x1FF, down to 0 for 0x600-0x7FF.
+     */
+    static constexpr uint8_t txPriority(const canid_t id)
+    {
+        return 3 - (((id & CAN_EFF_FLAG) ? (id & CAN_EFF_MASK) >> 18 : id & CAN_SFF_MASK) >> 9);
+    }
+
+    static void service();
+    static void waitIdle();
+    static bool busy();
+    static void spiIsr();
+
+private:
+    static constexpr uint8_t REGS_MAX = 5 + CAN_MAX_DLEN; /**< SIDH, SIDL, EID8, EID0, DLC, data */
+
+    /**
+     * @brief A queued frame as the LOAD TX BUFFER instruction sends it.
+     */
+    struct TxJob
+    {
+        uint8_t bytes[1 + REGS_MAX]; /**< Instruction (filled in once the buffer is known), then the registers from TXBnSIDH */
+        uint8_t len;                 /**< Bytes to send, 6 + data length */
+        uint8_t seq;                 /**< Queue order, breaks ties between equal IDs */
+        uint32_t key;                /**< Arbitration order, lower is sent first: base ID, IDE, extended ID */
+        uint16_t bits;               /**< Bus bits of the frame, see wireBits() */
+    };
+
+    /**
+     * @brief Engine state, the instruction being shifted out.
+     */
+    enum class Step : uint8_t
+    {
+        Status, /**< READ STATUS, to find a free TX buffer */
+        Load,   /**< LOAD TX BUFFER */
+        Request /**< WRITE TXBnCTRL, TXP and TXREQ, or RTS if TXP is unchanged */
+    };
+
+    MCP2515 &mcp;                     /**< Controller, used directly if CAN_TX_ASYNC is 0 */
+    TxJob queue[CAN_TX_QUEUE_SIZE];   /**< Queued frames, in no particular order, see used */
+    volatile uint8_t used;            /**< Bit n set while queue[n] holds a frame, set by send(), cleared by the engine */
+    uint8_t sending;                  /**< Slot the engine is sending, only valid while this bus is active */
+    uint8_t next_seq;                 /**< seq of the next queued frame */
+    volatile bool stalled;            /**< All TX buffers were busy, skip until the next send() or service() */
+    volatile uint16_t dropped;        /**< Frames refused because the queue was full */
+    uint16_t refused;                 /**< Frames refused because the controller was offline */
+    volatile bool online;             /**< send() accepts frames, see setOnline() */
+    volatile uint32_t wire_bits;      /**< Bus bits of the frames handed to the controller, see wireBits() */
+    uint8_t high_water;               /**< Most frames queued at once */
+    uint8_t stamp_slot;               /**< Slot of the stamped frame still queued, CAN_TX_QUEUE_SIZE if none */
+    volatile bool stamped;            /**< stamp_us holds a stamp takeStamp() hasn't taken */
+    volatile uint32_t stamp_us;       /**< micros() the stamped frame was requested at */
+    uint8_t txp[3];                   /**< TXP last written to each TX buffer, 0xFF if unknown */
+    uint8_t index;                    /**< Position in buses */
+    uint8_t cs_pin;                   /**< Chip select pin of the controller */
+    volatile uint8_t *cs_port;        /**< Output register of cs_pin, for toggling it in the interrupt */
+    uint8_t cs_mask;                  /**< Bit of cs_pin in cs_port */
+
+    static CanTx *buses[CAN_TX_MAX_BUSES]; /**< Registered queues, in construction order */
+    static uint8_t bus_count;              /**< Number of registered queues */
+    static uint8_t next_bus;               /**< Bus to look at first when the engine picks the next frame */
+    static CanTx *volatile active;         /**< Bus the engine is sending for, nullptr if idle */
+    static Step step;                      /**< Instruction being shifted out */
+    static uint8_t txb;                    /**< TX buffer picked from READ STATUS */
+    static uint8_t cmd[3];                 /**< Bytes of the READ STATUS, WRITE TXBnCTRL and RTS instructions */
+    static const uint8_t *job_bytes;       /**< Bytes of the current instruction */
+    static uint8_t job_len;                /**< Length of the current instruction */
+    static uint8_t job_pos;                /**< Byte being shifted out */
+    static bool in_transaction;            /**< SPI transaction held by the engine */
+
+    static void pack(TxJob &job, const can_frame &frame);
+    uint8_t firstSlot() const;
+    static void kick();
+    static void start();
+    static void next();
+    static void transfer(const uint8_t *bytes, const uint8_t len);
+    static uint8_t request(CanTx &bus);
+};
+
+#endif // CAN_TX_HPP
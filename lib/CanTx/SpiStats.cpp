@@ -0,0 +1,107 @@
+/**
+ * @file SpiStats.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the SpiStats namespace
+ * @version 1.0
+ * @date 2026-10-16
+ * @see SpiStats.hpp
+ */
+
+#include "SpiStats.hpp"
+
+#ifdef __AVR__
+#include <util/atomic.h>
+#define SPI_STATS_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+// native: no interrupts preempt the main loop
+#define SPI_STATS_ATOMIC
+#endif
+
+namespace
+{
+    SpiCount count = {0, 0};  /**< Totals since reset() */
+    uint32_t tick_start = 0;  /**< count.bytes at the last tick() */
+    uint16_t last_tick = 0;   /**< Bytes in the last closed tick */
+    uint16_t peak_tick = 0;   /**< Most bytes in one tick */
+} // namespace
+
+namespace SpiStats
+{
+    /**
+     * @brief Counts one or more SPI instructions.
+     * @param bytes Bytes clocked.
+     * @param selects Instructions, i.e. CS cycles.
+     */
+    void add(const uint8_t bytes, const uint8_t selects)
+    {
+        SPI_STATS_ATOMIC
+        {
+            count.bytes += bytes;
+            count.selects += selects;
+        }
+    }
+
+    /**
+     * @brief Returns the totals since reset().
+     * @return Bytes and selects.
+     */
+    SpiCount total()
+    {
+        SpiCount copy;
+        SPI_STATS_ATOMIC
+        {
+            copy = count;
+        }
+        return copy;
+    }
+
+    /**
+     * @brief Closes the current tick, call once per Scheduler tick.
+     */
+    void tick()
+    {
+        uint32_t bytes;
+        SPI_STATS_ATOMIC
+        {
+            bytes = count.bytes;
+        }
+        const uint32_t in_tick = bytes - tick_start;
+        tick_start = bytes;
+        last_tick = in_tick > 0xFFFF ? 0xFFFF : in_tick;
+        if (last_tick > peak_tick)
+            peak_tick = last_tick;
+    }
+
+    /**
+     * @brief Returns the bytes of the last closed tick.
+     * @return Bytes, saturating.
+     */
+    uint16_t lastTick()
+    {
+        return last_tick;
+    }
+
+    /**
+     * @brief Returns the most bytes seen in one tick since reset().
+     * @return Bytes, saturating.
+     */
+    uint16_t peakTick()
+    {
+        return peak_tick;
+    }
+
+    /**
+     * @brief Clears all counters.
+     */
+    void reset()
+    {
+        SPI_STATS_ATOMIC
+        {
+            count.bytes = 0;
+            count.selects = 0;
+        }
+        tick_start = 0;
+        last_tick = 0;
+        peak_tick = 0;
+    }
+} // namespace SpiStats
@@ -0,0 +1,42 @@
+/**
+ * @file SpiStats.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the SpiStats namespace, SPI traffic counters of the CAN drivers
+ * @version 1.0
+ * @date 2026-10-16
+ * @see SpiStats.cpp, CanTx.hpp, CanRx.hpp
+ */
+
+#ifndef SPI_STATS_HPP
+#define SPI_STATS_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief SPI bytes and chip selects, see SpiStats.
+ */
+struct SpiCount
+{
+    uint32_t bytes;   /**< Bytes clocked, instruction and address bytes included */
+    uint32_t selects; /**< CS low-high cycles, one per instruction */
+};
+
+/**
+ * @brief SPI traffic of the per-frame CAN paths, CanTx and CanRx, to compare the fast SPI instructions with the autowp calls.
+ * @details Counts what CanTx and CanRx clock themselves, and for the autowp calls they still make, the bytes autowp 1.3
+ * clocks for them (e.g. readMessage(RXBn) is 16 + DLC bytes in 4 selects). Setup and mode changes aren't counted.
+ * tick() closes one Scheduler tick, call it from a task that runs every tick, then lastTick() and peakTick() are bytes
+ * per tick (10ms with the periods in main.cpp).
+ * add() may be called from interrupts and the main loop.
+ */
+namespace SpiStats
+{
+    void add(const uint8_t bytes, const uint8_t selects = 1);
+    SpiCount total();
+    void tick();
+    uint16_t lastTick();
+    uint16_t peakTick();
+    void reset();
+} // namespace SpiStats
+
+#endif // SPI_STATS_HPP
@@ -2,8 +2,8 @@
  * @file Debug_can.cpp
  * @author Planeson, Red Bird Racing
  * @brief Implementation of the Debug_CAN namespace for CAN debugging functions
- * @version 1.1
- * @date 2026-01-14
+ * @version 1.3
+ * @date 2026-10-16
  * @see Debug_can.h
  */
 
@@ -15,15 +15,15 @@
 #include <mcp2515.h>
 #pragma GCC diagnostic pop
 
-MCP2515 *Debug_CAN::can_interface = nullptr;
+CanPort *Debug_CAN::can_interface = nullptr;
 
 /**
  * @brief Initializes the Debug_CAN interface.
  * It should be called before using any other Debug_CAN functions.
  * 
- * @param can Pointer to the MCP2515 CAN controller instance.
+ * @param can Pointer to the port of the debug CAN bus.
  */
-void Debug_CAN::initialize(MCP2515 *can)
+void Debug_CAN::initialize(CanPort *can)
 {
     if (can == nullptr)
         return;
@@ -57,7 +57,7 @@ void Debug_CAN::throttle_in(uint16_t pedal_filtered_1, uint16_t pedal_filtered_2
     tx_msg.data[6] = brake & 0xFF;
     tx_msg.data[7] = (brake >> 8) & 0xFF; // Upper byte
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -81,7 +81,7 @@ void Debug_CAN::throttle_out(uint16_t throttle_final, int16_t throttle_torque_va
     tx_msg.data[2] = throttle_torque_val & 0xFF;
     tx_msg.data[3] = (throttle_torque_val >> 8) & 0xFF; // Upper byte
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -104,7 +104,7 @@ void Debug_CAN::throttle_fault(PedalFault fault_status, uint16_t value)
     tx_msg.data[1] = value & 0xFF;
     tx_msg.data[2] = (value >> 8) & 0xFF; // Upper byte
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -123,7 +123,7 @@ void Debug_CAN::throttle_fault(PedalFault fault_status)
 
     tx_msg.data[0] = static_cast<uint8_t>(fault_status); // Convert enum to uint8_t
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -146,7 +146,7 @@ void Debug_CAN::brake_fault(PedalFault fault_status, uint16_t value)
     tx_msg.data[1] = value & 0xFF;
     tx_msg.data[2] = (value >> 8) & 0xFF; // Upper byte
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -165,7 +165,7 @@ void Debug_CAN::status_car(CarStatus car_status)
 
     tx_msg.data[0] = static_cast<uint8_t>(car_status); // Convert enum to uint8_t
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -184,7 +184,7 @@ void Debug_CAN::status_bms(BmsStatus BMS_status)
 
     tx_msg.data[0] = static_cast<uint8_t>(BMS_status); // Convert enum to uint8_t
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
 
 /**
@@ -204,5 +204,5 @@ void Debug_CAN::hall_sensor(uint16_t hall_sensor_value)
     tx_msg.data[0] = hall_sensor_value & 0xFF;
     tx_msg.data[1] = (hall_sensor_value >> 8) & 0xFF; // Upper byte
 
-    can_interface->sendMessage(&tx_msg);
+    can_interface->send(&tx_msg);
 }
\ No newline at end of file
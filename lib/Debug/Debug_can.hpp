@@ -2,8 +2,8 @@
  * @file Debug_can.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of the Debug_CAN namespace for CAN debugging functions
- * @version 1.1
- * @date 2026-01-14
+ * @version 1.3
+ * @date 2026-10-16
  * @see Debug_can.cpp
  */
 
@@ -17,15 +17,16 @@
 #pragma GCC diagnostic pop
 
 #include "Enums.hpp"
+#include "CanPort.hpp"
 
 /**
  * @brief Namespace for CAN debugging functions
  */
 namespace Debug_CAN
 {
-    extern MCP2515 *can_interface; /**< Pointer to the MCP2515 CAN controller instance. */
+    extern CanPort *can_interface; /**< Pointer to the port of the debug CAN bus. */
 
-    void initialize(MCP2515 *can_interface);
+    void initialize(CanPort *can_interface);
 
     void throttle_in(uint16_t pedal_filtered_1, uint16_t pedal_filtered_2, uint16_t pedal_2_scaled, uint16_t brake);
     void throttle_out(uint16_t throttle_final, int16_t throttle_torque_val);
@@ -0,0 +1,122 @@
+/**
+ * @file LatencyProbe.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the LatencyProbe class
+ * @version 1.1
+ * @date 2026-10-17
+ * @see LatencyProbe.hpp
+ */
+
+#include "LatencyProbe.hpp"
+#include <Arduino.h> // micros()
+
+namespace
+{
+    constexpr uint16_t STATS_MAX = 0xFFFF; /**< Saturation value of the 16-bit stats */
+} // namespace
+
+/**
+ * @brief Construct a new LatencyProbe with empty stats.
+ * @param signal_delay_us_ Group delay of the filters at DC in us, e.g. Pedal::FILTER_DELAY_US, 0 for the CPU time only.
+ */
+LatencyProbe::LatencyProbe(const uint16_t signal_delay_us_)
+    : signal_delay_us(signal_delay_us_),
+      sample_us(0),
+      filtered{0, 0},
+      pending{0, 0, 0},
+      sampled(false),
+      waiting(false)
+{
+    reset();
+}
+
+/**
+ * @brief Stamps a stage of the current sample with micros().
+ * @param stage Sample when the ADC is read, Filter once it is in the filters, Map once the frame is queued.
+ * Sent is taken from CanTx, see complete().
+ */
+void LatencyProbe::mark(const LatencyStage stage)
+{
+    const uint32_t now_us = micros();
+    switch (stage)
+    {
+    case LatencyStage::Sample:
+        sample_us = now_us;
+        return;
+    case LatencyStage::Filter:
+        filtered[0] = sample_us;
+        filtered[1] = now_us;
+        sampled = true;
+        return;
+    case LatencyStage::Map:
+        if (!sampled)
+            return; // no sample yet, nothing to measure
+        pending[0] = filtered[0];
+        pending[1] = filtered[1];
+        pending[2] = now_us;
+        waiting = true;
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * @brief Records the latencies of the frame of the last mark(Map).
+ * @param sent_us micros() the frame was requested in the MCP2515, from CanTx::takeStamp().
+ */
+void LatencyProbe::complete(const uint32_t sent_us)
+{
+    if (!waiting)
+        return;
+    waiting = false;
+    record(stats[static_cast<uint8_t>(LatencyStage::Filter)], pending[1] - pending[0] + signal_delay_us);
+    record(stats[static_cast<uint8_t>(LatencyStage::Map)], pending[2] - pending[1]);
+    record(stats[static_cast<uint8_t>(LatencyStage::Sent)], sent_us - pending[2]);
+    record(stats[static_cast<uint8_t>(LatencyStage::Sample)], sent_us - pending[0] + signal_delay_us);
+}
+
+/**
+ * @brief Clears the stats, a frame waiting for complete() is still recorded.
+ */
+void LatencyProbe::reset()
+{
+    for (uint8_t i = 0; i < LATENCY_STAGES; ++i)
+        stats[i] = Stats{STATS_MAX, 0, 0, 0};
+}
+
+/**
+ * @brief Fills a telemetry frame with the stats of one stage.
+ * @param stage Stage, Sample for the whole latency.
+ * @param[out] frame Frame to fill, all zero if nothing was recorded yet.
+ */
+void LatencyProbe::report(const LatencyStage stage, TelemetryFrameLatency &frame) const
+{
+    const Stats &entry = getStats(stage);
+    frame.stage = stage;
+    frame.min_us = entry.count ? entry.min_us : 0;
+    frame.avg_us = entry.avgUs();
+    frame.max_us = entry.max_us;
+}
+
+/**
+ * @brief Adds one latency to the stats of a stage.
+ * @param entry Stats of the stage.
+ * @param latency_us Latency in microseconds, saturated to 16 bits.
+ */
+void LatencyProbe::record(Stats &entry, const uint32_t latency_us)
+{
+    const uint16_t latency = latency_us > STATS_MAX ? STATS_MAX : latency_us;
+    if (latency < entry.min_us)
+        entry.min_us = latency;
+    if (latency > entry.max_us)
+        entry.max_us = latency;
+    if (entry.count == STATS_MAX)
+    {
+        // keep the average, drop half the history
+        entry.count /= 2;
+        entry.total_us /= 2;
+    }
+    ++entry.count;
+    entry.total_us += latency;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file LatencyProbe.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the LatencyProbe class, timestamps of one sample on its way to a CAN frame
+ * @version 1.1
+ * @date 2026-10-17
+ * @see LatencyProbe.cpp
+ * @dir Latency @brief The Latency library contains the LatencyProbe class, which timestamps an ADC sample at each LatencyStage up to its CAN frame being requested in the MCP2515 and keeps min/avg/max per stage.
+ */
+
+#ifndef LATENCY_PROBE_HPP
+#define LATENCY_PROBE_HPP
+
+#include <stdint.h>
+#include "CarState.hpp"
+#include "Enums.hpp"
+
+constexpr uint8_t LATENCY_STAGES = 4; /**< Values of LatencyStage */
+
+/**
+ * @brief Latency from an APPS sample to its torque command leaving the VCU, split by LatencyStage.
+ * @details mark(Sample) and mark(Filter) stamp each sample, mark(Map) takes the newest filtered sample as the one the
+ * frame is computed from and holds the stamps until complete() gets the time the frame was requested (CanTx::takeStamp()).
+ * A new mark(Map) before complete() replaces the held stamps, like CanTx only tracks the newest stamped frame.
+ * Stats of Filter, Map and Sent are the time from the stage before, stats of Sample the whole latency.
+ * The filters delay the pedal signal itself, by more than the CPU time taken to run them (the oversampling window,
+ * median and low-pass group delay, ~20ms against a few 100us). That delay, given to the constructor, is added to the
+ * Filter stage and so to the whole latency, making it the lag of the torque command behind the pedal.
+ * Times are micros(), so on the AVR they have its 4us resolution.
+ */
+class LatencyProbe
+{
+public:
+    /**
+     * @brief Latency statistics of one stage.
+     */
+    struct Stats
+    {
+        uint16_t min_us;   /**< Shortest, in microseconds, 0xFFFF before the first */
+        uint16_t max_us;   /**< Longest, in microseconds */
+        uint16_t count;    /**< Number of latencies summed in total_us, halved together with total_us before overflowing */
+        uint32_t total_us; /**< Sum of latencies, in microseconds */
+
+        /**
+         * @brief Returns the average latency.
+         * @return Average in microseconds, 0 if none recorded.
+         */
+        uint16_t avgUs() const { return count ? total_us / count : 0; }
+    };
+
+    explicit LatencyProbe(const uint16_t signal_delay_us_ = 0);
+    void mark(const LatencyStage stage);
+    void complete(const uint32_t sent_us);
+    void reset();
+    void report(const LatencyStage stage, TelemetryFrameLatency &frame) const;
+
+    /**
+     * @brief Returns the statistics of one stage.
+     * @param stage Stage, Sample for the whole latency.
+     * @return Statistics since construction or reset().
+     */
+    const Stats &getStats(const LatencyStage stage) const { return stats[static_cast<uint8_t>(stage)]; }
+
+private:
+    static constexpr uint8_t HELD = static_cast<uint8_t>(LatencyStage::Sent); /**< Stamps held per sample, Sample to Map */
+
+    const uint16_t signal_delay_us; /**< Group delay of the filters, added to the Filter stage */
+    uint32_t sample_us;             /**< Sample stamp of the sample not filtered yet */
+    uint32_t filtered[2];           /**< Sample and Filter stamps of the newest filtered sample */
+    uint32_t pending[HELD];         /**< Sample, Filter and Map stamps of the frame waiting for complete() */
+    bool sampled;                   /**< filtered holds a sample */
+    bool waiting;                   /**< pending waits for complete() */
+    Stats stats[LATENCY_STAGES];    /**< Indexed by LatencyStage */
+
+    static void record(Stats &entry, const uint32_t latency_us);
+};
+
+#endif // LATENCY_PROBE_HPP
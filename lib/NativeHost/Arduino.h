@@ -0,0 +1,122 @@
+/**
+ * @file Arduino.h
+ * @author Planeson, Red Bird Racing
+ * @brief Native stand-in for the parts of the Arduino core used by the VCU
+ * @version 1.1
+ * @date 2026-10-16
+ * @see NativeHost.hpp, NativeHost.cpp
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <iostream>
+#include "NativeHost.hpp"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT)) /**< INT0 on PD2, INT1 on PD3 */
+
+// === ATmega328P pin names, numbering follows MiniCore, A6/A7 are analog only ===
+#define PIN_PD0 0
+#define PIN_PD1 1
+#define PIN_PD2 2
+#define PIN_PD3 3
+#define PIN_PD4 4
+#define PIN_PD5 5
+#define PIN_PD6 6
+#define PIN_PD7 7
+#define PIN_PB0 8
+#define PIN_PB1 9
+#define PIN_PB2 10
+#define PIN_PB3 11
+#define PIN_PB4 12
+#define PIN_PB5 13
+#define PIN_PC0 14
+#define PIN_PC1 15
+#define PIN_PC2 16
+#define PIN_PC3 17
+#define PIN_PC4 18
+#define PIN_PC5 19
+#define PIN_PB6 20
+#define PIN_PB7 21
+#define PIN_PC6 22
+#define PIN_A0 PIN_PC0
+#define PIN_A1 PIN_PC1
+#define PIN_A2 PIN_PC2
+#define PIN_A3 PIN_PC3
+#define PIN_A4 PIN_PC4
+#define PIN_A5 PIN_PC5
+#define PIN_A6 23
+#define PIN_A7 24
+#define A0 PIN_A0
+#define A1 PIN_A1
+#define A2 PIN_A2
+#define A3 PIN_A3
+#define A4 PIN_A4
+#define A5 PIN_A5
+#define A6 PIN_A6
+#define A7 PIN_A7
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void attachInterrupt(uint8_t num, void (*isr)(), int mode);
+void detachInterrupt(uint8_t num);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+/**
+ * @brief Serial stand-in, prints to stdout only when NativeHost::serial_echo is set.
+ */
+class HardwareSerial
+{
+public:
+    void begin(unsigned long) {}
+
+    template <typename T>
+    size_t print(const T &val)
+    {
+        if (NativeHost::serial_echo)
+            std::cout << val;
+        return 0;
+    }
+
+    template <typename T>
+    size_t println(const T &val)
+    {
+        if (NativeHost::serial_echo)
+            std::cout << val << '\n';
+        return 0;
+    }
+
+    size_t println()
+    {
+        if (NativeHost::serial_echo)
+            std::cout << '\n';
+        return 0;
+    }
+};
+
+extern HardwareSerial Serial;
+
+void setup();
+void loop();
+
+#endif // Arduino_h
@@ -0,0 +1,177 @@
+/**
+ * @file NativeHost.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the virtual clock, simulated pins and Arduino core stand-ins
+ * @version 1.2
+ * @date 2026-10-16
+ * @see NativeHost.hpp, Arduino.h
+ */
+
+#include "NativeHost.hpp"
+#include "Arduino.h"
+#include "SPI.h"
+
+NativeHost::CostModel NativeHost::costs;
+bool NativeHost::serial_echo = false;
+HardwareSerial Serial;
+SPIClass SPI;
+
+namespace
+{
+    uint64_t now_us = 0;                                /**< Virtual time since reset, never wraps */
+    uint16_t analog_values[NativeHost::NUM_PINS] = {0}; /**< Value returned by analogRead() per pin */
+    bool digital_levels[NativeHost::NUM_PINS] = {0};    /**< Level of each pin, written by firmware or host */
+    constexpr uint8_t NUM_EXT_INTERRUPTS = 2;           /**< INT0, INT1 on the ATmega328P */
+    void (*isrs[NUM_EXT_INTERRUPTS])() = {nullptr};     /**< Handlers set by attachInterrupt() */
+} // namespace
+
+/**
+ * @brief Resets virtual time to 0 and all pins to 0/LOW.
+ */
+void NativeHost::reset()
+{
+    now_us = 0;
+    for (uint8_t i = 0; i < NUM_PINS; ++i)
+    {
+        analog_values[i] = 0;
+        digital_levels[i] = false;
+    }
+}
+
+/**
+ * @brief Returns the virtual time without charging any cost.
+ * @return Microseconds since reset, 64 bit so it never wraps during a run.
+ */
+uint64_t NativeHost::now()
+{
+    return now_us;
+}
+
+/**
+ * @brief Moves the virtual clock forward, e.g. to model an interrupt or idle time.
+ * @param us Microseconds to advance.
+ */
+void NativeHost::advanceMicros(uint32_t us)
+{
+    now_us += us;
+}
+
+/**
+ * @brief Sets the value the next analogRead() of a pin returns.
+ * @param pin Pin number, see Arduino.h.
+ * @param value 10 bit ADC value.
+ */
+void NativeHost::setAnalog(uint8_t pin, uint16_t value)
+{
+    if (pin < NUM_PINS)
+        analog_values[pin] = value & 0x3FF;
+}
+
+/**
+ * @brief Returns the value on an analog pin without charging a conversion, for the emulated ADC of AdcSampler.
+ * @param pin Pin number, see Arduino.h.
+ * @return 10 bit ADC value, 0 for unknown pins.
+ */
+uint16_t NativeHost::getAnalog(uint8_t pin)
+{
+    return pin < NUM_PINS ? analog_values[pin] : 0;
+}
+
+/**
+ * @brief Drives a pin from outside, e.g. a button.
+ * @param pin Pin number, see Arduino.h.
+ * @param level true for HIGH.
+ */
+void NativeHost::setDigital(uint8_t pin, bool level)
+{
+    if (pin < NUM_PINS)
+        digital_levels[pin] = level;
+}
+
+/**
+ * @brief Reads a pin level without charging any cost, e.g. to check the buzzer.
+ * @param pin Pin number, see Arduino.h.
+ * @return true if HIGH.
+ */
+bool NativeHost::getDigital(uint8_t pin)
+{
+    return pin < NUM_PINS && digital_levels[pin];
+}
+
+/**
+ * @brief Runs the handler attached to an external interrupt, as the AVR would on its edge.
+ * Costs no virtual time, the handler charges for what it does.
+ * @param num Interrupt number, see digitalPinToInterrupt(), NOT_AN_INTERRUPT is ignored.
+ */
+void NativeHost::raiseInterrupt(int8_t num)
+{
+    if (num >= 0 && num < NUM_EXT_INTERRUPTS && isrs[num] != nullptr)
+        isrs[num]();
+}
+
+// === Arduino core stand-ins ===
+
+void attachInterrupt(uint8_t num, void (*isr)(), int)
+{
+    if (num < NUM_EXT_INTERRUPTS)
+        isrs[num] = isr;
+}
+
+void detachInterrupt(uint8_t num)
+{
+    if (num < NUM_EXT_INTERRUPTS)
+        isrs[num] = nullptr;
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+    NativeHost::advanceMicros(NativeHost::costs.digital_io);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    NativeHost::advanceMicros(NativeHost::costs.digital_io);
+    NativeHost::setDigital(pin, val != LOW);
+}
+
+int digitalRead(uint8_t pin)
+{
+    NativeHost::advanceMicros(NativeHost::costs.digital_io);
+    return NativeHost::getDigital(pin) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    NativeHost::advanceMicros(NativeHost::costs.analog_read);
+    return pin < NativeHost::NUM_PINS ? analog_values[pin] : 0;
+}
+
+/**
+ * @brief Virtual micros(), wraps at 32 bits like on AVR.
+ * @return Microseconds since reset.
+ */
+unsigned long micros()
+{
+    NativeHost::advanceMicros(NativeHost::costs.micros_call);
+    return static_cast<uint32_t>(now_us);
+}
+
+/**
+ * @brief Virtual millis(), wraps at 32 bits like on AVR.
+ * @return Milliseconds since reset.
+ */
+unsigned long millis()
+{
+    NativeHost::advanceMicros(NativeHost::costs.micros_call);
+    return static_cast<uint32_t>(now_us / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    NativeHost::advanceMicros(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    NativeHost::advanceMicros(us);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file NativeHost.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Host-side controls of the native build: virtual clock, pin states and the cost model
+ * @version 1.4
+ * @date 2026-10-16
+ * @see Arduino.h, mcp2515.h, NativeMain.cpp
+ */
+
+#ifndef NATIVE_HOST_HPP
+#define NATIVE_HOST_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Namespace for controlling the simulated board in the native build.
+ * @details Time only moves when the firmware does something that takes time on the AVR,
+ * or when the host calls advanceMicros(). Every stand-in call that would cost time on the
+ * ATmega328P @ 16MHz charges its cost from NativeHost::costs, so spin-waits terminate and
+ * the Scheduler sees realistic loop timings while running much faster than real time.
+ */
+namespace NativeHost
+{
+    constexpr uint8_t NUM_PINS = 32; /**< Size of the simulated pin tables */
+
+    /**
+     * @brief Virtual time charged per stand-in call, in microseconds.
+     * Defaults are rough figures for an ATmega328P @ 16MHz with the MCP2515 on 8MHz SPI.
+     */
+    struct CostModel
+    {
+        uint32_t micros_call = 4;   /**< micros()/millis(), also the resolution of micros() on AVR */
+        uint32_t analog_read = 112; /**< One blocking conversion, 13 ADC clocks @ 125kHz plus overhead */
+        uint32_t digital_io = 4;    /**< digitalRead()/digitalWrite() */
+        uint32_t mcp_send = 60;     /**< MCP2515::sendMessage(), status read + load TX buffer + RTS */
+        uint32_t mcp_read = 40;     /**< MCP2515::readMessage(), status read + read RX buffer */
+        uint32_t mcp_poll = 12;     /**< MCP2515::readMessage() with nothing to read, status read only */
+        uint32_t mcp_config = 100;  /**< reset, mode, bitrate and filter changes */
+        uint32_t tx_enqueue = 8;    /**< CanTx::send(), packing the frame into TX buffer layout and starting the SPI engine */
+        uint32_t spi_isr_byte = 2;  /**< CPU time of one SPI transfer complete interrupt of the CanTx engine, ~30 cycles */
+        uint32_t spi_byte = 2;      /**< One byte of a blocking SPI.transfer() at 8MHz, the CanRx fast path, loop overhead included */
+        uint32_t adc_isr = 3;       /**< CPU time of one ADC conversion complete interrupt of AdcSampler, ~45 cycles */
+    };
+
+    extern CostModel costs;    /**< Cost model used by all stand-ins, may be changed at any time */
+    extern bool serial_echo;   /**< Forward Serial output to stdout, off by default to keep runs fast */
+
+    void reset();
+    uint64_t now();
+    void advanceMicros(uint32_t us);
+    void setAnalog(uint8_t pin, uint16_t value);
+    uint16_t getAnalog(uint8_t pin);
+    void setDigital(uint8_t pin, bool level);
+    bool getDigital(uint8_t pin);
+    void raiseInterrupt(int8_t num);
+} // namespace NativeHost
+
+#endif // NATIVE_HOST_HPP
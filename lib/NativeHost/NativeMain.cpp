@@ -0,0 +1,252 @@
+/**
+ * @file NativeMain.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Host entry point, runs setup()/loop() against simulated pedals, Bamocar and BMS on the virtual clock
+ * @version 1.9
+ * @date 2026-10-17
+ * @see NativeHost.hpp, main.cpp
+ */
+
+// unit tests bring their own main()
+#ifndef PIO_UNIT_TESTING
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include "Arduino.h"
+#include "BoardConf.h"
+#include "NativeHost.hpp"
+#include "SpiStats.hpp"
+#include "SocketCanPort.hpp"
+
+// ignore -Wpedantic warnings for mcp2515.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <mcp2515.h>
+#pragma GCC diagnostic pop
+
+namespace
+{
+    constexpr canid_t MOTOR_READ = 0x181;                         /**< Bamocar register reply */
+    constexpr canid_t BMS_COMMAND_EXT = 0x1801F340 | CAN_EFF_FLAG; /**< VCU -> BMS command */
+    constexpr canid_t BMS_INFO_EXT = 0x186040F3 | CAN_EFF_FLAG;    /**< BMS -> VCU info */
+    constexpr canid_t TELEMETRY_SCHEDULER_MSG = 0x720;             /**< Scheduler stats telemetry */
+    constexpr canid_t TELEMETRY_CAN_MSG = 0x730;                   /**< CAN health telemetry */
+    constexpr canid_t TELEMETRY_LATENCY_MSG = 0x740;               /**< Pedal latency telemetry */
+    constexpr canid_t FOREIGN_MSG = 0x300;                         /**< Traffic of other nodes, nobody on the VCU handles it */
+
+    constexpr uint32_t MOTOR_PERIOD_US = 20000;   /**< Bamocar SPEED_IST and WARN_ERR period each */
+    constexpr uint32_t BMS_PERIOD_US = 50000;     /**< Kclear BMS info period */
+    constexpr uint32_t PRECHARGE_US = 300000;     /**< Time the simulated BMS spends in precharge */
+    constexpr uint32_t BUS_FAULT_US = 2000000;    /**< Length of the bus fault of argv[4] */
+    constexpr uint16_t APPS_5V_IDLE = 320;        /**< Released throttle, just under THROTTLE_TABLE[0] */
+    constexpr uint16_t APPS_5V_FULL = 621;        /**< Full throttle */
+    constexpr uint16_t BRAKE_IDLE = 100;          /**< Released brake */
+    constexpr uint16_t BRAKE_PRESSED = 200;       /**< Pressed brake, above BRAKE_THRESHOLD */
+
+    /**
+     * @brief Simulated Kclear BMS, standby until a start command, then precharge, then run.
+     */
+    struct SimBms
+    {
+        uint8_t state = 0x30;     /**< Upper nibble of data[6]: 3 standby, 4 precharge, 5 run */
+        uint64_t precharge_us = 0; /**< Virtual time precharge started */
+    };
+
+    /**
+     * @brief Sets the pedal and button inputs for the scripted drive.
+     * 0.5-1.7s hold brake + start, then release and wait for DRIVE, from 4s sweep the throttle every 4s.
+     * @param t_us Virtual time.
+     */
+    void driver(uint64_t t_us)
+    {
+        const bool starting = t_us >= 500000 && t_us < 1700000;
+        NativeHost::setDigital(DRIVE_MODE_BTN, starting ? BUTTON_ACTIVE : !BUTTON_ACTIVE);
+        NativeHost::setAnalog(BRAKE_IN, starting ? BRAKE_PRESSED : BRAKE_IDLE);
+
+        uint16_t apps_5v = APPS_5V_IDLE;
+        if (t_us >= 4000000)
+        {
+            const uint32_t phase = (t_us - 4000000) % 4000000;
+            const uint32_t tri = phase < 2000000 ? phase : 4000000 - phase; // 0..2000000..0
+            apps_5v = APPS_5V_IDLE + static_cast<uint16_t>((uint64_t)(APPS_5V_FULL - APPS_5V_IDLE) * tri / 2000000);
+        }
+        NativeHost::setAnalog(APPS_5V, apps_5v);
+        NativeHost::setAnalog(APPS_3V3, static_cast<uint16_t>(220 + (int32_t)(apps_5v - 325) * 190 / 296)); // APPS_3V3_SCALE_TABLE inverted
+        NativeHost::setAnalog(HALL_SENSOR, 512);
+    }
+
+    /**
+     * @brief Delivers a frame to every controller, their filters decide who keeps it.
+     * @param frame Frame on the bus.
+     */
+    void broadcast(const can_frame &frame)
+    {
+        for (uint8_t i = 0; i < MCP2515::instanceCount(); ++i)
+            MCP2515::instance(i)->injectRx(frame);
+    }
+} // namespace
+
+/**
+ * @brief Runs the VCU for a number of virtual seconds and prints a summary.
+ * @param argc Argument count.
+ * @param argv argv[1]: virtual seconds to run (default 60), argv[2]: 1 to echo Serial (default 0),
+ * argv[3]: frames per second of unrelated traffic on the bus (default 0), to see what the acceptance filters save,
+ * argv[4]: second at which the bus breaks for 2s (default never), to see the bus-off recovery,
+ * argv[5]: SocketCAN interface (e.g. vcan0) to mirror the VCU frames to and take frames of other tools from (default none).
+ * @return 0, 1 if the argv[5] interface can't be opened
+ */
+int main(int argc, char **argv)
+{
+    const uint64_t run_us = (argc > 1 ? strtoull(argv[1], nullptr, 10) : 60) * 1000000ULL;
+    NativeHost::serial_echo = argc > 2 && atoi(argv[2]) != 0;
+    const uint32_t foreign_per_s = argc > 3 ? strtoul(argv[3], nullptr, 10) : 0;
+    const uint64_t foreign_period_us = foreign_per_s ? 1000000ULL / foreign_per_s : 0;
+    const uint64_t fault_us = argc > 4 ? strtoull(argv[4], nullptr, 10) * 1000000ULL : UINT64_MAX;
+#if CAN_PORT_SOCKETCAN
+    SocketCanPort bridge; // the frames cross in virtual time, the run isn't paced to the wall clock
+    if (argc > 5 && !bridge.open(argv[5]))
+    {
+        fprintf(stderr, "can't open SocketCAN interface %s\n", argv[5]);
+        return 1;
+    }
+#endif
+
+    std::map<canid_t, uint32_t> tx_counts;
+    std::map<uint8_t, can_frame> scheduler_stats; // latest Scheduler stats frame per mux
+    std::map<uint8_t, can_frame> can_health;      // latest CAN health frame per controller
+    std::map<uint8_t, can_frame> latency;         // latest pedal latency frame per stage
+    bool bus_fault = false;
+    SimBms bms;
+    uint64_t next_motor_us = 0;
+    uint64_t next_bms_us = 0;
+    uint64_t next_foreign_us = 0;
+    uint64_t loops = 0;
+
+    driver(0);
+#ifdef INT_CAN_DL
+    for (uint8_t i = 0; i < MCP2515::instanceCount(); ++i)
+        if (MCP2515::instance(i)->csPin() == CS_CAN_DL)
+            MCP2515::instance(i)->setIntPin(INT_CAN_DL);
+#endif
+    const auto wall_start = std::chrono::steady_clock::now();
+    setup();
+    while (NativeHost::now() < run_us)
+    {
+        const uint64_t t = NativeHost::now();
+        driver(t);
+
+        if (t >= next_motor_us)
+        {
+            const int16_t rpm = NativeHost::getDigital(FRG) ? 1200 : 0;
+            broadcast(can_frame{MOTOR_READ, 4, {0x30, static_cast<__u8>(rpm & 0xFF), static_cast<__u8>((rpm >> 8) & 0xFF), 0x00}});
+            broadcast(can_frame{MOTOR_READ, 5, {0x8F, 0x00, 0x00, 0x00, 0x00}});
+            next_motor_us += MOTOR_PERIOD_US;
+        }
+        if (bms.state == 0x40 && t - bms.precharge_us >= PRECHARGE_US)
+            bms.state = 0x50;
+        if (t >= next_bms_us)
+        {
+            broadcast(can_frame{BMS_INFO_EXT, 8, {0, 0, 0, 0, 0, 0, bms.state, 0}});
+            next_bms_us += BMS_PERIOD_US;
+        }
+
+        const bool fault_now = t >= fault_us && t - fault_us < BUS_FAULT_US;
+        if (fault_now != bus_fault)
+        {
+            bus_fault = fault_now;
+            for (uint8_t i = 0; i < MCP2515::instanceCount(); ++i)
+                MCP2515::instance(i)->setBusFault(bus_fault);
+        }
+
+        while (foreign_period_us != 0 && t >= next_foreign_us)
+        {
+            broadcast(can_frame{FOREIGN_MSG, 8, {0}});
+            next_foreign_us += foreign_period_us;
+        }
+
+#if CAN_PORT_SOCKETCAN
+        can_frame bridged;
+        while (bridge.read(&bridged) == MCP2515::ERROR_OK)
+            broadcast(bridged);
+#endif
+
+        loop();
+        ++loops;
+
+        can_frame frame;
+        for (uint8_t i = 0; i < MCP2515::instanceCount(); ++i)
+        {
+            while (MCP2515::instance(i)->popTx(frame))
+            {
+                ++tx_counts[frame.can_id];
+#if CAN_PORT_SOCKETCAN
+                bridge.send(&frame);
+#endif
+                if (frame.can_id == TELEMETRY_SCHEDULER_MSG)
+                    scheduler_stats[frame.data[0]] = frame;
+                if (frame.can_id == TELEMETRY_CAN_MSG)
+                    can_health[frame.data[0] & 0x0F] = frame;
+                if (frame.can_id == TELEMETRY_LATENCY_MSG)
+                    latency[frame.data[0]] = frame;
+                if (frame.can_id == BMS_COMMAND_EXT && frame.data[0] == 0x01 && bms.state == 0x30)
+                {
+                    bms.state = 0x40;
+                    bms.precharge_us = NativeHost::now();
+                }
+            }
+        }
+    }
+    const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    const double sim_s = NativeHost::now() / 1e6;
+
+    printf("virtual time   %10.3f s\n", sim_s);
+    printf("wall time      %10.3f s (%.0fx real time)\n", wall_s, wall_s > 0 ? sim_s / wall_s : 0.0);
+    printf("loop() passes  %10llu (%.1f us each, virtual)\n", (unsigned long long)loops, loops ? NativeHost::now() / (double)loops : 0.0);
+    printf("FRG (drive)    %10s\n", NativeHost::getDigital(FRG) ? "on" : "off");
+    const SpiCount spi = SpiStats::total();
+    printf("CAN SPI        %10lu bytes in %lu selects, %.0f bytes/tick avg, %u last, %u peak\n", (unsigned long)spi.bytes,
+           (unsigned long)spi.selects, spi.bytes / (sim_s * 100.0), SpiStats::lastTick(), SpiStats::peakTick());
+    printf("frames sent:\n");
+    for (const auto &entry : tx_counts)
+        printf("  0x%08lx %10lu (%.1f /s)\n", (unsigned long)entry.first, (unsigned long)entry.second, entry.second / sim_s);
+    if (!scheduler_stats.empty())
+        printf("scheduler stats (last 0x%03x frames, us):\n", (unsigned)TELEMETRY_SCHEDULER_MSG);
+    for (const auto &entry : scheduler_stats)
+    {
+        const uint8_t *d = entry.second.data;
+        const unsigned v0 = d[1] | (d[2] << 8), v1 = d[3] | (d[4] << 8), v2 = d[5] | (d[6] << 8);
+        if (entry.first == 0xFF)
+            printf("  tick      late worst %5u avg %5u, busy worst %5u\n", v0, v1, v2);
+        else if (entry.first == 0xFE)
+            printf("  tick      overruns %5u skipped sub-ticks %5u, busy avg %5u\n", v0, v1, v2);
+        else if (entry.first == 0xFD)
+            printf("  budget    deferrals %5u budget %5u, worst deferral %u ticks\n", v0, v1, v2);
+        else if (entry.first == 0xFC)
+            printf("  lanes     fast %5.1f %% can %5.1f %%, %u sub-ticks\n", v0 / 10.0, v1 / 10.0, v2);
+        else if (entry.first == 0xFB)
+            printf("  cpu load  avg %5.1f %% worst %5.1f %% last %5.1f %%\n", v0 / 10.0, v1 / 10.0, v2 / 10.0);
+        else if (v2 != 0)
+            printf("  lane %u task %u  worst %5u avg %5u runs %5u\n", entry.first >> 4, entry.first & 0x0F, v0, v1, v2);
+    }
+    static const char *const CAN_STATES[] = {"active", "warning", "passive", "bus-off"};
+    for (const auto &entry : can_health)
+    {
+        const uint8_t *d = entry.second.data;
+        printf("CAN health mcp %u  %s, TEC %u REC %u, load %u %%, bus-off %u, reinit %u, lost %u\n", entry.first,
+               CAN_STATES[(d[0] >> 4) & 0x03], d[1], d[2], d[3], d[4], d[5], d[6] | (d[7] << 8));
+    }
+    static const char *const LATENCY_STAGES[] = {"sample->sent", "sample->filter", "filter->map", "map->sent"};
+    if (!latency.empty())
+        printf("pedal latency (last 0x%03x frames, us):\n", (unsigned)TELEMETRY_LATENCY_MSG);
+    for (const auto &entry : latency)
+    {
+        const uint8_t *d = entry.second.data;
+        printf("  %-15s min %5u avg %5u max %5u\n", entry.first < 4 ? LATENCY_STAGES[entry.first] : "?",
+               d[1] | (d[2] << 8), d[3] | (d[4] << 8), d[5] | (d[6] << 8));
+    }
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
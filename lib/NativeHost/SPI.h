@@ -0,0 +1,28 @@
+/**
+ * @file SPI.h
+ * @author Planeson, Red Bird Racing
+ * @brief Native stand-in for the parts of the Arduino SPI library used outside mcp2515.h
+ * @version 1.0
+ * @date 2026-10-16
+ * @see mcp2515.h
+ */
+
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+#include <stdint.h>
+
+/**
+ * @brief SPI stand-in, the MCP2515 stand-in charges SPI time itself, so there is nothing to do here.
+ */
+class SPIClass
+{
+public:
+    static void begin() {}
+    static void usingInterrupt(uint8_t) {}
+    static void notUsingInterrupt(uint8_t) {}
+};
+
+extern SPIClass SPI;
+
+#endif // _SPI_H_INCLUDED
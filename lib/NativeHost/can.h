@@ -0,0 +1,49 @@
+/**
+ * @file can.h
+ * @author Planeson, Red Bird Racing
+ * @brief Native stand-in for the autowp-mcp2515 can.h, only used by the native (host) build
+ * @version 1.0
+ * @date 2026-10-16
+ * @see mcp2515.h
+ * @dir NativeHost @brief The NativeHost library contains host stand-ins for Arduino.h, can.h and mcp2515.h, plus a virtual clock and a runner, so the VCU can be compiled and run on a Linux machine.
+ */
+
+#ifndef CAN_H_
+#define CAN_H_
+
+#include <stdint.h>
+
+typedef uint8_t __u8;   /**< Same name as the Linux/autowp typedef, fixed width on host */
+typedef uint16_t __u16; /**< Same name as the Linux/autowp typedef, fixed width on host */
+typedef uint32_t __u32; /**< Same name as the Linux/autowp typedef, fixed width on host (AVR unsigned long is 32 bits) */
+
+/* special address description flags for the CAN_ID */
+#define CAN_EFF_FLAG 0x80000000UL /* EFF/SFF is set in the MSB */
+#define CAN_RTR_FLAG 0x40000000UL /* remote transmission request */
+#define CAN_ERR_FLAG 0x20000000UL /* error message frame */
+
+/* valid bits in CAN ID for frame formats */
+#define CAN_SFF_MASK 0x000007FFUL /* standard frame format (SFF) */
+#define CAN_EFF_MASK 0x1FFFFFFFUL /* extended frame format (EFF) */
+#define CAN_ERR_MASK 0x1FFFFFFFUL /* omit EFF, RTR, ERR flags */
+
+typedef __u32 canid_t; /**< CAN ID with the EFF/RTR/ERR flags in the upper bits */
+
+#define CAN_SFF_ID_BITS 11
+#define CAN_EFF_ID_BITS 29
+
+/* CAN payload length and DLC definitions according to ISO 11898-1 */
+#define CAN_MAX_DLC 8
+#define CAN_MAX_DLEN 8
+
+/**
+ * @brief Basic CAN frame structure, layout identical to the autowp one so brace initialisers keep working.
+ */
+struct can_frame
+{
+    canid_t can_id;                                       /**< 32 bit CAN_ID + EFF/RTR/ERR flags */
+    __u8 can_dlc;                                         /**< frame payload length in byte (0 .. CAN_MAX_DLEN) */
+    __u8 data[CAN_MAX_DLEN] __attribute__((aligned(8))); /**< frame payload */
+};
+
+#endif // CAN_H_
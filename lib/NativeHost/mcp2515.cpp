@@ -0,0 +1,595 @@
+/**
+ * @file mcp2515.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the in-memory MCP2515 stand-in
+ * @version 1.6
+ * @date 2026-10-16
+ * @see mcp2515.h
+ */
+
+#include "mcp2515.h"
+#include "Arduino.h"
+#include "NativeHost.hpp"
+
+namespace
+{
+    constexpr uint8_t MAX_INSTANCES = 8;        /**< More controllers than any VCU board has */
+    MCP2515 *instances[MAX_INSTANCES] = {nullptr}; /**< Controllers constructed with a CS pin, in order */
+    uint8_t instance_cnt = 0;                   /**< Number of registered controllers */
+} // namespace
+
+/**
+ * @brief Construct a new MCP2515 stand-in and register it for the host runner.
+ * @param cs_pin_ Chip select pin, only used to identify the controller.
+ * @param spi_clock_ Unused, kept for interface compatibility.
+ * @param spi_ Unused, kept for interface compatibility.
+ */
+MCP2515::MCP2515(const uint8_t cs_pin_, const uint32_t spi_clock_, void *spi_)
+    : cs_pin(cs_pin_),
+      int_pin(NO_PIN),
+      normal_mode(false),
+      masks{0},
+      filters{0},
+      filter_ext{false},
+      rx_buf{},
+      rx_head(0),
+      rx_count(0),
+      eflg(0),
+      tec(0),
+      rec(0),
+      bus_off(false),
+      bus_fault(false),
+      tx_queue{},
+      tx_head(0),
+      tx_count(0),
+      tx_buf{},
+      tx_req(0),
+      tx_prio{0}
+{
+    (void)spi_clock_;
+    (void)spi_;
+    if (instance_cnt < MAX_INSTANCES)
+        instances[instance_cnt++] = this;
+}
+
+/**
+ * @brief Returns the number of controllers constructed so far.
+ * @return Number of registered controllers.
+ */
+uint8_t MCP2515::instanceCount()
+{
+    return instance_cnt;
+}
+
+/**
+ * @brief Returns a registered controller, in construction order.
+ * @param index Index, less than instanceCount().
+ * @return Pointer to the controller, nullptr if out of range.
+ */
+MCP2515 *MCP2515::instance(uint8_t index)
+{
+    return index < instance_cnt ? instances[index] : nullptr;
+}
+
+/**
+ * @brief Resets the controller, clearing buffers, masks and filters, leaving it in config mode.
+ * @return ERROR_OK
+ */
+MCP2515::ERROR MCP2515::reset()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    normal_mode = false;
+    for (uint8_t i = 0; i < 2; ++i)
+        masks[i] = 0;
+    for (uint8_t i = 0; i < 6; ++i)
+    {
+        filters[i] = 0;
+        filter_ext[i] = i == 1; // as autowp reset(): RXF1 extended, the rest standard, so both types pass
+    }
+    rx_head = 0;
+    rx_count = 0;
+    eflg = 0;
+    tec = 0;
+    rec = 0;
+    bus_off = false;
+    tx_head = 0;
+    tx_count = 0;
+    tx_req = 0;
+    for (uint8_t i = 0; i < TX_BUFFERS; ++i)
+        tx_prio[i] = 0;
+    updateInt();
+    return ERROR_OK;
+}
+
+MCP2515::ERROR MCP2515::setConfigMode()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    normal_mode = false;
+    return ERROR_OK;
+}
+
+MCP2515::ERROR MCP2515::setListenOnlyMode()
+{
+    return setConfigMode();
+}
+
+MCP2515::ERROR MCP2515::setSleepMode()
+{
+    return setConfigMode();
+}
+
+MCP2515::ERROR MCP2515::setLoopbackMode()
+{
+    return setConfigMode();
+}
+
+MCP2515::ERROR MCP2515::setNormalMode()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    normal_mode = true;
+    return ERROR_OK;
+}
+
+MCP2515::ERROR MCP2515::setBitrate(const CAN_SPEED can_speed)
+{
+    return setBitrate(can_speed, MCP_16MHZ);
+}
+
+MCP2515::ERROR MCP2515::setBitrate(const CAN_SPEED, const CAN_CLOCK)
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    return ERROR_OK;
+}
+
+/**
+ * @brief Sets an acceptance mask, a set bit means the ID bit must match the filter.
+ * @param num Mask to set.
+ * @param ext true if ul_data is a 29 bit mask.
+ * @param ul_data Mask value, 11 or 29 bits.
+ * @return ERROR_OK
+ */
+MCP2515::ERROR MCP2515::setFilterMask(const MASK num, const bool ext, const uint32_t ul_data)
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    masks[num] = registerLayout(ul_data, ext);
+    return ERROR_OK;
+}
+
+/**
+ * @brief Sets an acceptance filter.
+ * @param num Filter to set.
+ * @param ext true if the filter applies to extended frames only.
+ * @param ul_data Filter value, 11 or 29 bits.
+ * @return ERROR_OK
+ */
+MCP2515::ERROR MCP2515::setFilter(const RXF num, const bool ext, const uint32_t ul_data)
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_config);
+    filters[num] = registerLayout(ul_data, ext);
+    filter_ext[num] = ext;
+    return ERROR_OK;
+}
+
+/**
+ * @brief Sends a frame through a specific TX buffer, all buffers share the TX queue on host.
+ * @param txbn Unused.
+ * @param frame Frame to send.
+ * @return ERROR_OK, ERROR_FAILTX if the DLC is invalid, ERROR_ALLTXBUSY if the TX queue is full or the controller is bus-off.
+ */
+MCP2515::ERROR MCP2515::sendMessage(const TXBn txbn, const struct can_frame *frame)
+{
+    (void)txbn;
+    return sendMessage(frame);
+}
+
+/**
+ * @brief Sends a frame, pushing it to the TX queue for the host to drain.
+ * @param frame Frame to send.
+ * @return ERROR_OK, ERROR_FAILTX if the DLC is invalid, ERROR_ALLTXBUSY if the TX queue is full or the controller is bus-off.
+ */
+MCP2515::ERROR MCP2515::sendMessage(const struct can_frame *frame)
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_send);
+    if (frame == nullptr || frame->can_dlc > CAN_MAX_DLEN)
+        return ERROR_FAILTX;
+    if (bus_fault)
+    {
+        bus_off = true;
+        tec = 255;
+    }
+    if (bus_off || tx_count >= TX_QUEUE_SIZE)
+        return ERROR_ALLTXBUSY;
+
+    tx_queue[(tx_head + tx_count) % TX_QUEUE_SIZE] = *frame;
+    ++tx_count;
+    return ERROR_OK;
+}
+
+/**
+ * @brief Reads a specific RX buffer, host does not track which buffer a frame landed in.
+ * @param rxbn Unused.
+ * @param frame Output frame.
+ * @return ERROR_OK if a frame was read, ERROR_NOMSG otherwise.
+ */
+MCP2515::ERROR MCP2515::readMessage(const RXBn rxbn, struct can_frame *frame)
+{
+    (void)rxbn;
+    return readMessage(frame);
+}
+
+/**
+ * @brief Reads the oldest received frame.
+ * @param frame Output frame.
+ * @return ERROR_OK if a frame was read, ERROR_NOMSG otherwise.
+ */
+MCP2515::ERROR MCP2515::readMessage(struct can_frame *frame)
+{
+    if (rx_count == 0 || frame == nullptr)
+    {
+        NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+        return ERROR_NOMSG;
+    }
+    NativeHost::advanceMicros(NativeHost::costs.mcp_read);
+    *frame = rx_buf[rx_head];
+    rx_head = (rx_head + 1) % RX_BUFFERS;
+    --rx_count;
+    updateInt();
+    return ERROR_OK;
+}
+
+bool MCP2515::checkReceive()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    return rx_count > 0;
+}
+
+bool MCP2515::checkError()
+{
+    return getErrorFlags() != 0;
+}
+
+uint8_t MCP2515::getErrorFlags()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    uint8_t flags = eflg;
+    if (bus_off)
+        flags |= EFLG_TXBO;
+    if (tec >= 128)
+        flags |= EFLG_TXEP;
+    if (rec >= 128)
+        flags |= EFLG_RXEP;
+    if (tec >= 96)
+        flags |= EFLG_TXWAR;
+    if (rec >= 96)
+        flags |= EFLG_RXWAR;
+    if (tec >= 96 || rec >= 96)
+        flags |= EFLG_EWARN;
+    return flags;
+}
+
+void MCP2515::clearRXnOVRFlags()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    eflg &= ~(EFLG_RX0OVR | EFLG_RX1OVR);
+}
+
+uint8_t MCP2515::getInterrupts()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    uint8_t intf = 0;
+    if (rx_count > 0)
+        intf |= CANINTF_RX0IF;
+    if (rx_count > 1)
+        intf |= CANINTF_RX1IF;
+    if (eflg != 0)
+        intf |= CANINTF_ERRIF;
+    return intf;
+}
+
+void MCP2515::clearInterrupts()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+}
+
+uint8_t MCP2515::getStatus()
+{
+    return getInterrupts();
+}
+
+void MCP2515::clearRXnOVR()
+{
+    clearRXnOVRFlags();
+}
+
+uint8_t MCP2515::errorCountRX()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    return rec;
+}
+
+uint8_t MCP2515::errorCountTX()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+    return tec;
+}
+
+void MCP2515::clearMERR()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+}
+
+void MCP2515::clearERRIF()
+{
+    NativeHost::advanceMicros(NativeHost::costs.mcp_poll);
+}
+
+// === host side ===
+
+/**
+ * @brief Delivers a frame from the bus, as if another node sent it.
+ * Goes through the acceptance filters; if both RX buffers are full the frame is lost
+ * and the overflow flag is set, as on the chip. Costs no virtual time.
+ * @param frame Frame on the bus.
+ * @return true if the frame was stored in an RX buffer.
+ */
+bool MCP2515::injectRx(const can_frame &frame)
+{
+    if (!normal_mode || bus_off || bus_fault || !accepts(frame))
+        return false;
+    if (rx_count >= RX_BUFFERS)
+    {
+        eflg |= EFLG_RX1OVR;
+        return false;
+    }
+    rx_buf[(rx_head + rx_count) % RX_BUFFERS] = frame;
+    ++rx_count;
+    updateInt();
+    return true;
+}
+
+/**
+ * @brief Wires the INT line to a pin. INT is active low while an RX buffer is full,
+ * and a falling edge runs the handler attached to that pin's external interrupt.
+ * @param pin Pin number, see Arduino.h.
+ */
+void MCP2515::setIntPin(uint8_t pin)
+{
+    int_pin = pin;
+    updateInt();
+}
+
+/**
+ * @brief Breaks or repairs the bus wires. While broken nothing is received, and the first transmit request takes the
+ * controller bus-off (on the chip, 32 failed attempts in a few ms). It stays bus-off until reset(), even once repaired.
+ * @param fault true to break the bus.
+ */
+void MCP2515::setBusFault(const bool fault)
+{
+    bus_fault = fault;
+    flushTxBuffers();
+}
+
+/**
+ * @brief Sets the error counters, e.g. TEC 128 for a controller nobody acknowledges (transmit error passive).
+ * @param tec_ Transmit error counter.
+ * @param rec_ Receive error counter.
+ */
+void MCP2515::setErrorCounts(const uint8_t tec_, const uint8_t rec_)
+{
+    tec = tec_;
+    rec = rec_;
+}
+
+/**
+ * @brief READ STATUS instruction (0xA0).
+ * @details Bits 2, 4, 6 are TXREQ of TXB0-2, bits 0-1 RX0IF/RX1IF. TX buffers waiting for room in the TX queue
+ * are moved first, as if the bus had time to send them since the last call.
+ * @return Status byte.
+ */
+uint8_t MCP2515::readStatusInstruction()
+{
+    flushTxBuffers();
+    uint8_t status = 0;
+    for (uint8_t i = 0; i < TX_BUFFERS; ++i)
+    {
+        if (tx_req & (1 << i))
+            status |= 0x04 << (2 * i);
+    }
+    if (rx_count > 0)
+        status |= CANINTF_RX0IF;
+    if (rx_count > 1)
+        status |= CANINTF_RX1IF;
+    return status;
+}
+
+/**
+ * @brief RX STATUS instruction (0xB0).
+ * @details Bit 6 is set while RXB0 holds a frame, bit 7 while RXB1 does. The message type and filter hit bits aren't modelled.
+ * @return Status byte.
+ */
+uint8_t MCP2515::rxStatusInstruction()
+{
+    uint8_t status = 0;
+    if (rx_count > 0)
+        status |= 0x40;
+    if (rx_count > 1)
+        status |= 0x80;
+    return status;
+}
+
+/**
+ * @brief READ RX BUFFER instruction (0x90 + 4 * rxbn), starting at RXBnSIDH, reading only the data bytes of the DLC.
+ * @details Raising CS clears RXnIF, so the buffer is released. The oldest frame is read whichever buffer is named,
+ * as in readMessage().
+ * @param rxbn Buffer to read.
+ * @param regs Output, SIDH, SIDL, EID8, EID0, DLC, then the data bytes, as the registers are laid out on the chip, 13 bytes.
+ * @return Bytes written to regs, 5 + data length, 0 if the buffer is empty.
+ */
+uint8_t MCP2515::readRxBuffer(const RXBn rxbn, uint8_t *regs)
+{
+    (void)rxbn;
+    if (rx_count == 0 || regs == nullptr)
+        return 0;
+
+    const can_frame &frame = rx_buf[rx_head];
+    const bool ext = frame.can_id & CAN_EFF_FLAG;
+    const uint32_t layout = registerLayout(frame.can_id, ext);
+    regs[0] = layout >> 21;                                        // SID 10-3
+    regs[1] = (((layout >> 18) & 0x07) << 5) | ((layout >> 16) & 0x03); // SID 2-0, EID 17-16
+    if (ext)
+        regs[1] |= 0x08; // IDE
+    else if (frame.can_id & CAN_RTR_FLAG)
+        regs[1] |= 0x10; // SRR, standard remote frame
+    regs[2] = (layout >> 8) & 0xFF;
+    regs[3] = layout & 0xFF;
+    const uint8_t dlc = frame.can_dlc > CAN_MAX_DLEN ? CAN_MAX_DLEN : frame.can_dlc;
+    regs[4] = dlc | ((ext && (frame.can_id & CAN_RTR_FLAG)) ? 0x40 : 0);
+    for (uint8_t i = 0; i < dlc; ++i)
+        regs[5 + i] = frame.data[i];
+
+    rx_head = (rx_head + 1) % RX_BUFFERS;
+    --rx_count;
+    updateInt();
+    return 5 + dlc;
+}
+
+/**
+ * @brief LOAD TX BUFFER instruction (0x40 + 2 * txbn), starting at TXBnSIDH.
+ * @param txbn Buffer to load.
+ * @param regs SIDH, SIDL, EID8, EID0, DLC, then the data bytes, as the registers are laid out on the chip.
+ * @param len Number of bytes in regs, 5 + data length.
+ */
+void MCP2515::loadTxBuffer(const TXBn txbn, const uint8_t *regs, const uint8_t len)
+{
+    if (txbn >= TX_BUFFERS || regs == nullptr || len < 5)
+        return;
+
+    can_frame &frame = tx_buf[txbn];
+    const uint8_t sidh = regs[0], sidl = regs[1];
+    if (sidl & 0x08) // EXIDE
+        frame.can_id = ((uint32_t)sidh << 21) | ((uint32_t)(sidl >> 5) << 18) | ((uint32_t)(sidl & 0x03) << 16) |
+                       ((uint32_t)regs[2] << 8) | regs[3] | CAN_EFF_FLAG;
+    else
+        frame.can_id = ((uint32_t)sidh << 3) | (sidl >> 5);
+    if (regs[4] & 0x40) // RTR
+        frame.can_id |= CAN_RTR_FLAG;
+    frame.can_dlc = regs[4] & 0x0F;
+    for (uint8_t i = 0; i < CAN_MAX_DLEN; ++i)
+        frame.data[i] = 5 + i < len ? regs[5 + i] : 0;
+}
+
+/**
+ * @brief RTS instruction (0x80 + mask), requests transmission of the loaded TX buffers.
+ * @param txbn_mask Bit n requests TXBn.
+ */
+void MCP2515::requestToSend(const uint8_t txbn_mask)
+{
+    tx_req |= txbn_mask & ((1 << TX_BUFFERS) - 1);
+    flushTxBuffers();
+}
+
+/**
+ * @brief WRITE instruction (0x02) to TXBnCTRL, sets the buffer priority (TXP, bits 1-0) and requests it if TXREQ (bit 3) is set.
+ * @param txbn Buffer to write.
+ * @param value TXBnCTRL value.
+ */
+void MCP2515::writeTxControl(const TXBn txbn, const uint8_t value)
+{
+    if (txbn >= TX_BUFFERS)
+        return;
+    tx_prio[txbn] = value & 0x03;
+    if (value & 0x08)
+    {
+        tx_req |= 1 << txbn;
+        flushTxBuffers();
+    }
+}
+
+/**
+ * @brief Moves requested TX buffers to the TX queue while it has room, highest TXP first, TXB2 first at equal TXP like the chip.
+ * Nothing moves while bus-off.
+ */
+void MCP2515::flushTxBuffers()
+{
+    if (bus_fault && tx_req != 0)
+    {
+        bus_off = true;
+        tec = 255;
+    }
+    if (bus_off)
+        return; // requested buffers wait until reset()
+    while (tx_req != 0 && tx_count < TX_QUEUE_SIZE)
+    {
+        int8_t first = -1;
+        for (int8_t i = TX_BUFFERS - 1; i >= 0; --i)
+        {
+            if ((tx_req & (1 << i)) && (first < 0 || tx_prio[i] > tx_prio[first]))
+                first = i;
+        }
+        tx_queue[(tx_head + tx_count) % TX_QUEUE_SIZE] = tx_buf[first];
+        ++tx_count;
+        tx_req &= ~(1 << first);
+    }
+}
+
+/**
+ * @brief Takes the oldest frame the firmware sent. Costs no virtual time.
+ * @param frame Output frame.
+ * @return true if a frame was taken.
+ */
+bool MCP2515::popTx(can_frame &frame)
+{
+    if (tx_count == 0)
+        return false;
+    frame = tx_queue[tx_head];
+    tx_head = (tx_head + 1) % TX_QUEUE_SIZE;
+    --tx_count;
+    return true;
+}
+
+/**
+ * @brief Places an ID or mask in the 29 register bits, SID 10-0 on top of EID 17-0, as the chip compares them.
+ * @param value 11-bit standard or 29-bit extended value.
+ * @param ext Extended layout.
+ * @return Register layout.
+ */
+uint32_t MCP2515::registerLayout(const uint32_t value, const bool ext)
+{
+    return ext ? value & CAN_EFF_MASK : (value & CAN_SFF_MASK) << 18;
+}
+
+/**
+ * @brief Acceptance check as done by the MCP2515.
+ * RXF0-1 are checked against RXM0, RXF2-5 against RXM1, a filter only takes frames of its type (EXIDE).
+ * For standard frames only the SID bits are compared, the data byte filtering of the EID bits is not modelled.
+ * @param frame Received frame.
+ * @return true if any filter accepts the frame.
+ */
+bool MCP2515::accepts(const can_frame &frame) const
+{
+    const bool ext = frame.can_id & CAN_EFF_FLAG;
+    const uint32_t id = registerLayout(frame.can_id, ext);
+    const uint32_t compared = ext ? CAN_EFF_MASK : registerLayout(CAN_SFF_MASK, false);
+    for (uint8_t i = 0; i < 6; ++i)
+    {
+        if (filter_ext[i] != ext)
+            continue;
+        if (((id ^ filters[i]) & masks[i < 2 ? 0 : 1] & compared) == 0)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Drives the INT pin from the RX buffer state, raising the interrupt on a falling edge.
+ */
+void MCP2515::updateInt()
+{
+    if (int_pin == NO_PIN)
+        return;
+    const bool level = rx_count == 0; // active low
+    const bool falling = NativeHost::getDigital(int_pin) && !level;
+    NativeHost::setDigital(int_pin, level);
+    if (falling)
+        NativeHost::raiseInterrupt(digitalPinToInterrupt(int_pin));
+}
@@ -0,0 +1,211 @@
+/**
+ * @file mcp2515.h
+ * @author Planeson, Red Bird Racing
+ * @brief Native stand-in for the autowp-mcp2515 MCP2515 class, backed by in-memory queues
+ * @version 1.6
+ * @date 2026-10-16
+ * @see mcp2515.cpp, can.h, NativeHost.hpp
+ */
+
+#ifndef _MCP2515_H_
+#define _MCP2515_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "can.h"
+
+/** @brief Same values as the autowp enum, only used to pick the bit timing on hardware. */
+enum CAN_CLOCK
+{
+    MCP_20MHZ,
+    MCP_16MHZ,
+    MCP_8MHZ
+};
+
+/** @brief Same values as the autowp enum, only used to pick the bit timing on hardware. */
+enum CAN_SPEED
+{
+    CAN_5KBPS,
+    CAN_10KBPS,
+    CAN_20KBPS,
+    CAN_31K25BPS,
+    CAN_33KBPS,
+    CAN_40KBPS,
+    CAN_50KBPS,
+    CAN_80KBPS,
+    CAN_83K3BPS,
+    CAN_95KBPS,
+    CAN_100KBPS,
+    CAN_125KBPS,
+    CAN_200KBPS,
+    CAN_250KBPS,
+    CAN_500KBPS,
+    CAN_1000KBPS
+};
+
+/**
+ * @brief In-memory MCP2515 with the same public interface as the autowp driver.
+ * @details Transmitted frames go into a TX queue that the host drains with popTx(),
+ * received frames are pushed by the host with injectRx(). The two hardware RX buffers
+ * and the RXM0/RXM1 + RXF0-RXF5 acceptance logic are modelled, so filter setups and RX
+ * overflows behave as on the chip. Every SPI-touching call advances the virtual clock
+ * by the cost in NativeHost::costs.
+ */
+class MCP2515
+{
+public:
+    /** @brief Driver return codes, same values as autowp. */
+    enum ERROR
+    {
+        ERROR_OK = 0,
+        ERROR_FAIL = 1,
+        ERROR_ALLTXBUSY = 2,
+        ERROR_FAILINIT = 3,
+        ERROR_FAILTX = 4,
+        ERROR_NOMSG = 5
+    };
+
+    /** @brief Acceptance masks. */
+    enum MASK
+    {
+        MASK0,
+        MASK1
+    };
+
+    /** @brief Acceptance filters, RXF0-1 use MASK0, RXF2-5 use MASK1. */
+    enum RXF
+    {
+        RXF0 = 0,
+        RXF1 = 1,
+        RXF2 = 2,
+        RXF3 = 3,
+        RXF4 = 4,
+        RXF5 = 5
+    };
+
+    /** @brief Receive buffers. */
+    enum RXBn
+    {
+        RXB0 = 0,
+        RXB1 = 1
+    };
+
+    /** @brief Transmit buffers. */
+    enum TXBn
+    {
+        TXB0 = 0,
+        TXB1 = 1,
+        TXB2 = 2
+    };
+
+    /** @brief CANINTF register bits. */
+    enum CANINTF : uint8_t
+    {
+        CANINTF_RX0IF = 0x01,
+        CANINTF_RX1IF = 0x02,
+        CANINTF_TX0IF = 0x04,
+        CANINTF_TX1IF = 0x08,
+        CANINTF_TX2IF = 0x10,
+        CANINTF_ERRIF = 0x20,
+        CANINTF_WAKIF = 0x40,
+        CANINTF_MERRF = 0x80
+    };
+
+    /** @brief EFLG register bits. */
+    enum EFLG : uint8_t
+    {
+        EFLG_RX1OVR = (1 << 7),
+        EFLG_RX0OVR = (1 << 6),
+        EFLG_TXBO = (1 << 5),
+        EFLG_TXEP = (1 << 4),
+        EFLG_RXEP = (1 << 3),
+        EFLG_TXWAR = (1 << 2),
+        EFLG_RXWAR = (1 << 1),
+        EFLG_EWARN = (1 << 0)
+    };
+
+    static constexpr uint8_t RX_BUFFERS = 2;    /**< Hardware RX buffers (RXB0 rolling over into RXB1) */
+    static constexpr uint8_t TX_BUFFERS = 3;    /**< Hardware TX buffers, TXB0-TXB2 */
+    static constexpr uint8_t TX_QUEUE_SIZE = 64; /**< Frames held on the "wire" before sendMessage reports ERROR_ALLTXBUSY */
+
+    explicit MCP2515(const uint8_t cs_pin_, const uint32_t spi_clock_ = 10000000, void *spi_ = nullptr);
+
+    ERROR reset();
+    ERROR setConfigMode();
+    ERROR setListenOnlyMode();
+    ERROR setSleepMode();
+    ERROR setLoopbackMode();
+    ERROR setNormalMode();
+    ERROR setBitrate(const CAN_SPEED can_speed);
+    ERROR setBitrate(const CAN_SPEED can_speed, const CAN_CLOCK can_clock);
+    ERROR setFilterMask(const MASK num, const bool ext, const uint32_t ul_data);
+    ERROR setFilter(const RXF num, const bool ext, const uint32_t ul_data);
+    ERROR sendMessage(const TXBn txbn, const struct can_frame *frame);
+    ERROR sendMessage(const struct can_frame *frame);
+    ERROR readMessage(const RXBn rxbn, struct can_frame *frame);
+    ERROR readMessage(struct can_frame *frame);
+    bool checkReceive();
+    bool checkError();
+    uint8_t getErrorFlags();
+    void clearRXnOVRFlags();
+    uint8_t getInterrupts();
+    void clearInterrupts();
+    uint8_t getStatus();
+    void clearRXnOVR();
+    uint8_t errorCountRX();
+    uint8_t errorCountTX();
+    void clearMERR();
+    void clearERRIF();
+
+    // === host side, not part of the autowp interface ===
+
+    bool injectRx(const can_frame &frame);
+    bool popTx(can_frame &frame);
+    uint8_t csPin() const { return cs_pin; } /**< Chip select pin given at construction, used to tell controllers apart */
+    void setIntPin(uint8_t pin);
+    void setBusFault(const bool fault);
+    void setErrorCounts(const uint8_t tec_, const uint8_t rec_);
+
+    // === SPI instruction level, for drivers that talk to the chip without the autowp calls (CanTx, CanRx), no virtual time charged ===
+
+    uint8_t readStatusInstruction();
+    uint8_t rxStatusInstruction();
+    uint8_t readRxBuffer(const RXBn rxbn, uint8_t *regs);
+    void loadTxBuffer(const TXBn txbn, const uint8_t *regs, const uint8_t len);
+    void requestToSend(const uint8_t txbn_mask);
+    void writeTxControl(const TXBn txbn, const uint8_t value);
+
+    static uint8_t instanceCount();
+    static MCP2515 *instance(uint8_t index);
+
+private:
+    uint8_t cs_pin;                         /**< Chip select pin, identifies the controller */
+    uint8_t int_pin;                        /**< Pin the INT line is wired to, NO_PIN if not wired */
+    bool normal_mode;                       /**< Only normal mode sends and receives */
+    uint32_t masks[2];                      /**< RXM0, RXM1, in the register layout, 0 accepts every frame */
+    uint32_t filters[6];                    /**< RXF0-RXF5, in the register layout */
+    bool filter_ext[6];                     /**< EXIDE bit of each filter */
+    can_frame rx_buf[RX_BUFFERS];           /**< RXB0, RXB1 */
+    uint8_t rx_head;                        /**< Oldest occupied RX buffer */
+    uint8_t rx_count;                       /**< Occupied RX buffers */
+    uint8_t eflg;                           /**< RX overflow flags, the error state bits are derived from tec and rec */
+    uint8_t tec;                            /**< Transmit error counter, 255 while bus-off */
+    uint8_t rec;                            /**< Receive error counter */
+    bool bus_off;                           /**< Bus-off, only reset() recovers */
+    bool bus_fault;                         /**< Host-set wire fault, see setBusFault() */
+    can_frame tx_queue[TX_QUEUE_SIZE];      /**< Frames sent but not yet drained by the host */
+    uint8_t tx_head;                        /**< Oldest frame in tx_queue */
+    uint8_t tx_count;                       /**< Frames in tx_queue */
+    can_frame tx_buf[TX_BUFFERS];           /**< TXB0-TXB2, as written by loadTxBuffer() */
+    uint8_t tx_req;                         /**< TXREQ bit of each TX buffer, set until the frame fits in tx_queue */
+    uint8_t tx_prio[TX_BUFFERS];            /**< TXP bits of each TXBnCTRL */
+
+    static constexpr uint8_t NO_PIN = 0xFF; /**< int_pin value when INT isn't wired */
+
+    static uint32_t registerLayout(const uint32_t value, const bool ext);
+    bool accepts(const can_frame &frame) const;
+    void flushTxBuffers();
+    void updateInt();
+};
+
+#endif // _MCP2515_H_
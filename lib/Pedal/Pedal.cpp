@@ -2,8 +2,8 @@
  * @file Pedal.cpp
  * @author Planeson, Red Bird Racing
  * @brief Implementation of the Pedal class for handling throttle pedal inputs
- * @version 1.6
- * @date 2026-02-12
+ * @version 1.16
+ * @date 2026-10-17
  * @see Pedal.hpp
  */
 
@@ -26,37 +26,43 @@
  * @brief Constructor for the Pedal class.
  * Initializes the pedal state. fault is set to true initially,
  * so you must send update within 100ms of starting the car to clear it.
- * Sends request to motor controller for cyclic RPM and error reads.
- * @param motor_can_ Reference to the MCP2515 instance for motor CAN communication.
+ * The acceptance filters are planned from the CAN routes in main.cpp, see CanFilter.
+ * @param motor_port_ Reference to the port of the motor CAN bus, used for the torque commands and the cyclic read requests.
  * @param car_ Reference to the CarState structure.
  * @param pedal_final_ Reference to the pedal used as the final pedal value. Although not recommended, you can set another uint16 outside Pedal to be something like 0.3 APPS_1 + 0.7 APPS_2, then reference that here. If in future, this become a sustained need, should consider adding a function pointer to find the final pedal value to let Pedal class call it itself.
  */
-Pedal::Pedal(MCP2515 &motor_can_, CarState &car_, uint16_t &pedal_final_)
+Pedal::Pedal(CanPort &motor_port_, CarState &car_, uint16_t &pedal_final_)
     : pedal_final(pedal_final_),
+      latency(FILTER_DELAY_US),
       car(car_),
-      motor_can(motor_can_),
+      motor_port(motor_port_),
       fault_start_millis(0),
       last_motor_read_millis(0)
+{
+}
+
+/**
+ * @brief Sends the request to the motor controller for cyclic RPM and error reads.
+ * Call once the motor CAN controller is initialised, a request sent before its reset would be lost.
+ */
+void Pedal::begin()
 {
     // ask MCU to send motor rpm and error/warn signals
     while (sendCyclicRead(SPEED_IST, RPM_PERIOD) != MCP2515::ERROR_OK)
         ;
     while (sendCyclicRead(WARN_ERR, ERR_PERIOD) != MCP2515::ERROR_OK)
         ;
-    // set MCU CAN filter
-    while (motor_can.setFilter(MCP2515::RXF0, false, MOTOR_READ) != MCP2515::ERROR_OK)
-        ;
 }
 
 /**
  * @brief Updates pedal sensor readings, applies filtering, and checks for faults.
  *
- * Stores new pedal readings, applies an average filter, and updates car state.
+ * Stores new pedal readings, applies the median and low-pass filters, and updates car state.
  * If a fault is detected between pedal sensors, sets fault flags and logs status.
  *
- * @param pedal_1 Raw value from pedal sensor 1.
- * @param pedal_2 Raw value from pedal sensor 2.
- * @param brake Raw value from brake sensor.
+ * @param pedal_1 Raw value from pedal sensor 1, ADC_BITS.
+ * @param pedal_2 Raw value from pedal sensor 2, ADC_BITS.
+ * @param brake Raw value from brake sensor, ADC_BITS.
  */
 void Pedal::update(uint16_t pedal_1, uint16_t pedal_2, uint16_t brake)
 {
@@ -64,6 +70,7 @@ void Pedal::update(uint16_t pedal_1, uint16_t pedal_2, uint16_t brake)
     pedal1_filter.addSample(pedal_1);
     pedal2_filter.addSample(pedal_2);
     brake_filter.addSample(brake);
+    latency.mark(LatencyStage::Filter);
 
     if (pedal_1 < APPS_5V_MIN)
         car.pedal.faults.bits.apps_5v_low = true;
@@ -124,9 +131,14 @@ void Pedal::update(uint16_t pedal_1, uint16_t pedal_2, uint16_t brake)
 
 /**
  * @brief Sends the appropriate CAN frame to the motor based on pedal and car state.
+ * The frame of the last call has been requested by now, its stamp completes the latency of its sample.
  */
 void Pedal::sendFrame()
 {
+    uint32_t sent_us;
+    if (motor_port.takeStamp(sent_us))
+        latency.complete(sent_us);
+
     // Update Telemetry struct
     car.pedal.apps_5v = pedal1_filter.getFiltered();
     car.pedal.apps_3v3 = pedal2_filter.getFiltered();
@@ -135,7 +147,7 @@ void Pedal::sendFrame()
     if (car.pedal.status.bits.force_stop)
     {
         DBGLN_THROTTLE("Stopping motor: pedal fault");
-        motor_can.sendMessage(&stop_frame);
+        sendTorque(stop_frame);
         return;
     }
     if (car.pedal.status.bits.car_status != CarStatus::Drive)
@@ -155,7 +167,7 @@ void Pedal::sendFrame()
             DBGLN_THROTTLE("Stopping motor: in UNKNOWN STATE.");
             break;
         }
-        motor_can.sendMessage(&stop_frame);
+        sendTorque(stop_frame);
         return;
     }
 
@@ -163,10 +175,20 @@ void Pedal::sendFrame()
 
     torque_msg.data[1] = car.motor.torque_val & 0xFF;
     torque_msg.data[2] = (car.motor.torque_val >> 8) & 0xFF;
-    motor_can.sendMessage(&torque_msg);
+    sendTorque(torque_msg);
     return;
 }
 
+/**
+ * @brief Queues a torque command, stamped for the latency of the newest filtered sample.
+ * @param frame Torque command, stop_frame or torque_msg.
+ */
+void Pedal::sendTorque(const can_frame &frame)
+{
+    latency.mark(LatencyStage::Map);
+    motor_port.send(&frame, true);
+}
+
 /**
  * @brief Maps the pedal ADC to a torque value.
  * If no braking requested, maps throttle normally.
@@ -175,8 +197,8 @@ void Pedal::sendFrame()
  *      preventing reverse torque at low speeds.
  *      Regen is also disabled if motor rpm isn't read recently to prevent reverse power.
  *
- * @param pedal Pedal ADC in the range of 0-1023.
- * @param brake Brake ADC in the range of 0-1023.
+ * @param pedal Pedal ADC in ADC_BITS, 0-4095 with the default oversampling.
+ * @param brake Brake ADC in ADC_BITS.
  * @param motor_rpm Current motor RPM for regen logic, scaled to 0-32767.
  * @param flip_dir Boolean indicating whether to flip the motor direction.
  * @return Mapped torque value in the signed range of -TORQUE_MAX to TORQUE_MAX.
@@ -216,7 +238,7 @@ constexpr int16_t Pedal::pedalTorqueMapping(const uint16_t pedal, const uint16_t
  * @brief Checks for a fault between two pedal sensor readings.
  *
  * Scales pedal_2 to match the range of pedal_1, then calculates the absolute difference.
- * If the difference exceeds 10% of the full-scale value (i.e., >102.4 for a 10-bit ADC),
+ * If the difference exceeds 10% of the valid APPS_5V range (THROTTLE_MAP, in ADC_BITS),
  * the function considers this a fault and returns true. Otherwise, returns false.
  *
  * @return true if the difference exceeds the threshold (fault detected), false otherwise.
@@ -249,34 +271,35 @@ MCP2515::ERROR Pedal::sendCyclicRead(uint8_t reg_id, uint8_t read_period)
         reg_id,     /**< data, sub ID */
         read_period /**< data, read period in ms */
     };
-    return motor_can.sendMessage(&cyclic_request);
+    return motor_port.send(&cyclic_request);
 }
 
 /**
- * @brief Reads motor data from the CAN bus and updates the CarState.
+ * @brief Handles a SPEED_IST reply of the motor controller, routed by the CAN dispatch table.
+ * @param frame MOTOR_READ frame with data[0] SPEED_IST, at least 3 bytes.
  */
-void Pedal::readMotor()
+void Pedal::onMotorSpeed(const can_frame &frame)
+{
+    last_motor_read_millis = car.millis;
+    car.pedal.status.bits.motor_no_read = false;
+    car.motor.motor_rpm = static_cast<int16_t>(frame.data[1] | (frame.data[2] << 8));
+}
+
+/**
+ * @brief Handles a WARN_ERR reply of the motor controller, routed by the CAN dispatch table.
+ * @param frame MOTOR_READ frame with data[0] WARN_ERR, at least 5 bytes.
+ */
+void Pedal::onMotorWarnErr(const can_frame &frame)
+{
+    car.motor.motor_error = static_cast<uint16_t>(frame.data[1] | (frame.data[2] << 8));
+    car.motor.motor_warn = static_cast<uint16_t>(frame.data[3] | (frame.data[4] << 8));
+}
+
+/**
+ * @brief Flags the motor data as stale if no SPEED_IST arrived for MAX_MOTOR_READ_MILLIS, disabling regen.
+ */
+void Pedal::checkMotorTimeout()
 {
-    can_frame rx_frame;
-    if (motor_can.readMessage(&rx_frame) == MCP2515::ERROR_OK)
-    {
-        if (rx_frame.can_id == MOTOR_READ && rx_frame.can_dlc > 3)
-        {
-            if (rx_frame.data[0] == SPEED_IST)
-            {
-                last_motor_read_millis = car.millis;
-                car.pedal.status.bits.motor_no_read = false;
-                car.motor.motor_rpm = static_cast<int16_t>(rx_frame.data[1] | (rx_frame.data[2] << 8));
-                return;
-            }
-            else if (rx_frame.data[0] == WARN_ERR)
-            {
-                car.motor.motor_error = static_cast<uint16_t>(rx_frame.data[1] | (rx_frame.data[2] << 8));
-                car.motor.motor_warn = static_cast<uint16_t>(rx_frame.data[3] | (rx_frame.data[4] << 8));
-                return;
-            }
-        }
-    }
     if (car.millis - last_motor_read_millis > MAX_MOTOR_READ_MILLIS)
     {
         car.pedal.status.bits.motor_no_read = true;
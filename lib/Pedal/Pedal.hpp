@@ -2,8 +2,8 @@
  * @file Pedal.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of the Pedal class for handling throttle and brake pedal inputs
- * @version 1.6
- * @date 2026-02-12
+ * @version 1.20
+ * @date 2026-10-17
  * @see Pedal.cpp
  * @dir Pedal @brief The Pedal library contains the Pedal class to manage throttle and brake pedal inputs, including filtering, fault detection, and CAN communication.
  */
@@ -16,6 +16,9 @@
 #include "Interp.hpp"
 #include "Curves.hpp"
 #include "SignalProcessing.hpp"
+#include "CanPort.hpp"
+#include "LatencyProbe.hpp"
+#include "AdcSampler.hpp" // adcWindowDelayUs()
 
 // ignore -Wpedantic warnings for mcp2515.h
 #pragma GCC diagnostic push
@@ -59,6 +62,10 @@ namespace PedalConstants
         (double)MIN_REGEN_KMH / MINUTES_PER_HOUR * INCH_PER_KM / WHEEL_DIAMETER_INCH / PI_ * GEAR_RATIO_NUMERATOR / GEAR_RATIO_DENOMINATOR * MAX_TORQUE_VAL / MAX_MOTOR_RPM; /**< Minimum RPM for regenerative braking to be active. */
 } // namespace PedalConstants
 constexpr uint8_t ADC_BUFFER_SIZE = 16; /**< Size of the ADC reading buffer for filtering. */
+constexpr uint32_t PEDAL_SAMPLE_HZ = 1000;  /**< Rate of update(), the Scheduler fast lane in main.cpp; the filters are designed for it. */
+constexpr uint8_t PEDAL_ADC_SLOTS = 4;       /**< Inputs the AdcSampler rotates through in main.cpp, pedals, brake and hall sensor */
+constexpr uint8_t PEDAL_ADC_OVERSAMPLED = 3; /**< Of them oversampled, APPS 5V, APPS 3V3 and brake */
+constexpr uint32_t PEDAL_CUTOFF_CHZ = 1500; /**< Cutoff of the pedal and brake low-pass in 0.01 Hz, sets the filter delay, see Pedal::FILTER_DELAY_US. */
 
 /**
  * @brief Pedal class for managing throttle and brake pedal inputs.
@@ -67,15 +74,31 @@ constexpr uint8_t ADC_BUFFER_SIZE = 16; /**< Size of the ADC reading buffer for
 class Pedal
 {
 public:
-    Pedal(MCP2515 &motor_can_, CarState &car, uint16_t &pedal_final_);
+    Pedal(CanPort &motor_port_, CarState &car, uint16_t &pedal_final_);
+    void begin();
     void update(uint16_t pedal_1, uint16_t pedal_2, uint16_t brake);
     void sendFrame();
-    void readMotor();
+    void onMotorSpeed(const can_frame &frame);
+    void onMotorWarnErr(const can_frame &frame);
+    void checkMotorTimeout();
     uint16_t &pedal_final; /**< Final pedal value is taken directly from apps_5v, see initializer */
+    LatencyProbe latency;  /**< APPS sample to torque command latency including FILTER_DELAY_US, mark LatencyStage::Sample before reading the APPS */
+
+    static constexpr canid_t MOTOR_READ = 0x181; /**< Motor read CAN ID, route SPEED_IST and WARN_ERR to onMotorSpeed()/onMotorWarnErr() */
+    static constexpr uint8_t SPEED_IST = 0x30;   /**< Register ID for "actual speed value", data[0] of MOTOR_READ */
+    static constexpr uint8_t WARN_ERR = 0x8F;    /**< Register ID for warnings and errors, data[0] of MOTOR_READ */
+
+    // Filters for pedal and brake inputs, see SignalProcessing.hpp for the stages
+    using PedalLowPass = BiquadLowPassStage<PEDAL_SAMPLE_HZ, PEDAL_CUTOFF_CHZ, ADC_BITS>; /**< 2nd order Butterworth, 15 Hz at 1 kHz: the ~15 ms delay of EMA 15:1 with twice the roll-off */
+    using PedalMedian = MedianStage<5, uint16_t, PEDAL_SAMPLE_HZ>;                        /**< Spikes up to 2 samples rejected by the median first */
+    using PedalFilter = FilterChain<PedalMedian, PedalLowPass>;                            /**< Median, then low-pass */
+    static constexpr uint32_t FILTER_DELAY_US = adcWindowDelayUs(PEDAL_ADC_SLOTS, PEDAL_ADC_OVERSAMPLED) + PedalMedian::DELAY_US +
+                                                PedalLowPass::DELAY_US; /**< Lag of the filtered pedal and brake behind a slow movement: oversampling window, median and low-pass */
+    static_assert(FILTER_DELAY_US < 0xFFFF, "the latency stats are 16 bit us");
 
 private:
     CarState &car;                   /**< Reference to CarState */
-    MCP2515 &motor_can;              /**< Reference to MCP2515 for sending CAN messages */
+    CanPort &motor_port;             /**< Port of the motor CAN bus, torque commands and cyclic read requests */
     uint32_t fault_start_millis;     /**< Timestamp for when a fault started */
     uint32_t last_motor_read_millis; /**< Timestamp for the last motor data read */
 
@@ -99,27 +122,23 @@ private:
         0x00,       /**< data, init as 0 torque * 2 */
         0x00};
 
-    // Filters for pedal and brake inputs, see Signal_Processing.hpp for options
-    ExponentialFilter<uint16_t, uint16_t> pedal1_filter; /**< Filter for first pedal sensor input */
-    ExponentialFilter<uint16_t, uint16_t> pedal2_filter; /**< Filter for second pedal sensor input */
-    ExponentialFilter<uint16_t, uint16_t> brake_filter;  /**< Filter for brake sensor input */
+    PedalFilter pedal1_filter; /**< Filter for first pedal sensor input */
+    PedalFilter pedal2_filter; /**< Filter for second pedal sensor input */
+    PedalFilter brake_filter;  /**< Filter for brake sensor input */
 
     static constexpr LinearInterp<uint16_t, int16_t, int32_t, 5> THROTTLE_MAP{THROTTLE_TABLE};               /**< Interpolation map for throttle torque */
     static constexpr LinearInterp<uint16_t, int16_t, int32_t, 5> BRAKE_MAP{BRAKE_TABLE};                     /**< Interpolation map for brake torque */
     static constexpr LinearInterp<uint16_t, uint16_t, uint32_t, 2> APPS_3V3_SCALE_MAP{APPS_3V3_SCALE_TABLE}; /**< Interpolation map for APPS_3V3->APPS_5V */
 
     static constexpr canid_t MOTOR_SEND = 0x201; /**< Motor send CAN ID */
-    static constexpr canid_t MOTOR_READ = 0x181; /**< Motor read CAN ID */
 
     static constexpr uint8_t REGID_READ = 0x3D; /**< Register ID for reading motor data */
 
-    static constexpr uint8_t SPEED_IST = 0x30; /**< Register ID for "actual speed value" */
-    static constexpr uint8_t WARN_ERR = 0x8F;  /**< Register ID for warnings and errors */
-
     static constexpr uint8_t RPM_PERIOD = 20; /**< Period of reading motor data in ms, set to 20ms to get 10ms reads alongside errors */
     static constexpr uint8_t ERR_PERIOD = 20; /**< Period of reading motor errors in ms, set to 20ms to get 10ms reads alongside rpm */
 
     bool checkPedalFault();
+    void sendTorque(const can_frame &frame);
     constexpr int16_t pedalTorqueMapping(const uint16_t pedal, const uint16_t brake, const int16_t motor_rpm, const bool flip_dir);
 
     MCP2515::ERROR sendCyclicRead(uint8_t reg_id, uint8_t read_period);
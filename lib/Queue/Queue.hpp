@@ -2,9 +2,9 @@
  * @file Queue.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of a simple RingBuffer (circular buffer) template class
- * @version 1.0
- * @date 2026-01-26
- * @dir Queue @brief The Queue library contains a simple RingBuffer (circular buffer) template class, used for buffering ADC readings for filtering.
+ * @version 1.1
+ * @date 2026-10-16
+ * @dir Queue @brief The Queue library contains a simple RingBuffer (circular buffer) template class, used for buffering ADC readings for filtering and received CAN frames.
  */
 
 #ifndef QUEUE_HPP
@@ -26,7 +26,7 @@ class RingBuffer
 public:
     // Constructor
     // Initializes the buffer and head pointer
-    constexpr RingBuffer() : buffer{0}, head(0), count(0) {}
+    constexpr RingBuffer() : buffer{}, head(0), count(0) {}
 
     /**
      * @brief Pushes a new value into the ring buffer.
@@ -42,6 +42,33 @@ public:
             ++count;
     }
 
+    /**
+     * @brief Takes the oldest value out of the ring buffer.
+     *
+     * @param out The oldest value, untouched if the buffer is empty.
+     * @return true if a value was taken, false if the buffer is empty.
+     */
+    bool pop(T &out)
+    {
+        if (count == 0)
+            return false;
+        out = buffer[(head + size - count) % size];
+        --count;
+        return true;
+    }
+
+    /**
+     * @brief Returns whether the next push() would overwrite the oldest value.
+     * @return true if the buffer holds 'size' elements.
+     */
+    bool full() const { return count == size; }
+
+    /**
+     * @brief Returns whether the buffer holds no elements.
+     * @return true if empty.
+     */
+    bool empty() const { return count == 0; }
+
     /**
      * @brief Returns the elements in the buffer in linear order.
      *
@@ -2,8 +2,8 @@
  * @file Scheduler.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of the Scheduler class template, for scheduling tasks on multiple MCP2515 instances
- * @version 1.1
- * @date 2026-01-13
+ * @version 1.10
+ * @date 2026-10-17
  * @see Scheduler.tpp
  * @dir Scheduler @brief The Scheduler library contains the Scheduler class template, which manages the scheduling of tasks for multiple MCP2515 instances, allowing for periodic execution of functions based on a specified time interval and spin-wait threshold.
  */
@@ -13,12 +13,31 @@
 
 #include "Enums.hpp"
 
+/**
+ * @brief Scheduler timing instrumentation, if 0 no stats are recorded and no extra SRAM/time is used.
+ * @details Records per task worst/average execution time, and per tick lateness, busy time, overruns and skipped sub-ticks.
+ * Costs one extra current_time_us() call per task run, and 8 bytes SRAM per task slot.
+ */
+#ifndef SCHEDULER_STATS
+#define SCHEDULER_STATS 1
+#endif
+
+/**
+ * @brief Scheduler tick source, if 1 ticks come from the Timer1 compare-match interrupt, see SchedulerTimer.
+ * @details Use beginTimerTick() and updateTimerTick() instead of update(). Timer1 is then unavailable for other uses.
+ */
+#ifndef SCHEDULER_TIMER_TICK
+#define SCHEDULER_TIMER_TICK 0
+#endif
+
 // ignore -Wpedantic warnings for mcp2515.h
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
 #include <mcp2515.h> // mcp2515 objects
 #pragma GCC diagnostic pop
 
+#include "SchedulerTimer.hpp"
+
 /**
  * @brief Scheduler class template for scheduling tasks on multiple MCP2515 instances
  * Takes in function pointers to member functions of MCP2515 class,
@@ -39,29 +58,157 @@
  * and instead work on compiling the next message while the previous SPI transaction is still ongoing.
  * Although it would be easier to only have a single queue (instead NUM_MCP2515 queues),
  * we give room for the CAN-bus to be busy on one MCP2515, while another MCP2515 can still send/receive messages,
- * i.e. we distribute the load across multiple CAN buses more evenly, instead of having one bus burst at one time
+ * i.e. we distribute the load across multiple CAN buses more evenly, instead of having one bus burst at one time.
+ * The queues should be physical controllers, not logical buses sharing one, see CanChannelMap::lane().
  *
  * In the rare case where the system is busy and misses more than one period, the scheduler will skip to the next period, preventing bursts.
  *
+ * With SCHEDULER_TIMER_TICK, Timer1 produces the tick instead: beginTimerTick() starts it, and updateTimerTick() only checks
+ * the flag the ISR sets, so it never spin-waits and the tick timing no longer depends on the rest of loop().
+ *
+ * Tasks running every n ticks are given a phase, they fire on the ticks where tick_count % n == phase.
+ * By default addTask() picks the phase that keeps the busiest tick of the hyperperiod (LCM of all intervals) as light as possible,
+ * so e.g. two tasks every 10 ticks don't fire in the same tick. worstTick() and firesAt() show the resulting worst-case tick.
+ * The busiest tick of the task's own MCP2515 counts first (tickLoad(LaneIndex, uint16_t)), the other controllers only break ties.
+ *
+ * Optionally the period is split into sub-ticks, giving two rate groups (TaskLane). The fast lane (addFastTask()) runs at the
+ * start of every sub-tick, e.g. 1ms pedal sampling. The CAN lane (addTask()) still runs each task once per period,
+ * but every task is assigned a sub-tick: addTask() picks the sub-tick with the lightest load over the hyperperiod (subTickLoad()),
+ * so CAN traffic is spread out and never piles onto the sub-tick the fast lane needs next. laneLoad() reports the CPU each lane uses.
+ *
+ * Each tick runs the tasks in TaskPriority order. With a tick budget set, once the tick has used up its budget,
+ * the remaining non-Critical tasks are deferred to the next tick (keeping their phase), and counted in getDeferrals().
+ *
+ * idle() waits for the next tick without burning the CPU: with SCHEDULER_TIMER_TICK it sleeps (SLEEP_MODE_IDLE) until the next
+ * interrupt, otherwise it sleeps while Timer0 is sure to wake it before the tick is due and spin-waits the rest.
+ * With SCHEDULER_STATS the time spent in idle() gives the CPU load of every period, see cpuLoad().
+ *
+ * getTicks() and nowMs() give a 32-bit timebase counted in sub-ticks, including skipped ones, for timers in the tasks,
+ * so they don't each read millis() and stay replayable from the tick count.
+ *
+ * With SCHEDULER_STATS, every task run and every tick is timed, see TaskStats and TickStats.
+ * getStatsEntry() packs them into small entries that can be sent one at a time, e.g. as a telemetry frame.
+ *
+ * For a task set known at compile time, see StaticScheduler. runTick() lets a StaticScheduler task drive a Scheduler
+ * that keeps only the tasks added and removed at runtime.
+ *
  * @tparam NUM_TASKS Number of tasks per MCP2515, choose highest of all, but keep as low as possible
  * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks, 0 if the period isn't split
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS = 0>
 class Scheduler
 {
 public:
     using TaskFn = void (*)();
 
+    /**
+     * @brief Execution time statistics of one task slot.
+     */
+    struct TaskStats
+    {
+        uint16_t worst_us; /**< Longest single run, in microseconds */
+        uint16_t runs;     /**< Number of runs summed in total_us, halved together with total_us before overflowing */
+        uint32_t total_us; /**< Sum of run times, in microseconds */
+
+        /**
+         * @brief Returns the average run time.
+         * @return Average run time in microseconds, 0 if never run.
+         */
+        uint16_t avgUs() const { return runs ? total_us / runs : 0; }
+    };
+
+    /**
+     * @brief Timing statistics of the scheduler ticks.
+     */
+    struct TickStats
+    {
+        uint16_t worst_late_us; /**< Largest delay from when a tick was due to when it started, in microseconds */
+        uint16_t worst_busy_us; /**< Longest time spent running the tasks of one tick, in microseconds */
+        uint16_t ticks;         /**< Number of ticks summed in the totals, halved together with them before overflowing */
+        uint16_t overruns;      /**< Ticks that finished after the next tick was due (lateness + busy >= period) */
+        uint16_t skipped;       /**< Sub-ticks skipped entirely because the scheduler was called too late, as counted by getTicks() */
+        uint32_t total_late_us; /**< Sum of tick lateness, in microseconds */
+        uint32_t total_busy_us; /**< Sum of tick busy time, in microseconds */
+        uint32_t total_fast_us; /**< Part of total_busy_us spent in the fast lane, in microseconds */
+        uint32_t total_idle_us; /**< Time spent in idle() over the recorded periods, in microseconds, halved together with the totals */
+        uint16_t last_load;     /**< CPU load of the last full period, permille, everything outside idle() counts as busy */
+        uint16_t worst_load;    /**< Highest CPU load of a single period, permille */
+
+        /**
+         * @brief Returns the average tick lateness.
+         * @return Average lateness in microseconds.
+         */
+        uint16_t avgLateUs() const { return ticks ? total_late_us / ticks : 0; }
+
+        /**
+         * @brief Returns the average time spent running tasks per tick.
+         * @return Average busy time in microseconds.
+         */
+        uint16_t avgBusyUs() const { return ticks ? total_busy_us / ticks : 0; }
+    };
+
+    static constexpr uint8_t AUTO_PHASE = 0xFF;       /**< addTask() phase: pick the least loaded phase */
+    static constexpr uint16_t MAX_HYPERPERIOD = 240; /**< Hyperperiods longer than this are truncated when balancing phases */
+
+    static constexpr uint8_t STATS_MUX_TICK_TIMING = 0xFF;  /**< getStatsEntry() mux: worst late, average late, worst busy */
+    static constexpr uint8_t STATS_MUX_TICK_COUNTERS = 0xFE; /**< getStatsEntry() mux: overruns, skipped sub-ticks, average busy */
+    static constexpr uint8_t STATS_MUX_BUDGET = 0xFD;        /**< getStatsEntry() mux: deferrals, tick budget, longest deferral in ticks */
+    static constexpr uint8_t STATS_MUX_LANES = 0xFC;         /**< getStatsEntry() mux: fast lane load, CAN lane load (permille), sub-ticks per period */
+    static constexpr uint8_t STATS_MUX_LOAD = 0xFB;          /**< getStatsEntry() mux: average, worst and last period CPU load (permille) */
+    static constexpr uint8_t PRIORITY_LEVELS = 4;            /**< Number of TaskPriority values */
+
     Scheduler() = delete; /**< all arguments must be provided */
-    Scheduler(uint32_t period_us_, uint32_t spin_threshold_us_);
+    Scheduler(uint32_t period_us_, uint32_t spin_threshold_us_, uint8_t sub_ticks_ = 1);
     // no need destructor, since no dynamic memory allocation, and won't destruct in the middle of the program anyway
 
     void update(unsigned long (*const current_time_us)());
+    void runTick(unsigned long (*const current_time_us)());
     void synchronize(unsigned long (*const current_time_us)());
-    bool addTask(const McpIndex mcp_index, const TaskFn task, const uint8_t tick_interval);
-    bool removeTask(const McpIndex mcp_index, const TaskFn task);
+    void idle(unsigned long (*const current_time_us)());
+#if SCHEDULER_TIMER_TICK
+    bool beginTimerTick();
+    void updateTimerTick(unsigned long (*const current_time_us)());
+#endif
+    bool addTask(const LaneIndex lane, const TaskFn task, const uint8_t tick_interval,
+                 const TaskPriority priority = TaskPriority::Normal, const uint8_t phase = AUTO_PHASE);
+    bool removeTask(const LaneIndex lane, const TaskFn task);
+    bool addFastTask(const TaskFn task, const uint8_t sub_tick_interval = 1);
+    bool removeFastTask(const TaskFn task);
+
+    /**
+     * @brief Sets the CPU time each tick may spend on non-Critical tasks before deferring them.
+     * @param budget_us Budget in microseconds, 0 for no limit.
+     */
+    void setTickBudget(const uint32_t budget_us) { tick_budget_us = budget_us; }
+
+    /**
+     * @brief Returns how many task runs were deferred to a later tick because the budget was used up.
+     * @return Number of deferrals, saturating.
+     */
+    uint16_t getDeferrals() const { return deferrals; }
+
+    uint16_t hyperperiod() const;
+    uint8_t tickLoad(const uint16_t tick) const;
+    uint8_t tickLoad(const LaneIndex lane, const uint16_t tick) const;
+    uint8_t subTickLoad(const uint8_t sub_tick, const uint16_t tick) const;
+    uint8_t subTickLoad(const LaneIndex lane, const uint8_t sub_tick, const uint16_t tick) const;
+    uint16_t worstTick() const;
+    bool firesAt(const LaneIndex lane, const uint8_t task_index, const uint16_t tick) const;
+
+    /**
+     * @brief Returns the number of sub-ticks since construction, including ones skipped because the scheduler was late.
+     * @details Only changes inside update(), so reading it needs no interrupt masking, unlike millis().
+     * @return Sub-ticks, wraps after 2^32.
+     */
+    uint32_t getTicks() const { return elapsed_ticks; }
 
-    uint8_t cycle_count = 0; /**< counts number of scheduler cycles since start, useful for other timers. */
+    /**
+     * @brief Returns the scheduler timebase in milliseconds, getTicks() * getTickUs() / 1000 without the division.
+     * @details Advances in whole sub-ticks, so it is the start time of the current tick, the same for every task in it.
+     * @return Milliseconds since construction, wraps after 2^32 like millis().
+     */
+    uint32_t nowMs() const { return now_ms; }
 
     /**
      * @brief Returns the period of the scheduler in microseconds.
@@ -69,6 +216,12 @@ public:
      */
     constexpr uint32_t getPeriodUs() const { return PERIOD_US; }
 
+    /**
+     * @brief Returns the sub-tick length, the fast lane period, in microseconds.
+     * @return The sub-tick length in microseconds, equal to getPeriodUs() if the period isn't split.
+     */
+    constexpr uint32_t getTickUs() const { return TICK_US; }
+
     /**
      * @brief Returns the number of cycles needed for a given interval in microseconds.
      * @param[in] interval_us The interval in microseconds.
@@ -76,16 +229,66 @@ public:
      */
     constexpr uint32_t cyclesNeeded(const uint32_t interval_us) const { return interval_us / PERIOD_US; }
 
+#if SCHEDULER_STATS
+    const TaskStats &getTaskStats(const LaneIndex lane, const uint8_t task_index) const;
+    const TickStats &getTickStats() const { return tick_stats; } /**< @brief Returns the tick statistics. @return Tick statistics. */
+    void resetStats();
+    uint16_t laneLoad(const TaskLane lane) const;
+    uint16_t cpuLoad() const;
+
+    /**
+     * @brief Returns the number of entries getStatsEntry() cycles through.
+     * @return 5 tick entries, plus one per task slot.
+     */
+    constexpr uint8_t statsEntries() const { return 5 + NUM_MCP2515 * NUM_TASKS; }
+    uint8_t getStatsEntry(const uint8_t entry, uint16_t (&values)[3]) const;
+#endif
+
 private:
+    static constexpr uint8_t FAST_SLOTS = NUM_FAST_TASKS ? NUM_FAST_TASKS : 1; /**< Fast lane array size, no zero-length arrays */
+
     TaskFn tasks[NUM_MCP2515][NUM_TASKS];          /**< Array of tasks, sorted by each MCP2515. */
     uint8_t task_ticks[NUM_MCP2515][NUM_TASKS];    /**< Period (in ticks) of each function, 1 is fire every tick, 0 is disabled. */
     uint8_t task_counters[NUM_MCP2515][NUM_TASKS]; /**< Counter to hold firing for n ticks, "how many ticks left before firing?". */
+    uint8_t task_phases[NUM_MCP2515][NUM_TASKS];   /**< Tick within the interval the task fires on, relative to tick_count. */
+    TaskPriority task_priorities[NUM_MCP2515][NUM_TASKS]; /**< Priority of each task, lower value runs first. */
+    uint8_t task_deferred[NUM_MCP2515][NUM_TASKS]; /**< Ticks the pending run has been deferred for, to keep the phase once it runs. */
+    uint8_t task_slots[NUM_MCP2515][NUM_TASKS];    /**< Sub-tick of the period each task runs in. */
     uint8_t task_cnt[NUM_MCP2515];                 /**< Array of number of tasks per MCP2515. */
-    const uint32_t PERIOD_US;                      /**< Period (tick length). */
-    const uint32_t SPIN_US;                        /**< Threshold to switch from letting non-scheduler task in loop() run, to spin-locking (to ensure on time firing). */
+    TaskFn fast_tasks[FAST_SLOTS];                 /**< Fast lane tasks, run at the start of every sub-tick. */
+    uint8_t fast_ticks[FAST_SLOTS];                /**< Period (in sub-ticks) of each fast lane task. */
+    uint8_t fast_counters[FAST_SLOTS];             /**< Sub-ticks left before each fast lane task fires. */
+    uint8_t fast_cnt;                              /**< Number of fast lane tasks. */
+    const uint32_t PERIOD_US;                      /**< Period (tick length) of the CAN lane. */
+    const uint8_t SUB_TICKS;                       /**< Sub-ticks per period, the fast lane runs every sub-tick. */
+    const uint32_t TICK_US;                        /**< Sub-tick length, PERIOD_US / SUB_TICKS, what update() times. */
+    const uint32_t SPIN_US;                        /**< Threshold to switch from letting non-scheduler task in loop() run, to spin-locking (to ensure on time firing), at most TICK_US. */
     uint32_t last_fire_us;                         /**< Last time scheduler fired, overridden if missed more than one period. */
+    uint32_t tick_count;                           /**< Ticks run since construction or synchronize(), reference for task phases. */
+    uint8_t sub_tick;                              /**< Next sub-tick to run, 0 to SUB_TICKS - 1. */
+    uint32_t elapsed_ticks;                        /**< Sub-ticks since construction, never reset, see getTicks(). */
+    uint32_t now_ms;                               /**< Timebase in milliseconds, see nowMs(). */
+    uint32_t ms_remainder_us;                      /**< Part of the timebase below one millisecond, in microseconds. */
+    uint32_t tick_budget_us;                       /**< CPU time per tick for non-Critical tasks, 0 for no limit. */
+    uint16_t deferrals;                            /**< Task runs deferred because the budget was used up. */
+    uint8_t worst_deferral;                        /**< Longest a single run was deferred, in ticks. */
+
+#if SCHEDULER_STATS
+    static constexpr uint16_t STATS_MAX = 0xFFFF; /**< Saturation value of the 16-bit stats */
+
+    TaskStats task_stats[NUM_MCP2515][NUM_TASKS]; /**< Execution time of each task slot, moved along with the task */
+    TickStats tick_stats;                         /**< Lateness and busy time of the ticks */
+    uint32_t period_idle_us;                      /**< Time spent in idle() during the current period */
+
+    static void recordTask(TaskStats &stats, const uint32_t run_us);
+    void recordTick(const uint32_t late_us, const uint32_t busy_us, const uint32_t fast_us);
+    void recordPeriod();
+#endif
 
-    inline void runTasks();
+    uint8_t autoPhase(const uint8_t mcp_idx, const uint8_t tick_interval) const;
+    uint8_t autoSlot(const uint8_t mcp_idx, const uint8_t tick_interval, const uint8_t phase) const;
+    inline void advanceTime(const uint32_t ticks);
+    inline void runTasks(unsigned long (*const current_time_us)(), const uint32_t late_us);
 };
 
 #include "Scheduler.tpp"
@@ -2,8 +2,8 @@
  * @file Scheduler.tpp
  * @author Planeson, Red Bird Racing
  * @brief Implementation of the Scheduler class template
- * @version 1.1
- * @date 2026-01-13
+ * @version 1.12
+ * @date 2026-10-17
  * @see Scheduler.hpp
  */
 
@@ -23,20 +23,44 @@ using TaskFn = void (*)(MCP2515 *);
  *
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
- * @param[in] period_us_ Period of the scheduler in microseconds
- * @param[in] spin_threshold_us_ Spin-wait threshold in microseconds
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] period_us_ Period of the scheduler (the CAN lane) in microseconds
+ * @param[in] spin_threshold_us_ Spin-wait threshold in microseconds, compared against the sub-tick, clamped to the sub-tick length
+ * @param[in] sub_ticks_ Sub-ticks per period, the fast lane rate, e.g. 10 for a 1ms fast lane with a 10ms period
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-Scheduler<NUM_TASKS, NUM_MCP2515>::Scheduler(uint32_t period_us_,
-                                             uint32_t spin_threshold_us_)
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::Scheduler(uint32_t period_us_,
+                                                             uint32_t spin_threshold_us_,
+                                                             uint8_t sub_ticks_)
     : tasks{nullptr},
       task_ticks{0},
       task_counters{0}, // run on first tick
+      task_phases{0},
+      task_priorities{},
+      task_deferred{0},
+      task_slots{0},
       task_cnt{0},
+      fast_tasks{nullptr},
+      fast_ticks{0},
+      fast_counters{0},
+      fast_cnt(0),
       PERIOD_US(period_us_),
-      SPIN_US(spin_threshold_us_),
-      last_fire_us(0)
+      SUB_TICKS(sub_ticks_ == 0 ? 1 : sub_ticks_),
+      TICK_US(period_us_ / (sub_ticks_ == 0 ? 1 : sub_ticks_)),
+      SPIN_US(spin_threshold_us_ < TICK_US ? spin_threshold_us_ : TICK_US), // TICK_US - SPIN_US must not wrap
+      last_fire_us(0),
+      tick_count(0),
+      sub_tick(0),
+      elapsed_ticks(0),
+      now_ms(0),
+      ms_remainder_us(0),
+      tick_budget_us(0),
+      deferrals(0),
+      worst_deferral(0)
 {
+#if SCHEDULER_STATS
+    resetStats();
+#endif
 }
 
 /**
@@ -44,58 +68,177 @@ Scheduler<NUM_TASKS, NUM_MCP2515>::Scheduler(uint32_t period_us_,
  *
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
  * @param[in] current_time_us Function pointer to a function returning the current time in microseconds
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-void Scheduler<NUM_TASKS, NUM_MCP2515>::update(unsigned long (*const current_time_us)())
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::update(unsigned long (*const current_time_us)())
 {
     if (current_time_us == nullptr)
         return;
 
     uint32_t delta = current_time_us() - last_fire_us;
-    if (delta >= PERIOD_US)
+    if (delta >= TICK_US)
     {
-        runTasks();
-        if (delta >= 2 * PERIOD_US)
+        // periods missed entirely are not run, but still count towards the timebase
+        const uint32_t missed = delta >= 2 * TICK_US ? delta / TICK_US - 1 : 0;
+        advanceTime(missed);
+        runTasks(current_time_us, delta - TICK_US);
+        if (missed != 0)
+        {
             // we missed more than one period, override last_fire_us to avoid bursts
             last_fire_us = current_time_us();
+#if SCHEDULER_STATS
+            const uint32_t skipped = tick_stats.skipped + missed;
+            tick_stats.skipped = skipped > STATS_MAX ? STATS_MAX : skipped;
+#endif
+        }
         else
-            last_fire_us += PERIOD_US;
+            last_fire_us += TICK_US;
 
         return;
     }
     // not time yet, check if we should spin-wait or return
-    if (delta >= PERIOD_US - SPIN_US)
+    if (delta >= TICK_US - SPIN_US)
     {
         // spin-wait
-        while ((uint32_t)(current_time_us() - last_fire_us) < PERIOD_US)
+        while ((delta = current_time_us() - last_fire_us) < TICK_US)
             ;
         // now it's time, run the tasks
-        runTasks();
-        last_fire_us += PERIOD_US;
+        runTasks(current_time_us, delta - TICK_US);
+        last_fire_us += TICK_US;
     }
     return;
 }
 
+/**
+ * @brief Run one tick now regardless of the period, for when another scheduler provides the tick, e.g. a StaticScheduler task
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] current_time_us Function pointer to a function returning the current time in microseconds, used for stats and budget
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::runTick(unsigned long (*const current_time_us)())
+{
+    if (current_time_us == nullptr)
+        return;
+
+    runTasks(current_time_us, 0);
+    last_fire_us = current_time_us();
+}
+
+#if SCHEDULER_TIMER_TICK
+/**
+ * @brief Start Timer1 to produce the scheduler tick, call at the end of setup()
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @return true if the timer was started, false if the period doesn't fit Timer1
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::beginTimerTick()
+{
+    return SchedulerTimer::begin(TICK_US);
+}
+
+/**
+ * @brief Run the tasks if Timer1 ticked since the last call, returns immediately otherwise
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] current_time_us Function pointer to a function returning the current time in microseconds, used for stats
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::updateTimerTick(unsigned long (*const current_time_us)())
+{
+    const uint8_t ticks = SchedulerTimer::takeTicks();
+    if (ticks == 0)
+        return;
+
+    // more than one tick pending means we missed periods, run once to avoid bursts
+    advanceTime(ticks - 1);
+#if SCHEDULER_STATS
+    const uint32_t skipped = tick_stats.skipped + ticks - 1;
+    tick_stats.skipped = skipped > STATS_MAX ? STATS_MAX : skipped;
+#endif
+    runTasks(current_time_us, (ticks - 1) * TICK_US + SchedulerTimer::sinceTickUs());
+    last_fire_us = current_time_us();
+}
+#endif
+
+/**
+ * @brief Wait for the next tick without burning the CPU, call once per loop() with nothing else left to do
+ * @details With SCHEDULER_TIMER_TICK, sleeps (SLEEP_MODE_IDLE) until the Timer1 tick is pending. Every other interrupt
+ * also wakes the CPU: the free-running ADC every ~104us, the Timer0 overflow of millis() every 1024us and the MCP2515 INT.
+ * Those only cost their ISR and a check of the tick flag before sleeping again, so loop() still runs once per tick.
+ * Otherwise, sleeps whenever the next Timer0 overflow (from TCNT0) will wake the CPU before the tick is due, so with
+ * the 1024us overflow and a 1ms tick most ticks sleep until the overflow, then spin-waits the rest,
+ * so the update() that follows runs it on time. Other interrupts only shorten a sleep, idle() sleeps again.
+ * With SCHEDULER_STATS, the time spent here is recorded as idle time for cpuLoad().
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] current_time_us Function pointer to a function returning the current time in microseconds
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::idle(unsigned long (*const current_time_us)())
+{
+    if (current_time_us == nullptr)
+        return;
+
+#if SCHEDULER_STATS
+    const uint32_t start_us = current_time_us();
+#endif
+#if SCHEDULER_TIMER_TICK
+    while (!SchedulerTimer::sleep())
+        ; // woken by another interrupt, the tick isn't due yet
+#else
+    uint32_t delta;
+    while ((delta = current_time_us() - last_fire_us) < TICK_US)
+    {
+        SchedulerTimer::sleepWithin(TICK_US - delta);
+    }
+#endif
+#if SCHEDULER_STATS
+    period_idle_us += current_time_us() - start_us;
+#endif
+}
+
 /**
  * @brief Synchonize the scheduler to the current time, resetting all task counters, used when starting multiple Schedulers across different boards together
  * 
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
  * @param[in] current_time_us Function pointer to a function returning the current time in microseconds
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-void Scheduler<NUM_TASKS, NUM_MCP2515>::synchronize(unsigned long (*const current_time_us)())
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::synchronize(unsigned long (*const current_time_us)())
 {
     if (current_time_us == nullptr)
         return;
 
     last_fire_us = current_time_us();
+#if SCHEDULER_TIMER_TICK
+    SchedulerTimer::restart();
+#endif
+    tick_count = 0;
+    sub_tick = 0;
+    for (uint8_t fast_index = 0; fast_index < fast_cnt; ++fast_index)
+    {
+        fast_counters[fast_index] = 1;
+    }
     for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
     {
-        for (uint8_t task_index = 0; task_index < NUM_TASKS; ++task_index)
+        for (uint8_t task_index = 0; task_index < task_cnt[mcp_index]; ++task_index)
         {
-            task_counters[mcp_index][task_index] = task_ticks[mcp_index][task_index];
+            // phase n fires on the (n + 1)th tick from now
+            task_counters[mcp_index][task_index] = task_phases[mcp_index][task_index] + 1;
         }
     }
 }
@@ -105,25 +248,43 @@ void Scheduler<NUM_TASKS, NUM_MCP2515>::synchronize(unsigned long (*const curren
  *
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
- * @param[in] mcp_index Index of the MCP2515 instance
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
  * @param[in] task Function pointer to the task to be added
  * @param[in] tick_interval Number of ticks between task executions, so 1 for every tick, 10 for every 10 ticks
+ * @param[in] priority Priority of the task, Critical tasks run first and are never deferred
+ * @param[in] phase Tick within the interval to fire on (0 to tick_interval - 1), or AUTO_PHASE to pick the least loaded one
  * @return true if the task was added successfully, false otherwise
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-bool Scheduler<NUM_TASKS, NUM_MCP2515>::addTask(const McpIndex mcp_index, const TaskFn task, const uint8_t tick_interval)
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::addTask(const LaneIndex lane, const TaskFn task, const uint8_t tick_interval,
+                                                const TaskPriority priority, const uint8_t phase)
 {
-    uint8_t mcp_idx = static_cast<uint8_t>(mcp_index);
-    if (mcp_idx >= NUM_MCP2515 || task == nullptr)
+    if (lane >= NUM_MCP2515 || task == nullptr)
         return false;
 
-    if (task_cnt[mcp_idx] >= NUM_TASKS)
+    if (task_cnt[lane] >= NUM_TASKS)
         return false; // no space
 
-    tasks[mcp_idx][task_cnt[mcp_idx]] = task;
-    task_ticks[mcp_idx][task_cnt[mcp_idx]] = tick_interval;
-    task_counters[mcp_idx][task_cnt[mcp_idx]] = 1; // run on first tick
-    ++task_cnt[mcp_idx];
+    if (phase != AUTO_PHASE && tick_interval != 0 && phase >= tick_interval)
+        return false; // phase outside interval
+
+    const uint8_t task_phase = tick_interval <= 1 ? 0 : (phase == AUTO_PHASE ? autoPhase(lane, tick_interval) : phase);
+    const uint8_t task_slot = autoSlot(lane, tick_interval, task_phase);
+    // the slot may already be behind us in the current period, then the first chance to run is next period
+    const uint32_t next_tick = tick_count + (task_slot < sub_tick ? 1 : 0);
+    tasks[lane][task_cnt[lane]] = task;
+    task_ticks[lane][task_cnt[lane]] = tick_interval;
+    task_phases[lane][task_cnt[lane]] = task_phase;
+    task_priorities[lane][task_cnt[lane]] = priority;
+    task_deferred[lane][task_cnt[lane]] = 0;
+    task_slots[lane][task_cnt[lane]] = task_slot;
+    // ticks until the next tick_count with tick_count % tick_interval == task_phase, 1 is the coming tick
+    task_counters[lane][task_cnt[lane]] = tick_interval <= 1 ? 1 : (task_phase + tick_interval - next_tick % tick_interval) % tick_interval + 1;
+#if SCHEDULER_STATS
+    task_stats[lane][task_cnt[lane]] = TaskStats{};
+#endif
+    ++task_cnt[lane];
     return true;
 }
 
@@ -132,35 +293,49 @@ bool Scheduler<NUM_TASKS, NUM_MCP2515>::addTask(const McpIndex mcp_index, const
  *
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
- * @param[in] mcp_index Index of the MCP2515 instance
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
  * @param[in] task Function pointer to the task to be removed
  * @return true if the task was removed successfully, false otherwise
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-bool Scheduler<NUM_TASKS, NUM_MCP2515>::removeTask(const McpIndex mcp_index, const TaskFn task)
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::removeTask(const LaneIndex lane, const TaskFn task)
 {
-    uint8_t mcp_idx = static_cast<uint8_t>(mcp_index);
-    if (mcp_idx >= NUM_MCP2515 || task == nullptr)
+    if (lane >= NUM_MCP2515 || task == nullptr)
         return false;
 
-    for (uint8_t i = 0; i < task_cnt[mcp_idx]; ++i)
+    for (uint8_t i = 0; i < task_cnt[lane]; ++i)
     {
-        if (tasks[mcp_idx][i] == task)
+        if (tasks[lane][i] == task)
         {
             // shift left remaining tasks
-            for (uint8_t j = i; j < task_cnt[mcp_idx] - 1; ++j)
+            for (uint8_t j = i; j < task_cnt[lane] - 1; ++j)
             {
-                tasks[mcp_idx][j] = tasks[mcp_idx][j + 1];
-                task_ticks[mcp_idx][j] = task_ticks[mcp_idx][j + 1];
-                task_counters[mcp_idx][j] = task_counters[mcp_idx][j + 1];
+                tasks[lane][j] = tasks[lane][j + 1];
+                task_ticks[lane][j] = task_ticks[lane][j + 1];
+                task_counters[lane][j] = task_counters[lane][j + 1];
+                task_phases[lane][j] = task_phases[lane][j + 1];
+                task_priorities[lane][j] = task_priorities[lane][j + 1];
+                task_deferred[lane][j] = task_deferred[lane][j + 1];
+                task_slots[lane][j] = task_slots[lane][j + 1];
+#if SCHEDULER_STATS
+                task_stats[lane][j] = task_stats[lane][j + 1];
+#endif
             }
 
             // clean last slot
-            tasks[mcp_idx][task_cnt[mcp_idx] - 1] = nullptr;
-            task_ticks[mcp_idx][task_cnt[mcp_idx] - 1] = 0;
-            task_counters[mcp_idx][task_cnt[mcp_idx] - 1] = 0;
+            tasks[lane][task_cnt[lane] - 1] = nullptr;
+            task_ticks[lane][task_cnt[lane] - 1] = 0;
+            task_counters[lane][task_cnt[lane] - 1] = 0;
+            task_phases[lane][task_cnt[lane] - 1] = 0;
+            task_priorities[lane][task_cnt[lane] - 1] = TaskPriority::Critical;
+            task_deferred[lane][task_cnt[lane] - 1] = 0;
+            task_slots[lane][task_cnt[lane] - 1] = 0;
+#if SCHEDULER_STATS
+            task_stats[lane][task_cnt[lane] - 1] = TaskStats{};
+#endif
 
-            --task_cnt[mcp_idx];
+            --task_cnt[lane];
             return true;
         }
     }
@@ -168,36 +343,717 @@ bool Scheduler<NUM_TASKS, NUM_MCP2515>::removeTask(const McpIndex mcp_index, con
 }
 
 /**
- * @brief Helper function to run scheduled tasks
+ * @brief Add a task to the fast lane, run at the start of every sub-tick, before the CAN lane
+ * Fast lane tasks are always run, the tick budget doesn't apply to them.
  *
  * @tparam NUM_TASKS Number of tasks per MCP2515
  * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] task Function pointer to the task to be added
+ * @param[in] sub_tick_interval Number of sub-ticks between task executions, so 1 for every sub-tick
+ * @return true if the task was added successfully, false otherwise
  */
-template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515>
-inline void Scheduler<NUM_TASKS, NUM_MCP2515>::runTasks()
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::addFastTask(const TaskFn task, const uint8_t sub_tick_interval)
 {
+    if (task == nullptr || sub_tick_interval == 0)
+        return false;
+
+    if (fast_cnt >= NUM_FAST_TASKS)
+        return false; // no space
+
+    fast_tasks[fast_cnt] = task;
+    fast_ticks[fast_cnt] = sub_tick_interval;
+    fast_counters[fast_cnt] = 1; // run on the coming sub-tick
+    ++fast_cnt;
+    return true;
+}
 
-    for (uint8_t task_index = 0; task_index < NUM_TASKS; ++task_index)
+/**
+ * @brief Remove a task from the fast lane
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] task Function pointer to the task to be removed
+ * @return true if the task was removed successfully, false otherwise
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::removeFastTask(const TaskFn task)
+{
+    if (task == nullptr)
+        return false;
+
+    for (uint8_t i = 0; i < fast_cnt; ++i)
     {
-        for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+        if (fast_tasks[i] == task)
         {
-            if (task_counters[mcp_index][task_index] == 0)
-                continue; // task slot empty
-
-            if (task_counters[mcp_index][task_index] == 1)
+            // shift left remaining tasks
+            for (uint8_t j = i; j + 1 < fast_cnt; ++j)
             {
-                if (tasks[mcp_index][task_index] == nullptr)
-                    continue; // no task to run
+                fast_tasks[j] = fast_tasks[j + 1];
+                fast_ticks[j] = fast_ticks[j + 1];
+                fast_counters[j] = fast_counters[j + 1];
+            }
 
-                // call functions
-                (tasks[mcp_index][task_index])();
+            // clean last slot
+            fast_tasks[fast_cnt - 1] = nullptr;
+            fast_ticks[fast_cnt - 1] = 0;
+            fast_counters[fast_cnt - 1] = 0;
 
-                // reset counter
-                task_counters[mcp_index][task_index] = task_ticks[mcp_index][task_index];
+            --fast_cnt;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the hyperperiod of the current task set, the LCM of all tick intervals
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @return Hyperperiod in ticks, capped at MAX_HYPERPERIOD
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint16_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::hyperperiod() const
+{
+    uint16_t lcm = 1;
+    for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+    {
+        for (uint8_t task_index = 0; task_index < task_cnt[mcp_index]; ++task_index)
+        {
+            const uint16_t interval = task_ticks[mcp_index][task_index];
+            if (interval <= 1)
                 continue;
+            // lcm(a, b) = a / gcd(a, b) * b
+            uint16_t a = lcm, b = interval;
+            while (b != 0)
+            {
+                const uint16_t r = a % b;
+                a = b;
+                b = r;
             }
-            // not time yet, decrement counter
-            --task_counters[mcp_index][task_index];
+            const uint32_t next = static_cast<uint32_t>(lcm / a) * interval;
+            if (next > MAX_HYPERPERIOD)
+                return MAX_HYPERPERIOD;
+            lcm = next;
         }
     }
-}
\ No newline at end of file
+    return lcm;
+}
+
+/**
+ * @brief Checks whether a task slot fires on a given tick
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
+ * @param[in] task_index Task slot, in the order tasks were added
+ * @param[in] tick Tick number, counted from construction or synchronize()
+ * @return true if the slot holds a task that fires on that tick
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+bool Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::firesAt(const LaneIndex lane, const uint8_t task_index, const uint16_t tick) const
+{
+    if (lane >= NUM_MCP2515 || task_index >= task_cnt[lane])
+        return false;
+    const uint8_t interval = task_ticks[lane][task_index];
+    if (interval == 0)
+        return false; // disabled
+    return tick % interval == task_phases[lane][task_index];
+}
+
+/**
+ * @brief Returns the number of tasks firing on a given tick
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] tick Tick number, counted from construction or synchronize()
+ * @return Number of tasks, over all MCP2515
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::tickLoad(const uint16_t tick) const
+{
+    uint8_t load = 0;
+    for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+        load += tickLoad(mcp_index, tick);
+    return load;
+}
+
+/**
+ * @brief Returns the number of tasks of one MCP2515 firing on a given tick
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
+ * @param[in] tick Tick number, counted from construction or synchronize()
+ * @return Number of tasks, 0 for an invalid index
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::tickLoad(const LaneIndex lane, const uint16_t tick) const
+{
+    if (lane >= NUM_MCP2515)
+        return 0;
+    uint8_t load = 0;
+    for (uint8_t task_index = 0; task_index < task_cnt[lane]; ++task_index)
+    {
+        if (firesAt(lane, task_index, tick))
+            ++load;
+    }
+    return load;
+}
+
+/**
+ * @brief Returns the busiest tick of the hyperperiod, use firesAt() to list which tasks run in it
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @return First tick (0 to hyperperiod() - 1) with the most tasks firing
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint16_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::worstTick() const
+{
+    const uint16_t period = hyperperiod();
+    uint16_t worst = 0;
+    uint8_t worst_load = 0;
+    for (uint16_t tick = 0; tick < period; ++tick)
+    {
+        const uint8_t load = tickLoad(tick);
+        if (load > worst_load)
+        {
+            worst_load = load;
+            worst = tick;
+        }
+    }
+    return worst;
+}
+
+/**
+ * @brief Picks the phase for a new task that minimises the busiest tick it joins on its own MCP2515
+ * Ties are broken by the busiest tick over all MCP2515, then by the total load of the ticks it joins, then by the lowest phase.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] mcp_idx Index of the MCP2515 instance the task is added to
+ * @param[in] tick_interval Interval of the new task, at least 2
+ * @return Phase, 0 to tick_interval - 1
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::autoPhase(const uint8_t mcp_idx, const uint8_t tick_interval) const
+{
+    // hyperperiod including the new task
+    uint16_t a = hyperperiod(), b = tick_interval;
+    while (b != 0)
+    {
+        const uint16_t r = a % b;
+        a = b;
+        b = r;
+    }
+    const uint32_t lcm = static_cast<uint32_t>(hyperperiod() / a) * tick_interval;
+    const uint16_t period = lcm > MAX_HYPERPERIOD ? MAX_HYPERPERIOD : lcm;
+
+    uint8_t best_phase = 0;
+    uint8_t best_lane_max = 0xFF;
+    uint8_t best_max = 0xFF;
+    uint16_t best_sum = 0xFFFF;
+    for (uint8_t phase = 0; phase < tick_interval; ++phase)
+    {
+        uint8_t lane_max_load = 0;
+        uint8_t max_load = 0;
+        uint16_t sum_load = 0;
+        for (uint16_t tick = phase; tick < period; tick += tick_interval)
+        {
+            const uint8_t lane_load = tickLoad(mcp_idx, tick);
+            if (lane_load > lane_max_load)
+                lane_max_load = lane_load;
+            const uint8_t load = tickLoad(tick);
+            if (load > max_load)
+                max_load = load;
+            sum_load += load;
+        }
+        if (lane_max_load < best_lane_max ||
+            (lane_max_load == best_lane_max && (max_load < best_max || (max_load == best_max && sum_load < best_sum))))
+        {
+            best_lane_max = lane_max_load;
+            best_max = max_load;
+            best_sum = sum_load;
+            best_phase = phase;
+        }
+    }
+    return best_phase;
+}
+
+/**
+ * @brief Returns the number of CAN lane tasks firing in a given sub-tick of a given tick
+ * Over sub-ticks 0 to SUB_TICKS - 1 and ticks 0 to hyperperiod() - 1, this is the table autoSlot() balances.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] sub_tick Sub-tick within the period
+ * @param[in] tick Tick number, counted from construction or synchronize()
+ * @return Number of tasks, over all MCP2515
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::subTickLoad(const uint8_t sub_tick, const uint16_t tick) const
+{
+    uint8_t load = 0;
+    for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+        load += subTickLoad(mcp_index, sub_tick, tick);
+    return load;
+}
+
+/**
+ * @brief Returns the number of CAN lane tasks of one MCP2515 firing in a given sub-tick of a given tick
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
+ * @param[in] sub_tick Sub-tick within the period
+ * @param[in] tick Tick number, counted from construction or synchronize()
+ * @return Number of tasks, 0 for an invalid index
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::subTickLoad(const LaneIndex lane, const uint8_t sub_tick, const uint16_t tick) const
+{
+    if (lane >= NUM_MCP2515)
+        return 0;
+    uint8_t load = 0;
+    for (uint8_t task_index = 0; task_index < task_cnt[lane]; ++task_index)
+    {
+        if (task_slots[lane][task_index] == sub_tick && firesAt(lane, task_index, tick))
+            ++load;
+    }
+    return load;
+}
+
+/**
+ * @brief Picks the sub-tick for a new CAN lane task that minimises the busiest sub-tick it joins on its own MCP2515
+ * Ties are broken by the busiest sub-tick over all MCP2515, then by the total load of the sub-ticks it joins, then by the lowest sub-tick.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] mcp_idx Index of the MCP2515 instance the task is added to
+ * @param[in] tick_interval Interval of the new task
+ * @param[in] phase Phase of the new task
+ * @return Sub-tick, 0 to SUB_TICKS - 1
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::autoSlot(const uint8_t mcp_idx, const uint8_t tick_interval, const uint8_t phase) const
+{
+    if (SUB_TICKS <= 1)
+        return 0;
+
+    // hyperperiod including the new task
+    const uint8_t interval = tick_interval == 0 ? 1 : tick_interval;
+    uint16_t a = hyperperiod(), b = interval;
+    while (b != 0)
+    {
+        const uint16_t r = a % b;
+        a = b;
+        b = r;
+    }
+    const uint32_t lcm = static_cast<uint32_t>(hyperperiod() / a) * interval;
+    const uint16_t period = lcm > MAX_HYPERPERIOD ? MAX_HYPERPERIOD : lcm;
+
+    uint8_t best_slot = 0;
+    uint8_t best_lane_max = 0xFF;
+    uint8_t best_max = 0xFF;
+    uint16_t best_sum = 0xFFFF;
+    for (uint8_t slot = 0; slot < SUB_TICKS; ++slot)
+    {
+        uint8_t lane_max_load = 0;
+        uint8_t max_load = 0;
+        uint16_t sum_load = 0;
+        for (uint16_t tick = phase; tick < period; tick += interval)
+        {
+            const uint8_t lane_load = subTickLoad(mcp_idx, slot, tick);
+            if (lane_load > lane_max_load)
+                lane_max_load = lane_load;
+            const uint8_t load = subTickLoad(slot, tick);
+            if (load > max_load)
+                max_load = load;
+            sum_load += load;
+        }
+        if (lane_max_load < best_lane_max ||
+            (lane_max_load == best_lane_max && (max_load < best_max || (max_load == best_max && sum_load < best_sum))))
+        {
+            best_lane_max = lane_max_load;
+            best_max = max_load;
+            best_sum = sum_load;
+            best_slot = slot;
+        }
+    }
+    return best_slot;
+}
+
+/**
+ * @brief Helper function to run scheduled tasks, one sub-tick at a time
+ * Runs the due fast lane tasks, then the due CAN lane tasks assigned to this sub-tick, in priority order.
+ * Once the tick budget is used up, due non-Critical tasks are deferred: their counter stays at 1 so they are due again
+ * next period, and once run, their next run keeps the original phase.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] current_time_us Function pointer to a function returning the current time in microseconds, used for stats and the budget
+ * @param[in] late_us How late this tick started, in microseconds, used for stats
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+inline void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::runTasks(unsigned long (*const current_time_us)(), const uint32_t late_us)
+{
+#if !SCHEDULER_STATS
+    (void)late_us;
+#endif
+    const bool timed = SCHEDULER_STATS || tick_budget_us != 0;
+    const uint32_t start_us = timed ? current_time_us() : 0;
+    uint32_t mark_us = start_us; // end of the last timed task
+
+    advanceTime(1);
+    for (uint8_t fast_index = 0; fast_index < fast_cnt; ++fast_index)
+    {
+        if (fast_counters[fast_index] > 1)
+        {
+            --fast_counters[fast_index];
+            continue;
+        }
+        (fast_tasks[fast_index])();
+        fast_counters[fast_index] = fast_ticks[fast_index];
+    }
+    if (timed && fast_cnt != 0)
+        mark_us = current_time_us();
+#if SCHEDULER_STATS
+    const uint32_t fast_us = mark_us - start_us;
+#endif
+
+    for (uint8_t priority = 0; priority < PRIORITY_LEVELS; ++priority)
+    {
+        for (uint8_t task_index = 0; task_index < NUM_TASKS; ++task_index)
+        {
+            for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+            {
+                if (task_counters[mcp_index][task_index] == 0)
+                    continue; // task slot empty
+
+                if (task_slots[mcp_index][task_index] != sub_tick)
+                    continue; // runs in another sub-tick
+
+                if (static_cast<uint8_t>(task_priorities[mcp_index][task_index]) != priority)
+                    continue; // runs in another pass
+
+                if (task_counters[mcp_index][task_index] == 1)
+                {
+                    if (tasks[mcp_index][task_index] == nullptr)
+                        continue; // no task to run
+
+                    if (priority != static_cast<uint8_t>(TaskPriority::Critical) && tick_budget_us != 0 && mark_us - start_us >= tick_budget_us)
+                    {
+                        // budget used up, stay due for next tick
+                        if (task_deferred[mcp_index][task_index] < 0xFF)
+                            ++task_deferred[mcp_index][task_index];
+                        if (task_deferred[mcp_index][task_index] > worst_deferral)
+                            worst_deferral = task_deferred[mcp_index][task_index];
+                        if (deferrals < 0xFFFF)
+                            ++deferrals;
+                        continue;
+                    }
+
+                    // call functions
+                    (tasks[mcp_index][task_index])();
+                    if (timed)
+                    {
+                        const uint32_t done_us = current_time_us();
+#if SCHEDULER_STATS
+                        recordTask(task_stats[mcp_index][task_index], done_us - mark_us);
+#endif
+                        mark_us = done_us;
+                    }
+
+                    // reset counter, minus the ticks it was deferred for to keep the phase
+                    uint8_t next = task_ticks[mcp_index][task_index];
+                    const uint8_t deferred = task_deferred[mcp_index][task_index];
+                    if (next > 1)
+                        next = deferred < next ? next - deferred : 1;
+                    task_counters[mcp_index][task_index] = next;
+                    task_deferred[mcp_index][task_index] = 0;
+                    continue;
+                }
+                // not time yet, decrement counter
+                --task_counters[mcp_index][task_index];
+            }
+        }
+    }
+    if (++sub_tick >= SUB_TICKS)
+    {
+        sub_tick = 0;
+        ++tick_count;
+#if SCHEDULER_STATS
+        recordPeriod();
+#endif
+    }
+#if SCHEDULER_STATS
+    recordTick(late_us, mark_us - start_us, fast_us);
+#endif
+}
+
+/**
+ * @brief Moves the timebase forward, without any division so it stays cheap every sub-tick
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] ticks Sub-ticks elapsed
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+inline void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::advanceTime(const uint32_t ticks)
+{
+    for (uint32_t i = 0; i < ticks; ++i)
+    {
+        ++elapsed_ticks;
+        ms_remainder_us += TICK_US;
+        while (ms_remainder_us >= 1000)
+        {
+            ms_remainder_us -= 1000;
+            ++now_ms;
+        }
+    }
+}
+
+#if SCHEDULER_STATS
+/**
+ * @brief Returns the execution time statistics of a task slot.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane of the MCP2515 instance, see CanChannelMap::lane()
+ * @param[in] task_index Task slot, in the order tasks were added
+ * @return Statistics of the slot, all zero if out of range
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+const typename Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::TaskStats &Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::getTaskStats(const LaneIndex lane, const uint8_t task_index) const
+{
+    static const TaskStats none{};
+    if (lane >= NUM_MCP2515 || task_index >= NUM_TASKS)
+        return none;
+    return task_stats[lane][task_index];
+}
+
+/**
+ * @brief Clears all task and tick statistics, e.g. after setup() so start-up isn't counted.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::resetStats()
+{
+    for (uint8_t mcp_index = 0; mcp_index < NUM_MCP2515; ++mcp_index)
+    {
+        for (uint8_t task_index = 0; task_index < NUM_TASKS; ++task_index)
+        {
+            task_stats[mcp_index][task_index] = TaskStats{};
+        }
+    }
+    tick_stats = TickStats{};
+    period_idle_us = 0;
+    deferrals = 0;
+    worst_deferral = 0;
+}
+
+/**
+ * @brief Returns the share of CPU time a lane used, averaged over the recorded sub-ticks.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] lane Lane to report
+ * @return Load in permille of the sub-tick length, 0 if nothing recorded yet
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint16_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::laneLoad(const TaskLane lane) const
+{
+    const uint32_t elapsed_ms = static_cast<uint32_t>(tick_stats.ticks) * TICK_US / 1000;
+    if (elapsed_ms == 0)
+        return 0;
+    const uint32_t busy_us = lane == TaskLane::Fast ? tick_stats.total_fast_us : tick_stats.total_busy_us - tick_stats.total_fast_us;
+    // permille = busy_us * 1000 / elapsed_us = busy_us / elapsed_ms
+    const uint32_t load = busy_us / elapsed_ms;
+    return load > STATS_MAX ? STATS_MAX : load;
+}
+
+/**
+ * @brief Returns the CPU load, the share of time spent outside idle(), averaged over the recorded periods.
+ * @details Only meaningful if loop() calls idle(), otherwise all time counts as busy.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @return Load in permille, 0 if nothing recorded yet
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint16_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::cpuLoad() const
+{
+    const uint32_t elapsed_ms = static_cast<uint32_t>(tick_stats.ticks) * TICK_US / 1000;
+    if (elapsed_ms == 0)
+        return 0;
+    const uint32_t idle = tick_stats.total_idle_us / elapsed_ms; // permille
+    return idle >= 1000 ? 0 : 1000 - idle;
+}
+
+/**
+ * @brief Packs one statistics entry into three 16-bit values, for sending one entry at a time.
+ * @details Entries are, in order:
+ * - STATS_MUX_TICK_TIMING: worst lateness, average lateness, worst busy time (us)
+ * - STATS_MUX_TICK_COUNTERS: overruns, skipped sub-ticks, average busy time (us)
+ * - STATS_MUX_BUDGET: deferrals, tick budget (us), longest deferral (ticks)
+ * - STATS_MUX_LANES: fast lane load, CAN lane load (permille), sub-ticks per period
+ * - STATS_MUX_LOAD: average CPU load, worst period CPU load, last period CPU load (permille)
+ * - one per task slot, mux (lane << 4) | task_index, the lane not the McpIndex: worst run time (us), average run time (us), runs
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] entry Entry number, wrapped to statsEntries()
+ * @param[out] values The three values of the entry
+ * @return Mux byte identifying the entry
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+uint8_t Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::getStatsEntry(const uint8_t entry, uint16_t (&values)[3]) const
+{
+    const uint8_t index = entry % statsEntries();
+    if (index == 0)
+    {
+        values[0] = tick_stats.worst_late_us;
+        values[1] = tick_stats.avgLateUs();
+        values[2] = tick_stats.worst_busy_us;
+        return STATS_MUX_TICK_TIMING;
+    }
+    if (index == 1)
+    {
+        values[0] = tick_stats.overruns;
+        values[1] = tick_stats.skipped;
+        values[2] = tick_stats.avgBusyUs();
+        return STATS_MUX_TICK_COUNTERS;
+    }
+    if (index == 2)
+    {
+        values[0] = deferrals;
+        values[1] = tick_budget_us > STATS_MAX ? STATS_MAX : tick_budget_us;
+        values[2] = worst_deferral;
+        return STATS_MUX_BUDGET;
+    }
+    if (index == 3)
+    {
+        values[0] = laneLoad(TaskLane::Fast);
+        values[1] = laneLoad(TaskLane::Can);
+        values[2] = SUB_TICKS;
+        return STATS_MUX_LANES;
+    }
+    if (index == 4)
+    {
+        values[0] = cpuLoad();
+        values[1] = tick_stats.worst_load;
+        values[2] = tick_stats.last_load;
+        return STATS_MUX_LOAD;
+    }
+    const LaneIndex lane = (index - 5) / NUM_TASKS;
+    const uint8_t task_index = (index - 5) % NUM_TASKS;
+    const TaskStats &stats = task_stats[lane][task_index];
+    values[0] = stats.worst_us;
+    values[1] = stats.avgUs();
+    values[2] = stats.runs;
+    return static_cast<uint8_t>((lane << 4) | task_index);
+}
+
+/**
+ * @brief Adds one task run to its statistics.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in,out] stats Statistics of the task slot
+ * @param[in] run_us Run time in microseconds
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::recordTask(TaskStats &stats, const uint32_t run_us)
+{
+    const uint16_t run = run_us > STATS_MAX ? STATS_MAX : run_us;
+    if (run > stats.worst_us)
+        stats.worst_us = run;
+    if (stats.runs == STATS_MAX)
+    {
+        // keep the average, drop half the history
+        stats.runs /= 2;
+        stats.total_us /= 2;
+    }
+    ++stats.runs;
+    stats.total_us += run;
+}
+
+/**
+ * @brief Adds one tick to the tick statistics.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ * @param[in] late_us How late the tick started, in microseconds
+ * @param[in] busy_us Time spent running tasks, in microseconds
+ * @param[in] fast_us Part of busy_us spent in the fast lane, in microseconds
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::recordTick(const uint32_t late_us, const uint32_t busy_us, const uint32_t fast_us)
+{
+    const uint16_t late = late_us > STATS_MAX ? STATS_MAX : late_us;
+    const uint16_t busy = busy_us > STATS_MAX ? STATS_MAX : busy_us;
+    if (late > tick_stats.worst_late_us)
+        tick_stats.worst_late_us = late;
+    if (busy > tick_stats.worst_busy_us)
+        tick_stats.worst_busy_us = busy;
+    if (late_us + busy_us >= TICK_US && tick_stats.overruns < STATS_MAX)
+        ++tick_stats.overruns;
+    if (tick_stats.ticks == STATS_MAX)
+    {
+        // keep the averages, drop half the history
+        tick_stats.ticks /= 2;
+        tick_stats.total_late_us /= 2;
+        tick_stats.total_busy_us /= 2;
+        tick_stats.total_fast_us /= 2;
+        tick_stats.total_idle_us /= 2;
+    }
+    ++tick_stats.ticks;
+    tick_stats.total_late_us += late;
+    tick_stats.total_busy_us += busy;
+    tick_stats.total_fast_us += fast_us < busy ? fast_us : busy;
+}
+
+/**
+ * @brief Closes the CPU load of the period that just ended, from the time spent in idle() during it.
+ *
+ * @tparam NUM_TASKS Number of tasks per MCP2515
+ * @tparam NUM_MCP2515 Number of MCP2515 instances
+ * @tparam NUM_FAST_TASKS Number of fast lane tasks
+ */
+template <uint8_t NUM_TASKS, uint8_t NUM_MCP2515, uint8_t NUM_FAST_TASKS>
+void Scheduler<NUM_TASKS, NUM_MCP2515, NUM_FAST_TASKS>::recordPeriod()
+{
+    const uint32_t idle_us = period_idle_us < PERIOD_US ? period_idle_us : PERIOD_US;
+    const uint32_t period_ms = PERIOD_US >= 1000 ? PERIOD_US / 1000 : 1;
+    const uint32_t load = (PERIOD_US - idle_us) / period_ms; // permille
+    period_idle_us = 0;
+    tick_stats.last_load = load > 1000 ? 1000 : load;
+    if (tick_stats.last_load > tick_stats.worst_load)
+        tick_stats.worst_load = tick_stats.last_load;
+    tick_stats.total_idle_us += idle_us;
+}
+#endif
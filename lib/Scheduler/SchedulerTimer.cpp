@@ -0,0 +1,222 @@
+/**
+ * @file SchedulerTimer.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Implementation of the SchedulerTimer namespace
+ * @version 1.3
+ * @date 2026-10-17
+ * @see SchedulerTimer.hpp
+ */
+
+#include "SchedulerTimer.hpp"
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+namespace
+{
+    volatile uint8_t pending_ticks = 0; /**< Ticks counted by the ISR, not yet taken by the Scheduler */
+    uint8_t count_shift = 0;            /**< log2 of the Timer1 prescaler, to convert TCNT1 to time */
+} // namespace
+
+/**
+ * @brief Timer1 compare-match A, one Scheduler tick.
+ */
+ISR(TIMER1_COMPA_vect)
+{
+    if (pending_ticks < 0xFF)
+        ++pending_ticks;
+}
+
+/**
+ * @brief Starts Timer1 in CTC mode, firing every period_us.
+ * Picks the smallest prescaler that fits the period into 16 bits, for the finest resolution.
+ * @param period_us Tick period in microseconds.
+ * @return true if started, false if the period doesn't fit Timer1 even with the largest prescaler.
+ */
+bool SchedulerTimer::begin(uint32_t period_us)
+{
+    constexpr uint8_t SHIFTS[5] = {0, 3, 6, 8, 10};                                            // prescaler 1, 8, 64, 256, 1024
+    constexpr uint8_t CLOCK_SELECT[5] = {_BV(CS10), _BV(CS11), _BV(CS11) | _BV(CS10), _BV(CS12), _BV(CS12) | _BV(CS10)};
+    constexpr uint32_t COUNTS_PER_US = F_CPU / 1000000UL;
+
+    for (uint8_t i = 0; i < 5; ++i)
+    {
+        const uint32_t counts = (period_us * COUNTS_PER_US) >> SHIFTS[i];
+        if (counts == 0 || counts > 0x10000UL)
+            continue;
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            count_shift = SHIFTS[i];
+            TCCR1A = 0;
+            TCCR1B = _BV(WGM12) | CLOCK_SELECT[i]; // CTC, TOP = OCR1A
+            OCR1A = counts - 1;
+            TCNT1 = 0;
+            TIFR1 = _BV(OCF1A);
+            TIMSK1 |= _BV(OCIE1A);
+            pending_ticks = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Restarts the current period from now and drops pending ticks, e.g. when synchronizing boards.
+ */
+void SchedulerTimer::restart()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        TCNT1 = 0;
+        TIFR1 = _BV(OCF1A);
+        pending_ticks = 0;
+    }
+}
+
+/**
+ * @brief Takes the ticks counted since the last call.
+ * @return Number of ticks, more than 1 means periods were missed.
+ */
+uint8_t SchedulerTimer::takeTicks()
+{
+    uint8_t ticks;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        ticks = pending_ticks;
+        pending_ticks = 0;
+    }
+    return ticks;
+}
+
+/**
+ * @brief Returns the time since the last tick, from the Timer1 counter.
+ * @return Microseconds since the last compare match.
+ */
+uint32_t SchedulerTimer::sinceTickUs()
+{
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        count = TCNT1;
+    }
+    return (static_cast<uint32_t>(count) << count_shift) / (F_CPU / 1000000UL);
+}
+
+/**
+ * @brief Sleeps in SLEEP_MODE_IDLE until the next interrupt, unless a Timer1 tick is already pending.
+ * @details The pending check and sleep_cpu() are done with interrupts disabled up to the instruction before sleeping
+ * (sei takes effect after the next instruction), so a tick arriving in between can't be slept through.
+ * @return true if a tick is pending, i.e. there is no need to sleep again.
+ */
+bool SchedulerTimer::sleep()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    if (pending_ticks == 0)
+    {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    sei();
+    return pending_ticks != 0;
+}
+
+/**
+ * @brief Sleeps in SLEEP_MODE_IDLE until the next interrupt, if the Timer0 (millis()) overflow is sure to wake the CPU within within_us.
+ * @details For waiting without Timer1: the time to the overflow is read from TCNT0 with interrupts disabled up to the
+ * instruction before sleeping, so an overflow in between can't be slept through. Any other interrupt wakes it sooner.
+ * @param within_us Time the CPU must be awake by, in microseconds.
+ * @return true if it slept, false if the overflow is too far away (or already pending) and the caller should spin instead.
+ */
+bool SchedulerTimer::sleepWithin(uint32_t within_us)
+{
+    constexpr uint32_t WAKE_US = 8; // wake-up, Timer0 ISR and the return to the caller
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    const bool overflow_pending = TIFR0 & _BV(TOV0);
+    const uint32_t to_overflow_us = (256UL - TCNT0) * 64UL / (F_CPU / 1000000UL); // Timer0 prescaler 64, 4us per count at 16MHz
+    if (overflow_pending || to_overflow_us + WAKE_US > within_us)
+    {
+        sei();
+        return false;
+    }
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    return true;
+}
+
+#else // native build, emulate Timer1 from the virtual clock
+
+#include <Arduino.h>
+#include "NativeHost.hpp"
+
+namespace
+{
+    uint32_t period = 0;  /**< Tick period in microseconds, 0 if not started */
+    uint32_t last_tick = 0; /**< micros() of the last emulated compare match */
+    constexpr uint32_t TIMER0_OVERFLOW_US = 1024; /**< Timer0 (millis()) overflow period, ATmega328P @ 16MHz */
+} // namespace
+
+bool SchedulerTimer::begin(uint32_t period_us)
+{
+    if (period_us == 0)
+        return false;
+    period = period_us;
+    last_tick = micros();
+    return true;
+}
+
+void SchedulerTimer::restart()
+{
+    last_tick = micros();
+}
+
+uint8_t SchedulerTimer::takeTicks()
+{
+    if (period == 0)
+        return 0;
+    const uint32_t ticks = static_cast<uint32_t>(micros() - last_tick) / period; // unsigned long is 64 bit on the host, keep the AVR wrap
+    last_tick += ticks * period;
+    return ticks > 0xFF ? 0xFF : ticks;
+}
+
+uint32_t SchedulerTimer::sinceTickUs()
+{
+    return micros() - last_tick;
+}
+
+bool SchedulerTimer::sleep()
+{
+    // wake on the emulated Timer1 tick or the Timer0 overflow, whichever is first
+    const uint32_t now = micros();
+    uint32_t sleep_us = TIMER0_OVERFLOW_US - now % TIMER0_OVERFLOW_US;
+    if (period != 0)
+    {
+        const uint32_t to_tick_us = now - last_tick >= period ? 0 : period - (now - last_tick);
+        if (to_tick_us < sleep_us)
+            sleep_us = to_tick_us;
+    }
+    NativeHost::advanceMicros(sleep_us);
+    return period != 0 && micros() - last_tick >= period;
+}
+
+bool SchedulerTimer::sleepWithin(uint32_t within_us)
+{
+    constexpr uint32_t WAKE_US = 8;
+    const uint32_t to_overflow_us = TIMER0_OVERFLOW_US - micros() % TIMER0_OVERFLOW_US;
+    if (to_overflow_us + WAKE_US > within_us)
+        return false;
+    NativeHost::advanceMicros(to_overflow_us);
+    return true;
+}
+
+#endif // __AVR__
@@ -0,0 +1,36 @@
+/**
+ * @file SchedulerTimer.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the SchedulerTimer namespace, a Timer1 compare-match tick source for the Scheduler
+ * @version 1.2
+ * @date 2026-10-17
+ * @see SchedulerTimer.cpp, Scheduler.hpp
+ */
+
+#ifndef SCHEDULER_TIMER_HPP
+#define SCHEDULER_TIMER_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Namespace for the hardware tick of the Scheduler.
+ * @details Timer1 runs in CTC mode with OCR1A set to the Scheduler period. The compare-match ISR only counts
+ * pending ticks; the tasks still run from loop() through Scheduler::updateTimerTick(), since they use SPI and
+ * Serial, which must not run inside an ISR. Tick timing then comes from the timer instead of how often
+ * loop() polls micros(), and no time is spent spin-waiting.
+ * sleep() puts the CPU in SLEEP_MODE_IDLE until the next interrupt, for Scheduler::idle(). Timer0 (millis()),
+ * Timer1, the ADC and the MCP2515 INT pins all wake it, SPI and the ADC keep running. Without Timer1, sleepWithin()
+ * only sleeps if the Timer0 overflow, due at most every 1024us at 16MHz, is sure to wake the CPU in time.
+ * On the native build, Timer1 is emulated from micros(), and sleeping advances the virtual clock to the next wake-up.
+ */
+namespace SchedulerTimer
+{
+    bool begin(uint32_t period_us);
+    void restart();
+    uint8_t takeTicks();
+    uint32_t sinceTickUs();
+    bool sleep();
+    bool sleepWithin(uint32_t within_us);
+} // namespace SchedulerTimer
+
+#endif // SCHEDULER_TIMER_HPP
@@ -0,0 +1,188 @@
+/**
+ * @file StaticScheduler.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration and definition of the StaticScheduler class template, a Scheduler whose task table is fixed at compile time
+ * @version 1.3
+ * @date 2026-10-17
+ * @see Scheduler.hpp
+ */
+
+#ifndef STATIC_SCHEDULER_HPP
+#define STATIC_SCHEDULER_HPP
+
+#include <stdint.h>
+#include "Enums.hpp"
+
+/**
+ * @brief One entry of a StaticScheduler task table.
+ * @details Everything is a template argument, so the entry takes no SRAM and the call is direct (inlinable).
+ * @tparam FN Task function
+ * @tparam INTERVAL Number of ticks between runs, 1 for every tick
+ * @tparam LANE Lane of the controller the task talks to, see CanChannelMap::lane(), to keep the table readable next to Scheduler::addTask() calls
+ * @tparam PHASE Tick within the interval the task runs on, see Scheduler::addTask()
+ */
+template <void (*FN)(), uint8_t INTERVAL, LaneIndex LANE, uint8_t PHASE = 0>
+struct StaticTask
+{
+    static_assert(INTERVAL > 0, "StaticTask interval must be at least 1 tick");
+    static_assert(PHASE < INTERVAL, "StaticTask phase must be less than its interval");
+
+    static constexpr uint8_t interval = INTERVAL; /**< Interval in ticks */
+    static constexpr LaneIndex lane = LANE;       /**< Lane of the controller the task talks to */
+
+    /**
+     * @brief Runs the task if it is due on this tick.
+     * @param tick Tick number within the hyperperiod.
+     */
+    static inline void run(const uint16_t tick)
+    {
+        if (INTERVAL == 1 || tick % INTERVAL == PHASE)
+            FN();
+    }
+};
+
+/**
+ * @brief Recursive list of StaticTask, runs them in the listed order.
+ * @tparam TASKS StaticTask entries
+ */
+template <typename... TASKS>
+struct StaticTaskList;
+
+/** @brief Empty StaticTaskList, ends the recursion. */
+template <>
+struct StaticTaskList<>
+{
+    static constexpr uint16_t hyperperiod = 1; /**< LCM of no intervals */
+    static inline void run(const uint16_t) {}  /**< Nothing to run */
+};
+
+/**
+ * @brief Non-empty StaticTaskList.
+ * @tparam FIRST First StaticTask
+ * @tparam REST Remaining StaticTask entries
+ */
+template <typename FIRST, typename... REST>
+struct StaticTaskList<FIRST, REST...>
+{
+    /**
+     * @brief Greatest common divisor, for the hyperperiod.
+     * @param a First value.
+     * @param b Second value.
+     * @return gcd(a, b)
+     */
+    static constexpr uint32_t gcd(const uint32_t a, const uint32_t b) { return b == 0 ? a : gcd(b, a % b); }
+
+    static constexpr uint32_t lcm = static_cast<uint32_t>(FIRST::interval) / gcd(FIRST::interval, StaticTaskList<REST...>::hyperperiod) * StaticTaskList<REST...>::hyperperiod; /**< LCM of all intervals */
+    static_assert(lcm <= 0xFFFF, "StaticScheduler hyperperiod must fit in 16 bits");
+    static constexpr uint16_t hyperperiod = lcm; /**< LCM of all intervals, the tick counter wraps here */
+
+    /**
+     * @brief Runs every due task of the list, in order.
+     * @param tick Tick number within the hyperperiod.
+     */
+    static inline void run(const uint16_t tick)
+    {
+        FIRST::run(tick);
+        StaticTaskList<REST...>::run(tick);
+    }
+};
+
+/**
+ * @brief Scheduler with the task table fixed at compile time.
+ * @details Single rate, with no sub-ticks or fast lane as in Scheduler: each tick is one PERIOD_US, spin-waited for
+ * under SPIN_US, and missed periods are skipped rather than caught up.
+ * The tasks are template arguments, so dispatch compiles to straight-line direct calls that can be inlined,
+ * and the only SRAM used is the last fire time and a 16-bit tick counter.
+ * Tasks run in the listed order, so list the most critical first. There is no stats, budget or timer tick mode.
+ *
+ * Tasks that are added and removed at runtime stay on a dynamic Scheduler, driven from a StaticTask with
+ * Scheduler::runTick(), e.g.
+ * @code
+ * Scheduler<1, NUM_LANES> dynamic_scheduler(10000, 0);
+ * void dynamicTick() { dynamic_scheduler.runTick(*micros); }
+ * StaticScheduler<10000, 500,
+ *                 StaticTask<scheduler_pedal, 1, CAN_CHANNELS.lane(CanBus::Motor)>,
+ *                 StaticTask<schedulerTelemetryPedal, 1, CAN_CHANNELS.lane(CanBus::Datalogger)>,
+ *                 StaticTask<schedulerTelemetryMotor, 1, CAN_CHANNELS.lane(CanBus::Datalogger)>,
+ *                 StaticTask<schedulerTelemetryBms, 10, CAN_CHANNELS.lane(CanBus::Datalogger), 0>,
+ *                 StaticTask<dynamicTick, 1, CAN_CHANNELS.lane(CanBus::Bms)>>
+ *     scheduler;
+ * @endcode
+ *
+ * Compared to Scheduler, the task table (a function pointer and the per-task byte arrays for every slot of every lane),
+ * the fast lane arrays and the sub-tick and timebase counters all leave SRAM,
+ * and the tick loop over priorities, slots and lanes with an indirect call per task becomes one inlined check per task.
+ * test_scheduler_bench prints the sizeof() of both and times both dispatchers on the target it runs on.
+ *
+ * @tparam PERIOD_US Period (tick length) in microseconds
+ * @tparam SPIN_US Threshold to switch from returning to spin-waiting, in microseconds, at most PERIOD_US
+ * @tparam TASKS StaticTask entries, in run order
+ */
+template <uint32_t PERIOD_US, uint32_t SPIN_US, typename... TASKS>
+class StaticScheduler
+{
+    static_assert(SPIN_US <= PERIOD_US, "StaticScheduler spin threshold must not exceed the period");
+
+public:
+    using Tasks = StaticTaskList<TASKS...>; /**< The task table */
+
+    constexpr StaticScheduler() : last_fire_us(0), tick(0) {}
+
+    /**
+     * @brief Update the scheduler, running the due tasks once a period has passed, see Scheduler::update()
+     * @param[in] current_time_us Function pointer to a function returning the current time in microseconds
+     */
+    void update(unsigned long (*const current_time_us)())
+    {
+        if (current_time_us == nullptr)
+            return;
+
+        uint32_t delta = current_time_us() - last_fire_us;
+        if (delta >= PERIOD_US)
+        {
+            runTick();
+            if (delta >= 2 * PERIOD_US)
+                // we missed more than one period, override last_fire_us to avoid bursts
+                last_fire_us = current_time_us();
+            else
+                last_fire_us += PERIOD_US;
+            return;
+        }
+        // not time yet, check if we should spin-wait or return
+        if (delta >= PERIOD_US - SPIN_US)
+        {
+            while ((uint32_t)(current_time_us() - last_fire_us) < PERIOD_US)
+                ;
+            runTick();
+            last_fire_us += PERIOD_US;
+        }
+    }
+
+    /**
+     * @brief Runs one tick now, regardless of time.
+     */
+    inline void runTick()
+    {
+        Tasks::run(tick);
+        if (++tick >= Tasks::hyperperiod)
+            tick = 0;
+    }
+
+    /**
+     * @brief Returns the period of the scheduler in microseconds.
+     * @return The period in microseconds.
+     */
+    static constexpr uint32_t getPeriodUs() { return PERIOD_US; }
+
+    /**
+     * @brief Returns the hyperperiod of the task table, the LCM of all intervals.
+     * @return Hyperperiod in ticks.
+     */
+    static constexpr uint16_t hyperperiod() { return Tasks::hyperperiod; }
+
+private:
+    uint32_t last_fire_us; /**< Last time scheduler fired, overridden if missed more than one period. */
+    uint16_t tick;         /**< Tick within the hyperperiod, decides which tasks are due. */
+};
+
+#endif // STATIC_SCHEDULER_HPP
@@ -0,0 +1,254 @@
+/**
+ * @file FilterDesign.hpp
+ * @author Planeson, Red Bird Racing
+ * @brief Declaration of the FilterDesign namespace, compile time design of the fixed-point low-pass filter stages
+ * @version 1.0
+ * @date 2026-10-16
+ * @see SignalProcessing.hpp
+ */
+#ifndef FILTER_DESIGN_HPP
+#define FILTER_DESIGN_HPP
+
+#include <stdint.h>
+
+/**
+ * @brief Namespace for the filter design math, all constexpr so the coefficients become constants and no float code is linked.
+ * @details The math runs in the compiler in double (32 bit float on AVR, plenty for coefficients), then is rounded to
+ * fixed point with FRAC_BITS fractional bits. Frequencies are in Hz for the sample rate and 0.01 Hz (CHZ) for the cutoff,
+ * as floating point template parameters need C++20.
+ *
+ * The delays given are the group delay at DC, the lag of a slow pedal movement: computed from the rounded coefficients,
+ * so they are the delay of the filter as it runs, not as designed.
+ */
+namespace FilterDesign
+{
+    constexpr double PI = 3.14159265358979323846; /**< pi */
+
+    /**
+     * @brief Sine, Taylor series after reducing to [-pi, pi].
+     * @param x Angle in radians.
+     * @return sin(x).
+     */
+    constexpr double sine(double x)
+    {
+        while (x > PI)
+            x -= 2 * PI;
+        while (x < -PI)
+            x += 2 * PI;
+        double term = x;
+        double sum = x;
+        for (uint8_t n = 1; n < 12; ++n)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Cosine.
+     * @param x Angle in radians.
+     * @return cos(x).
+     */
+    constexpr double cosine(const double x) { return sine(x + PI / 2); }
+
+    /**
+     * @brief Tangent.
+     * @param x Angle in radians, away from +-pi/2.
+     * @return tan(x).
+     */
+    constexpr double tangent(const double x) { return sine(x) / cosine(x); }
+
+    /**
+     * @brief Exponential, Taylor series of x / 16, squared 4 times.
+     * @param x Exponent, -10 to 0 is all the designs need.
+     * @return e^x.
+     */
+    constexpr double exponential(const double x)
+    {
+        const double y = x / 16;
+        double term = 1;
+        double sum = 1;
+        for (uint8_t n = 1; n < 12; ++n)
+        {
+            term *= y / n;
+            sum += term;
+        }
+        for (uint8_t i = 0; i < 4; ++i)
+            sum *= sum;
+        return sum;
+    }
+
+    /**
+     * @brief Rounds a coefficient to fixed point.
+     * @param value Coefficient.
+     * @param frac_bits Fractional bits.
+     * @return value * 2^frac_bits, rounded half away from zero.
+     */
+    constexpr int32_t toFixed(const double value, const uint8_t frac_bits)
+    {
+        const double scaled = value * static_cast<double>(1UL << frac_bits);
+        return static_cast<int32_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    }
+
+    /**
+     * @brief Largest value of a signed type, without <limits> (not on AVR).
+     * @tparam T Signed integer type.
+     * @return Maximum of T.
+     */
+    template <typename T>
+    constexpr T signedMax()
+    {
+        return static_cast<T>((static_cast<T>(1) << (sizeof(T) * 8 - 2)) - 1) * 2 + 1;
+    }
+
+    /**
+     * @brief Normalised cutoff, as a fraction of the sample rate.
+     * @param sample_hz Sample rate in Hz.
+     * @param cutoff_chz Cutoff in 0.01 Hz.
+     * @return cutoff / sample rate.
+     */
+    constexpr double normalised(const uint32_t sample_hz, const uint32_t cutoff_chz) { return cutoff_chz / (100.0 * sample_hz); }
+
+    /**
+     * @brief Turns a delay in samples into microseconds.
+     * @param samples Delay in samples.
+     * @param sample_hz Sample rate in Hz.
+     * @return Delay in us, rounded.
+     */
+    constexpr uint32_t delayUs(const double samples, const uint32_t sample_hz) { return static_cast<uint32_t>(samples * 1000000.0 / sample_hz + 0.5); }
+
+    /**
+     * @brief Smoothing factor of a one pole low-pass, y += alpha * (x - y), with a -3dB cutoff at cutoff_chz.
+     * @param sample_hz Sample rate in Hz.
+     * @param cutoff_chz Cutoff in 0.01 Hz.
+     * @param frac_bits Fractional bits.
+     * @return alpha in fixed point, at least 1.
+     */
+    constexpr int32_t onePoleAlpha(const uint32_t sample_hz, const uint32_t cutoff_chz, const uint8_t frac_bits)
+    {
+        const int32_t alpha = toFixed(1 - exponential(-2 * PI * normalised(sample_hz, cutoff_chz)), frac_bits);
+        return alpha > 0 ? alpha : 1;
+    }
+
+    /**
+     * @brief Fixed-point coefficients of a biquad, y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2].
+     */
+    struct Biquad
+    {
+        int32_t b0; /**< Numerator, current input */
+        int32_t b1; /**< Numerator, previous input */
+        int32_t b2; /**< Numerator, input before that */
+        int32_t a1; /**< Denominator, previous output */
+        int32_t a2; /**< Denominator, output before that */
+    };
+
+    /**
+     * @brief Designs a 2nd order Butterworth low-pass: bilinear transform, with the cutoff pre-warped.
+     * b1 is rounded so the gain at DC is exactly 1, a constant pedal position comes out unchanged.
+     * @param sample_hz Sample rate in Hz.
+     * @param cutoff_chz -3dB cutoff in 0.01 Hz, below sample_hz / 2.
+     * @param frac_bits Fractional bits.
+     * @return Coefficients.
+     */
+    constexpr Biquad butterworthLowPass(const uint32_t sample_hz, const uint32_t cutoff_chz, const uint8_t frac_bits)
+    {
+        const double k = tangent(PI * normalised(sample_hz, cutoff_chz));
+        const double sqrt2 = 1.41421356237309504880; // 1 / Q
+        const double norm = 1 / (1 + sqrt2 * k + k * k);
+        Biquad q{0, 0, 0, 0, 0};
+        q.b0 = toFixed(k * k * norm, frac_bits);
+        q.b2 = q.b0;
+        q.a1 = toFixed(2 * (k * k - 1) * norm, frac_bits);
+        q.a2 = toFixed((1 - sqrt2 * k + k * k) * norm, frac_bits);
+        q.b1 = static_cast<int32_t>(1L << frac_bits) + q.a1 + q.a2 - q.b0 - q.b2;
+        return q;
+    }
+
+    /**
+     * @brief Group delay at DC of a biquad, sum(n b_n) / sum(b_n) - sum(n a_n) / sum(a_n).
+     * @param q Coefficients.
+     * @param frac_bits Fractional bits of the coefficients.
+     * @return Delay in samples.
+     */
+    constexpr double biquadDelay(const Biquad &q, const uint8_t frac_bits)
+    {
+        const double a0 = static_cast<double>(1UL << frac_bits);
+        return static_cast<double>(q.b1 + 2 * q.b2) / (q.b0 + q.b1 + q.b2) - (q.a1 + 2.0 * q.a2) / (a0 + q.a1 + q.a2);
+    }
+
+    /**
+     * @brief Sum of the magnitudes of a biquad's coefficients, the gain of the accumulator in the worst case.
+     * @param q Coefficients.
+     * @return |b0| + |b1| + |b2| + |a1| + |a2|.
+     */
+    constexpr uint32_t biquadAbsSum(const Biquad &q)
+    {
+        return static_cast<uint32_t>((q.b0 < 0 ? -q.b0 : q.b0) + (q.b1 < 0 ? -q.b1 : q.b1) + (q.b2 < 0 ? -q.b2 : q.b2) +
+                                     (q.a1 < 0 ? -q.a1 : q.a1) + (q.a2 < 0 ? -q.a2 : q.a2));
+    }
+
+    /**
+     * @brief Fixed-point taps of an FIR filter.
+     * @tparam TAPS Number of taps.
+     * @tparam TypeCoef Type of a tap.
+     */
+    template <uint8_t TAPS, typename TypeCoef>
+    struct Fir
+    {
+        TypeCoef h[TAPS]; /**< Taps, h[0] for the current input */
+    };
+
+    /**
+     * @brief Designs a linear phase FIR low-pass: sinc, Hamming window.
+     * The centre tap is rounded so the gain at DC is exactly 1. The delay is (TAPS - 1) / 2 samples.
+     * @tparam TAPS Number of taps, odd.
+     * @tparam TypeCoef Type of a tap.
+     * @param sample_hz Sample rate in Hz.
+     * @param cutoff_chz -6dB cutoff in 0.01 Hz, below sample_hz / 2.
+     * @param frac_bits Fractional bits.
+     * @return Taps.
+     */
+    template <uint8_t TAPS, typename TypeCoef>
+    constexpr Fir<TAPS, TypeCoef> firLowPass(const uint32_t sample_hz, const uint32_t cutoff_chz, const uint8_t frac_bits)
+    {
+        const double fc = normalised(sample_hz, cutoff_chz);
+        constexpr uint8_t MID = TAPS / 2;
+        double h[TAPS] = {};
+        double sum = 0;
+        for (uint8_t n = 0; n < TAPS; ++n)
+        {
+            const double t = static_cast<double>(n) - MID;
+            const double ideal = (n == MID) ? 2 * fc : sine(2 * PI * fc * t) / (PI * t);
+            h[n] = ideal * (0.54 - 0.46 * cosine(2 * PI * n / (TAPS - 1)));
+            sum += h[n];
+        }
+        Fir<TAPS, TypeCoef> q{};
+        int32_t total = 0;
+        for (uint8_t n = 0; n < TAPS; ++n)
+        {
+            q.h[n] = static_cast<TypeCoef>(toFixed(h[n] / sum, frac_bits));
+            total += q.h[n];
+        }
+        q.h[MID] = static_cast<TypeCoef>(q.h[MID] + static_cast<int32_t>(1L << frac_bits) - total);
+        return q;
+    }
+
+    /**
+     * @brief Sum of the magnitudes of an FIR filter's taps, the gain of the accumulator in the worst case.
+     * @tparam TAPS Number of taps.
+     * @tparam TypeCoef Type of a tap.
+     * @param q Taps.
+     * @return Sum of |h[n]|.
+     */
+    template <uint8_t TAPS, typename TypeCoef>
+    constexpr uint32_t firAbsSum(const Fir<TAPS, TypeCoef> &q)
+    {
+        uint32_t sum = 0;
+        for (uint8_t n = 0; n < TAPS; ++n)
+            sum += static_cast<uint32_t>(q.h[n] < 0 ? -q.h[n] : q.h[n]);
+        return sum;
+    }
+} // namespace FilterDesign
+
+#endif // FILTER_DESIGN_HPP
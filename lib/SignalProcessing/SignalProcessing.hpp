@@ -2,15 +2,16 @@
  * @file SignalProcessing.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of signal processing functions
- * @version 2.1
- * @date 2026-01-28
+ * @version 2.6
+ * @date 2026-10-17
  * @see SignalProcessing.tpp
- * @dir SignalProcessing @brief The SignalProcessing library contains signal processing functions, including the AverageFilter and ExponentialFilter class templates for filtering ADC readings from the pedals.
+ * @dir SignalProcessing @brief The SignalProcessing library contains signal processing functions, including the AverageFilter and ExponentialFilter class templates for filtering ADC readings from the pedals, and the FilterChain of inline filter stages (EMA, average, median, rate limit, and low-passes designed at compile time from a cutoff, see FilterDesign.hpp).
  */
 #ifndef SIGNAL_PROCESSING_HPP
 #define SIGNAL_PROCESSING_HPP
 
 #include <stdint.h>
+#include "FilterDesign.hpp"
 
 /**
  * @brief Abstract Base Class for signal filters.
@@ -51,7 +52,7 @@ private:
  * f(t) = (f(t-1) * OLD_RATIO + sample * NEW_RATIO + (OLD_RATIO + NEW_RATIO) / 2) / (OLD_RATIO + NEW_RATIO)
  * Due to round down, the results won't ever reach maximum, especially if OLD_RATIO >> NEW_RATIO, so the use of curve is important.
  * @tparam TypeInput Type of the input samples.
- * @tparam TypeMid Type used for intermediate calculations.
+ * @tparam TypeMid Type used for intermediate calculations, must hold max input * (OLD_RATIO + NEW_RATIO).
  * @tparam OLD_RATIO Weighting ratio for the old value.
  * @tparam NEW_RATIO Weighting ratio for the new sample.
  */
@@ -67,6 +68,292 @@ private:
     TypeInput last_out = 0; /**< Last output value for exponential filter, input for next calculation */
 };
 
+// === Filter stages, composed at compile time ===
+
+/**
+ * @brief CRTP base of the filter stages, the addSample()/getFiltered() of Filter without virtual calls.
+ * @details A stage implements `TypeInput step(TypeInput sample)`, returning its new output, and `TypeInput value() const`.
+ * The calls are resolved at compile time and inlined, and a stage holds only its state: no vtable pointer in SRAM
+ * (on AVR the vtables themselves are copied to SRAM too). Stages compose with FilterChain.
+ * @tparam Derived The stage class.
+ * @tparam TypeInput Type of the samples.
+ */
+template <typename Derived, typename TypeInput>
+class FilterStage
+{
+public:
+    using Type = TypeInput; /**< Type of the samples, for FilterChain */
+
+    /**
+     * @brief Adds a new sample.
+     * @param sample New input sample.
+     * @return New filtered value.
+     */
+    TypeInput addSample(TypeInput sample) { return static_cast<Derived *>(this)->step(sample); }
+
+    /**
+     * @brief Retrieves the filtered value.
+     * @return Filtered value of the last sample.
+     */
+    TypeInput getFiltered() const { return static_cast<const Derived *>(this)->value(); }
+};
+
+/**
+ * @brief Exponential moving average stage, the same arithmetic as ExponentialFilter.
+ * @tparam OLD_RATIO Weighting ratio for the old value.
+ * @tparam NEW_RATIO Weighting ratio for the new sample.
+ * @tparam TypeInput Type of the input samples, default the 12 bit ADC.
+ * @tparam TypeMid Type used for intermediate calculations, must hold max input * (OLD_RATIO + NEW_RATIO).
+ */
+template <uint8_t OLD_RATIO = 31, uint8_t NEW_RATIO = 1, typename TypeInput = uint16_t, typename TypeMid = uint32_t>
+class EmaStage : public FilterStage<EmaStage<OLD_RATIO, NEW_RATIO, TypeInput, TypeMid>, TypeInput>
+{
+public:
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return last_out; } /**< @return Filtered value */
+
+private:
+    TypeInput last_out = 0; /**< Last output value, input for next calculation */
+};
+
+/**
+ * @brief Moving average stage, keeping a running sum so each sample costs the same whatever the SIZE.
+ * @tparam SIZE Number of samples to average over.
+ * @tparam TypeInput Type of the input samples, default the 12 bit ADC.
+ * @tparam TypeMid Type used for the sum, must hold max input * SIZE.
+ */
+template <uint8_t SIZE, typename TypeInput = uint16_t, typename TypeMid = uint32_t>
+class AverageStage : public FilterStage<AverageStage<SIZE, TypeInput, TypeMid>, TypeInput>
+{
+public:
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return static_cast<TypeInput>(sum / SIZE); } /**< @return Filtered value */
+
+private:
+    TypeInput buffer[SIZE] = {}; /**< Circular buffer of the last samples */
+    TypeMid sum = 0;             /**< Sum of buffer */
+    uint8_t index = 0;           /**< Oldest sample in buffer */
+};
+
+/**
+ * @brief Slew rate limit stage, the output moves towards the input by at most MAX_STEP per sample.
+ * The first sample is taken as is, so the output doesn't ramp up from 0 at start.
+ * @tparam MAX_STEP Largest change per sample.
+ * @tparam TypeInput Type of the input samples, default the 12 bit ADC.
+ */
+template <uint16_t MAX_STEP, typename TypeInput = uint16_t>
+class RateLimitStage : public FilterStage<RateLimitStage<MAX_STEP, TypeInput>, TypeInput>
+{
+public:
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return last_out; } /**< @return Filtered value */
+
+private:
+    TypeInput last_out = 0; /**< Last output value */
+    bool started = false;   /**< A sample has been taken */
+};
+
+/**
+ * @brief Running median stage, rejects spikes shorter than half the window that an average or EMA would smear in.
+ * @details Allocation-free: the window is kept twice, in arrival order and sorted. Each sample replaces the oldest
+ * in the sorted copy by insertion, at most SIZE - 1 moves, and the median is the middle entry.
+ * Delays by (SIZE - 1) / 2 samples, DELAY_US. The first sample fills the window, so the output doesn't start at 0.
+ * @tparam SIZE Number of samples, odd, 3 to 15.
+ * @tparam TypeInput Type of the input samples, default the 12 bit ADC.
+ * @tparam SAMPLE_HZ Sample rate in Hz, only for DELAY_US, default the 1 kHz pedal rate.
+ */
+template <uint8_t SIZE, typename TypeInput = uint16_t, uint32_t SAMPLE_HZ = 1000>
+class MedianStage : public FilterStage<MedianStage<SIZE, TypeInput, SAMPLE_HZ>, TypeInput>
+{
+    static_assert(SIZE % 2 == 1, "median window must be odd");
+    static_assert(SIZE >= 3 && SIZE <= 15, "median window must be 3 to 15, insertion costs grow with SIZE");
+
+public:
+    static constexpr uint32_t DELAY_US = FilterDesign::delayUs((SIZE - 1) / 2, SAMPLE_HZ); /**< Delay of a step, (SIZE - 1) / 2 samples */
+
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return sorted[SIZE / 2]; } /**< @return Filtered value */
+
+private:
+    TypeInput ring[SIZE] = {};   /**< Window in arrival order */
+    TypeInput sorted[SIZE] = {}; /**< Window in ascending order */
+    uint8_t index = 0;           /**< Oldest sample in ring */
+    bool started = false;        /**< A sample has been taken */
+};
+
+/**
+ * @brief One pole low-pass stage, an EMA whose factor is designed from the cutoff instead of picked as a ratio.
+ * @details y += alpha * (x - y), alpha = 1 - e^(-2 pi fc / fs). y is kept with FRAC_BITS fractional bits, so the output
+ * reaches the input, unlike ExponentialFilter. The first sample is taken as is. Delays by DELAY_US at DC.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -3dB cutoff in 0.01 Hz, below SAMPLE_HZ / 2.
+ * @tparam INPUT_BITS Bits of the input, larger samples are clamped.
+ * @tparam TypeInput Type of the input samples, unsigned.
+ * @tparam TypeMid Type used for intermediate calculations, signed, checked against overflow at compile time.
+ * @tparam FRAC_BITS Fractional bits of alpha and y, default the most int32_t holds.
+ */
+template <uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS = 16, typename TypeInput = uint16_t, typename TypeMid = int32_t, uint8_t FRAC_BITS = 30 - INPUT_BITS>
+class LowPassStage : public FilterStage<LowPassStage<SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>, TypeInput>
+{
+    static_assert(CUTOFF_CHZ > 0 && CUTOFF_CHZ < SAMPLE_HZ * 50UL, "cutoff must be between 0 and half the sample rate");
+    static_assert(INPUT_BITS > 0 && INPUT_BITS <= sizeof(TypeInput) * 8 && INPUT_BITS < 32, "INPUT_BITS must fit TypeInput");
+    static_assert(static_cast<TypeMid>(-1) < 0 && FRAC_BITS > 0 && FRAC_BITS <= 30, "TypeMid must be signed, FRAC_BITS 1 to 30");
+
+    static constexpr TypeInput INPUT_MAX = static_cast<TypeInput>((static_cast<uint32_t>(1) << INPUT_BITS) - 1); /**< Largest input */
+    static constexpr int32_t ALPHA = FilterDesign::onePoleAlpha(SAMPLE_HZ, CUTOFF_CHZ, FRAC_BITS);              /**< alpha, FRAC_BITS fixed point */
+    // y up to (INPUT_MAX + 1) << FRAC_BITS, plus alpha * (x - y)
+    static_assert(((static_cast<uint64_t>(INPUT_MAX) + 1) << FRAC_BITS) + static_cast<uint64_t>(ALPHA) * INPUT_MAX <= static_cast<uint64_t>(FilterDesign::signedMax<TypeMid>()),
+                  "TypeMid overflows, lower FRAC_BITS or INPUT_BITS");
+
+public:
+    static constexpr uint32_t DELAY_US = FilterDesign::delayUs((static_cast<double>(1UL << FRAC_BITS) - ALPHA) / ALPHA, SAMPLE_HZ); /**< Group delay at DC, (1 - alpha) / alpha samples */
+
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return last_out; } /**< @return Filtered value */
+
+private:
+    TypeMid acc = 0;        /**< y, FRAC_BITS fixed point */
+    TypeInput last_out = 0; /**< y rounded */
+    bool started = false;   /**< A sample has been taken */
+};
+
+/**
+ * @brief 2nd order Butterworth low-pass stage, a fixed-point biquad designed from the cutoff.
+ * @details Twice the roll-off of a one pole or EMA for the same delay, without overshoot in the frequency response.
+ * Direct form I with the rounding error fed back into the next sample, so the output doesn't stick short of the input
+ * at low cutoffs. The gain at DC is exactly 1. The first sample is taken as is. Delays by DELAY_US at DC,
+ * about sqrt(2) / (2 pi fc). A step overshoots by ~4%, clamped to the input range.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -3dB cutoff in 0.01 Hz, below SAMPLE_HZ / 2.
+ * @tparam INPUT_BITS Bits of the input, larger samples are clamped.
+ * @tparam TypeInput Type of the input samples, unsigned.
+ * @tparam TypeMid Type used for intermediate calculations, signed, checked against overflow at compile time.
+ * @tparam FRAC_BITS Fractional bits of the coefficients, default the most int32_t holds for low cutoffs.
+ */
+template <uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS = 16, typename TypeInput = uint16_t, typename TypeMid = int32_t, uint8_t FRAC_BITS = 29 - INPUT_BITS>
+class BiquadLowPassStage : public FilterStage<BiquadLowPassStage<SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>, TypeInput>
+{
+    static_assert(CUTOFF_CHZ > 0 && CUTOFF_CHZ < SAMPLE_HZ * 50UL, "cutoff must be between 0 and half the sample rate");
+    static_assert(INPUT_BITS > 0 && INPUT_BITS <= sizeof(TypeInput) * 8 && INPUT_BITS < 32, "INPUT_BITS must fit TypeInput");
+    static_assert(static_cast<TypeMid>(-1) < 0 && FRAC_BITS > 0 && FRAC_BITS <= 30, "TypeMid must be signed, FRAC_BITS 1 to 30");
+
+    static constexpr TypeInput INPUT_MAX = static_cast<TypeInput>((static_cast<uint32_t>(1) << INPUT_BITS) - 1); /**< Largest input */
+    static constexpr FilterDesign::Biquad Q = FilterDesign::butterworthLowPass(SAMPLE_HZ, CUTOFF_CHZ, FRAC_BITS); /**< Coefficients, FRAC_BITS fixed point */
+    // every product at its largest, plus the fed back rounding error
+    static_assert(static_cast<uint64_t>(FilterDesign::biquadAbsSum(Q)) * INPUT_MAX + (1UL << FRAC_BITS) <= static_cast<uint64_t>(FilterDesign::signedMax<TypeMid>()),
+                  "TypeMid overflows, lower FRAC_BITS or INPUT_BITS");
+
+public:
+    static constexpr uint32_t DELAY_US = FilterDesign::delayUs(FilterDesign::biquadDelay(Q, FRAC_BITS), SAMPLE_HZ); /**< Group delay at DC */
+
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return y1; } /**< @return Filtered value */
+
+private:
+    TypeInput x1 = 0;     /**< Previous input */
+    TypeInput x2 = 0;     /**< Input before that */
+    TypeInput y1 = 0;     /**< Previous output */
+    TypeInput y2 = 0;     /**< Output before that */
+    TypeMid error = 0;    /**< Rounding error of the previous output, FRAC_BITS fixed point */
+    bool started = false; /**< A sample has been taken */
+};
+
+/**
+ * @brief FIR low-pass stage, a Hamming windowed sinc designed from the cutoff.
+ * @details Linear phase: every frequency is delayed the same (TAPS - 1) / 2 samples, DELAY_US, so the pedal shape isn't
+ * distorted, at the cost of a slower roll-off than the IIR stages for the same delay. The gain at DC is exactly 1.
+ * The first sample fills the window. The taps are shared by all stages of the same type (TAPS * sizeof(TypeMid) bytes,
+ * in SRAM on AVR) and each stage keeps its last TAPS samples.
+ * @tparam TAPS Number of taps, odd, 3 to 31.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -6dB cutoff in 0.01 Hz, below SAMPLE_HZ / 2.
+ * @tparam INPUT_BITS Bits of the input, larger samples are clamped.
+ * @tparam TypeInput Type of the input samples, unsigned.
+ * @tparam TypeMid Type of the taps and intermediate calculations, signed, checked against overflow at compile time.
+ * @tparam FRAC_BITS Fractional bits of the taps, default the most int32_t holds.
+ */
+template <uint8_t TAPS, uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS = 16, typename TypeInput = uint16_t, typename TypeMid = int32_t, uint8_t FRAC_BITS = 29 - INPUT_BITS>
+class FirLowPassStage : public FilterStage<FirLowPassStage<TAPS, SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>, TypeInput>
+{
+    static_assert(TAPS % 2 == 1 && TAPS >= 3 && TAPS <= 31, "FIR taps must be odd, 3 to 31");
+    static_assert(CUTOFF_CHZ > 0 && CUTOFF_CHZ < SAMPLE_HZ * 50UL, "cutoff must be between 0 and half the sample rate");
+    static_assert(INPUT_BITS > 0 && INPUT_BITS <= sizeof(TypeInput) * 8 && INPUT_BITS < 32, "INPUT_BITS must fit TypeInput");
+    static_assert(static_cast<TypeMid>(-1) < 0 && FRAC_BITS > 0 && FRAC_BITS <= 30, "TypeMid must be signed, FRAC_BITS 1 to 30");
+
+    static constexpr TypeInput INPUT_MAX = static_cast<TypeInput>((static_cast<uint32_t>(1) << INPUT_BITS) - 1); /**< Largest input */
+    static constexpr FilterDesign::Fir<TAPS, TypeMid> H = FilterDesign::firLowPass<TAPS, TypeMid>(SAMPLE_HZ, CUTOFF_CHZ, FRAC_BITS); /**< Taps, FRAC_BITS fixed point */
+    // every product at its largest, plus the rounding
+    static_assert(static_cast<uint64_t>(FilterDesign::firAbsSum(H)) * INPUT_MAX + (1UL << FRAC_BITS) <= static_cast<uint64_t>(FilterDesign::signedMax<TypeMid>()),
+                  "TypeMid overflows, lower FRAC_BITS or INPUT_BITS");
+
+public:
+    static constexpr uint32_t DELAY_US = FilterDesign::delayUs((TAPS - 1) / 2.0, SAMPLE_HZ); /**< Group delay, at every frequency */
+
+    TypeInput step(TypeInput sample);
+    TypeInput value() const { return last_out; } /**< @return Filtered value */
+
+private:
+    TypeInput buffer[TAPS] = {}; /**< Circular buffer of the last samples */
+    TypeInput last_out = 0;      /**< Last output value */
+    uint8_t index = 0;           /**< Newest sample in buffer */
+    bool started = false;        /**< A sample has been taken */
+};
+
+/**
+ * @brief Filter stages applied in order, each feeding the next, e.g. FilterChain<EmaStage<31, 1>, RateLimitStage<64>>.
+ * @details A FilterChain is a stage itself, so chains nest. It compiles to the stages' arithmetic inline,
+ * and its size is the sum of the stages' state.
+ * @tparam Stages Stages, first to last, all with the same Type.
+ */
+template <typename... Stages>
+class FilterChain;
+
+/**
+ * @brief FilterChain of a stage followed by more.
+ * @tparam First First stage.
+ * @tparam Rest The following stages.
+ */
+template <typename First, typename... Rest>
+class FilterChain<First, Rest...> : public FilterStage<FilterChain<First, Rest...>, typename First::Type>
+{
+public:
+    using Type = typename First::Type; /**< Type of the samples */
+    Type step(Type sample) { return rest.step(first.step(sample)); } /**< @param sample New input sample @return New filtered value */
+    Type value() const { return rest.value(); }                       /**< @return Filtered value of the last stage */
+
+private:
+    First first;                /**< First stage */
+    FilterChain<Rest...> rest; /**< The following stages */
+};
+
+/**
+ * @brief FilterChain of a single stage.
+ * @tparam Last The stage.
+ */
+template <typename Last>
+class FilterChain<Last> : public FilterStage<FilterChain<Last>, typename Last::Type>
+{
+public:
+    using Type = typename Last::Type; /**< Type of the samples */
+    Type step(Type sample) { return last.step(sample); } /**< @param sample New input sample @return New filtered value */
+    Type value() const { return last.value(); }           /**< @return Filtered value */
+
+private:
+    Last last; /**< The stage */
+};
+
+/**
+ * @brief Median then EMA: the median takes out the spikes, so the EMA only has the noise to smooth and can be lighter.
+ * @details Delays by about SIZE / 2 + OLD_RATIO / NEW_RATIO samples.
+ * @tparam SIZE Median window, odd, 3 to 15.
+ * @tparam OLD_RATIO Weighting ratio of the EMA for the old value.
+ * @tparam NEW_RATIO Weighting ratio of the EMA for the new sample.
+ * @tparam TypeInput Type of the input samples, default the 12 bit ADC.
+ * @tparam TypeMid Type used for the EMA calculations, must hold max input * (OLD_RATIO + NEW_RATIO).
+ */
+template <uint8_t SIZE, uint8_t OLD_RATIO = 15, uint8_t NEW_RATIO = 1, typename TypeInput = uint16_t, typename TypeMid = uint32_t>
+using MedianEmaFilter = FilterChain<MedianStage<SIZE, TypeInput>, EmaStage<OLD_RATIO, NEW_RATIO, TypeInput, TypeMid>>;
+
 #include "SignalProcessing.tpp" // implementation
 
 #endif // SIGNAL_PROCESSING_HPP
\ No newline at end of file
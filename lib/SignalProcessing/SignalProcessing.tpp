@@ -2,8 +2,8 @@
  * @file SignalProcessing.tpp
  * @author Planeson, Red Bird Racing
  * @brief Definition of Signal Processing functions
- * @version 2.1
- * @date 2026-01-28
+ * @version 2.6
+ * @date 2026-10-17
  * @see Signal_Processing.hpp
  */
 
@@ -80,7 +80,7 @@ ExponentialFilter<TypeInput, TypeMid, OLD_RATIO, NEW_RATIO>::ExponentialFilter()
 template <typename TypeInput, typename TypeMid, uint8_t OLD_RATIO, uint8_t NEW_RATIO>
 void ExponentialFilter<TypeInput, TypeMid, OLD_RATIO, NEW_RATIO>::addSample(TypeInput sample)
 {
-    last_out = static_cast<TypeMid>(last_out * OLD_RATIO + sample * NEW_RATIO + (OLD_RATIO + NEW_RATIO) / 2) / (OLD_RATIO + NEW_RATIO);
+    last_out = static_cast<TypeInput>((static_cast<TypeMid>(last_out) * OLD_RATIO + static_cast<TypeMid>(sample) * NEW_RATIO + (OLD_RATIO + NEW_RATIO) / 2) / (OLD_RATIO + NEW_RATIO));
 }
 
 /**
@@ -95,4 +95,241 @@ template <typename TypeInput, typename TypeMid, uint8_t OLD_RATIO, uint8_t NEW_R
 TypeInput ExponentialFilter<TypeInput, TypeMid, OLD_RATIO, NEW_RATIO>::getFiltered() const
 {
     return last_out;
-}
\ No newline at end of file
+}
+
+// === EmaStage ===
+
+/**
+ * @brief Adds a new sample to the EmaStage, as ExponentialFilter::addSample().
+ * @tparam OLD_RATIO Weighting ratio for the old value.
+ * @tparam NEW_RATIO Weighting ratio for the new sample.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam TypeMid Type used for intermediate calculations.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint8_t OLD_RATIO, uint8_t NEW_RATIO, typename TypeInput, typename TypeMid>
+TypeInput EmaStage<OLD_RATIO, NEW_RATIO, TypeInput, TypeMid>::step(TypeInput sample)
+{
+    last_out = static_cast<TypeInput>((static_cast<TypeMid>(last_out) * OLD_RATIO + static_cast<TypeMid>(sample) * NEW_RATIO + (OLD_RATIO + NEW_RATIO) / 2) / (OLD_RATIO + NEW_RATIO));
+    return last_out;
+}
+
+// === AverageStage ===
+
+/**
+ * @brief Adds a new sample to the AverageStage, replacing the oldest in the running sum.
+ * @tparam SIZE Number of samples to average over.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam TypeMid Type used for the sum.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint8_t SIZE, typename TypeInput, typename TypeMid>
+TypeInput AverageStage<SIZE, TypeInput, TypeMid>::step(TypeInput sample)
+{
+    sum = sum - buffer[index] + sample;
+    buffer[index] = sample;
+    index = (index + 1 == SIZE) ? 0 : index + 1;
+    return value();
+}
+
+// === MedianStage ===
+
+/**
+ * @brief Adds a new sample to the MedianStage, moving it into the place of the oldest in the sorted window.
+ * @tparam SIZE Number of samples.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam SAMPLE_HZ Sample rate in Hz.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint8_t SIZE, typename TypeInput, uint32_t SAMPLE_HZ>
+TypeInput MedianStage<SIZE, TypeInput, SAMPLE_HZ>::step(TypeInput sample)
+{
+    if (!started)
+    {
+        started = true;
+        for (uint8_t i = 0; i < SIZE; ++i)
+        {
+            ring[i] = sample;
+            sorted[i] = sample;
+        }
+        return sample;
+    }
+    const TypeInput oldest = ring[index];
+    ring[index] = sample;
+    index = (index + 1 == SIZE) ? 0 : index + 1;
+
+    uint8_t pos = 0;
+    while (sorted[pos] != oldest) // the oldest is always in the window
+        ++pos;
+    // shift the neighbours over the oldest until the new sample is in order
+    while (pos + 1 < SIZE && sorted[pos + 1] < sample)
+    {
+        sorted[pos] = sorted[pos + 1];
+        ++pos;
+    }
+    while (pos > 0 && sorted[pos - 1] > sample)
+    {
+        sorted[pos] = sorted[pos - 1];
+        --pos;
+    }
+    sorted[pos] = sample;
+    return value();
+}
+
+// === RateLimitStage ===
+
+/**
+ * @brief Adds a new sample to the RateLimitStage, moving the output towards it by at most MAX_STEP.
+ * @tparam MAX_STEP Largest change per sample.
+ * @tparam TypeInput Type of the input samples.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint16_t MAX_STEP, typename TypeInput>
+TypeInput RateLimitStage<MAX_STEP, TypeInput>::step(TypeInput sample)
+{
+    if (!started)
+    {
+        started = true;
+        last_out = sample;
+    }
+    else if (sample > last_out)
+        last_out = (sample - last_out > MAX_STEP) ? static_cast<TypeInput>(last_out + MAX_STEP) : sample;
+    else
+        last_out = (last_out - sample > MAX_STEP) ? static_cast<TypeInput>(last_out - MAX_STEP) : sample;
+    return last_out;
+}
+
+// === LowPassStage ===
+
+/**
+ * @brief Adds a new sample to the LowPassStage, moving y towards it by alpha.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -3dB cutoff in 0.01 Hz.
+ * @tparam INPUT_BITS Bits of the input.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam TypeMid Type used for intermediate calculations.
+ * @tparam FRAC_BITS Fractional bits of alpha and y.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS, typename TypeInput, typename TypeMid, uint8_t FRAC_BITS>
+TypeInput LowPassStage<SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>::step(TypeInput sample)
+{
+    if (sample > INPUT_MAX)
+        sample = INPUT_MAX;
+    if (!started)
+    {
+        started = true;
+        acc = static_cast<TypeMid>(sample) << FRAC_BITS;
+        last_out = sample;
+        return last_out;
+    }
+    // acc stays in 0 to (INPUT_MAX + 1) << FRAC_BITS, so the shifts are of positive values
+    acc += static_cast<TypeMid>(ALPHA) * (static_cast<TypeMid>(sample) - (acc >> FRAC_BITS));
+    const TypeMid rounded = (acc + (static_cast<TypeMid>(1) << (FRAC_BITS - 1))) >> FRAC_BITS;
+    last_out = rounded > INPUT_MAX ? INPUT_MAX : static_cast<TypeInput>(rounded);
+    return last_out;
+}
+
+// === BiquadLowPassStage ===
+
+template <uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS, typename TypeInput, typename TypeMid, uint8_t FRAC_BITS>
+constexpr FilterDesign::Biquad BiquadLowPassStage<SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>::Q;
+
+/**
+ * @brief Adds a new sample to the BiquadLowPassStage.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -3dB cutoff in 0.01 Hz.
+ * @tparam INPUT_BITS Bits of the input.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam TypeMid Type used for intermediate calculations.
+ * @tparam FRAC_BITS Fractional bits of the coefficients.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS, typename TypeInput, typename TypeMid, uint8_t FRAC_BITS>
+TypeInput BiquadLowPassStage<SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>::step(TypeInput sample)
+{
+    if (sample > INPUT_MAX)
+        sample = INPUT_MAX;
+    if (!started)
+    {
+        started = true;
+        x1 = x2 = y1 = y2 = sample; // settled at the first sample
+        return y1;
+    }
+    const TypeMid acc = static_cast<TypeMid>(Q.b0) * sample + static_cast<TypeMid>(Q.b1) * x1 + static_cast<TypeMid>(Q.b2) * x2 -
+                        static_cast<TypeMid>(Q.a1) * y1 - static_cast<TypeMid>(Q.a2) * y2 + error;
+    TypeInput out;
+    if (acc < 0) // undershoot below 0
+    {
+        out = 0;
+        error = 0;
+    }
+    else if ((acc >> FRAC_BITS) > INPUT_MAX) // overshoot above the input range
+    {
+        out = INPUT_MAX;
+        error = 0;
+    }
+    else
+    {
+        out = static_cast<TypeInput>(acc >> FRAC_BITS);
+        error = acc - (static_cast<TypeMid>(out) << FRAC_BITS);
+    }
+    x2 = x1;
+    x1 = sample;
+    y2 = y1;
+    y1 = out;
+    return out;
+}
+
+// === FirLowPassStage ===
+
+template <uint8_t TAPS, uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS, typename TypeInput, typename TypeMid, uint8_t FRAC_BITS>
+constexpr FilterDesign::Fir<TAPS, TypeMid> FirLowPassStage<TAPS, SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>::H;
+
+/**
+ * @brief Adds a new sample to the FirLowPassStage, the sum of the last TAPS samples weighted by the taps.
+ * @tparam TAPS Number of taps.
+ * @tparam SAMPLE_HZ Rate addSample() is called at, in Hz.
+ * @tparam CUTOFF_CHZ -6dB cutoff in 0.01 Hz.
+ * @tparam INPUT_BITS Bits of the input.
+ * @tparam TypeInput Type of the input samples.
+ * @tparam TypeMid Type of the taps and intermediate calculations.
+ * @tparam FRAC_BITS Fractional bits of the taps.
+ * @param sample New input sample to add.
+ * @return New filtered value.
+ */
+template <uint8_t TAPS, uint32_t SAMPLE_HZ, uint32_t CUTOFF_CHZ, uint8_t INPUT_BITS, typename TypeInput, typename TypeMid, uint8_t FRAC_BITS>
+TypeInput FirLowPassStage<TAPS, SAMPLE_HZ, CUTOFF_CHZ, INPUT_BITS, TypeInput, TypeMid, FRAC_BITS>::step(TypeInput sample)
+{
+    if (sample > INPUT_MAX)
+        sample = INPUT_MAX;
+    if (!started)
+    {
+        started = true;
+        for (uint8_t i = 0; i < TAPS; ++i)
+            buffer[i] = sample;
+        last_out = sample;
+        return last_out;
+    }
+    index = (index + 1 == TAPS) ? 0 : index + 1;
+    buffer[index] = sample;
+
+    TypeMid acc = static_cast<TypeMid>(1) << (FRAC_BITS - 1); // round to nearest
+    uint8_t pos = index;
+    for (uint8_t n = 0; n < TAPS; ++n)
+    {
+        acc += H.h[n] * static_cast<TypeMid>(buffer[pos]);
+        pos = (pos == 0) ? TAPS - 1 : pos - 1;
+    }
+    if (acc < 0) // side lobes ringing below 0
+        last_out = 0;
+    else
+        last_out = (acc >> FRAC_BITS) > INPUT_MAX ? INPUT_MAX : static_cast<TypeInput>(acc >> FRAC_BITS);
+    return last_out;
+}
@@ -2,8 +2,8 @@
  * @file Telemetry.cpp
  * @author Planeson, Red Bird Racing
  * @brief Implementation of the Telemetry class for sending telemetry data over CAN bus
- * @version 1.0
- * @date 2026-01-26
+ * @version 1.5
+ * @date 2026-10-16
  * @see Telemetry.hpp
  */
 
@@ -11,11 +11,11 @@
 
 /**
  * @brief Construct a new Telemetry object
- * @param mcp2515_ Reference to MCP2515 for sending CAN messages
+ * @param can_port_ Port of the datalogger CAN bus
  * @param car_ Reference to CarState
  */
-Telemetry::Telemetry(MCP2515 &mcp2515_, CarState &car_)
-    : mcp2515(mcp2515_), car(car_)
+Telemetry::Telemetry(CanPort &can_port_, CarState &car_)
+    : can_port(can_port_), car(car_)
 {
 }
 
@@ -25,7 +25,7 @@ Telemetry::Telemetry(MCP2515 &mcp2515_, CarState &car_)
 void Telemetry::sendPedal()
 {
     can_frame pedal_frame = car.pedal.toCanFrame();
-    mcp2515.sendMessage(&pedal_frame);
+    can_port.send(&pedal_frame);
 }
 
 /**
@@ -34,7 +34,7 @@ void Telemetry::sendPedal()
 void Telemetry::sendMotor()
 {
     can_frame motor_frame = car.motor.toCanFrame();
-    mcp2515.sendMessage(&motor_frame);
+    can_port.send(&motor_frame);
 }
 
 /**
@@ -43,5 +43,32 @@ void Telemetry::sendMotor()
 void Telemetry::sendBms()
 {
     can_frame bms_frame = car.bms.toCanFrame();
-    mcp2515.sendMessage(&bms_frame);
-}
\ No newline at end of file
+    can_port.send(&bms_frame);
+}
+
+/**
+ * @brief Internal helper to get and send the Scheduler stats telemetry frame
+ */
+void Telemetry::sendScheduler()
+{
+    can_frame scheduler_frame = car.scheduler.toCanFrame();
+    can_port.send(&scheduler_frame);
+}
+
+/**
+ * @brief Internal helper to get and send the CAN health telemetry frame
+ */
+void Telemetry::sendCan()
+{
+    can_frame can_health_frame = car.can.toCanFrame();
+    can_port.send(&can_health_frame);
+}
+
+/**
+ * @brief Internal helper to get and send the pedal latency telemetry frame
+ */
+void Telemetry::sendLatency()
+{
+    can_frame latency_frame = car.latency.toCanFrame();
+    can_port.send(&latency_frame);
+}
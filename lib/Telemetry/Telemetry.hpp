@@ -2,8 +2,8 @@
  * @file Telemetry.hpp
  * @author Planeson, Red Bird Racing
  * @brief Declaration of the Telemetry class for sending telemetry data over CAN bus
- * @version 1.0
- * @date 2026-01-26
+ * @version 1.5
+ * @date 2026-10-16
  * @see Telemetry.cpp
  * @dir lib/Telemetry @brief The Telemetry library contains the Telemetry class for managing telemetry data transmission over CAN bus, including grabbing and sending telemetry frames in fixed order based on scheduling logic.
  */
@@ -12,6 +12,7 @@
 #define TELEMETRY_HPP
 
 #include "CarState.hpp"
+#include "CanPort.hpp"
 
 // ignore -Wpedantic warnings for mcp2515.h
 #pragma GCC diagnostic push
@@ -26,13 +27,16 @@
 class Telemetry
 {
 public:
-    Telemetry(MCP2515 &mcp2515_, CarState &car_);
+    Telemetry(CanPort &can_port_, CarState &car_);
     void sendPedal();
     void sendMotor();
     void sendBms();
+    void sendScheduler();
+    void sendCan();
+    void sendLatency();
 
 private:
-    MCP2515 &mcp2515; /**< Reference to MCP2515 for sending CAN messages */
+    CanPort &can_port; /**< Port of the datalogger CAN bus */
     CarState &car;    /**< Reference to CarState */
 };
 #endif // TELEMETRY_HPP
\ No newline at end of file
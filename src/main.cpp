@@ -2,8 +2,8 @@
  * @file main.cpp
  * @author Planeson, Red Bird Racing
  * @brief Main VCU program entry point
- * @version 2.1
- * @date 2026-02-09
+ * @version 3.6
+ * @date 2026-10-17
  * @dir include @brief Contains all header-only files.
  * @dir lib @brief Contains all the libraries. Each library is in its own folder of the same name.
  * @dir src @brief Contains the main.cpp file, the main file of the program.
@@ -18,6 +18,15 @@
 #include "Scheduler.hpp"
 #include "Curves.hpp"
 #include "Telemetry.hpp"
+#include "CanRx.hpp"
+#include "CanTx.hpp"
+#include "CanPort.hpp"
+#include "SpiStats.hpp"
+#include "CanDispatch.hpp"
+#include "CanFilter.hpp"
+#include "CanHealth.hpp"
+#include "CanChannel.hpp"
+#include "AdcSampler.hpp"
 #include "Debug.hpp"
 
 // ignore -Wpedantic warnings for mcp2515.h
@@ -44,19 +53,100 @@ MCP2515 mcp2515_motor(CS_CAN_MOTOR); // motor CAN
 MCP2515 mcp2515_BMS(CS_CAN_BMS);     // BMS CAN
 MCP2515 mcp2515_DL(CS_CAN_DL);       // datalogger CAN
 
-#define mcp2515_motor mcp2515_DL
-#define mcp2515_BMS mcp2515_DL
+constexpr uint8_t NUM_MCP = NUM_CAN_CONTROLLERS;
+MCP2515 *const MCPS[NUM_MCP] = {&mcp2515_motor, &mcp2515_BMS, &mcp2515_DL}; // pointers, a copy would not share the driver state, indexed by McpIndex
 
-constexpr uint8_t NUM_MCP = 3;
-MCP2515 MCPS[NUM_MCP] = {mcp2515_motor, mcp2515_BMS, mcp2515_DL};
+// === controller carrying each logical bus, from BoardConf.h ===
+constexpr CanChannelMap CAN_CHANNELS = {{static_cast<McpIndex>(CAN_CHANNEL_MOTOR), static_cast<McpIndex>(CAN_CHANNEL_BMS),
+                                         static_cast<McpIndex>(CAN_CHANNEL_DL), static_cast<McpIndex>(CAN_CHANNEL_DEBUG)}};
+static_assert(CAN_CHANNELS.valid(), "CAN_CHANNEL_* must be 0 (motor), 1 (BMS) or 2 (datalogger) controller");
+constexpr uint8_t NUM_LANES = CAN_CHANNELS.controllers(); // Scheduler lanes, one per controller in use
+
+/**
+ * @brief Returns the receive ring size of a controller.
+ * A controller carrying only the motor and BMS buses is filtered down to their few routed IDs and gets the small ring,
+ * one carrying the datalogger or debug bus may see any traffic and gets the full ring.
+ * @param mcp Controller.
+ * @return Frames, a power of 2.
+ */
+constexpr uint8_t rxQueueSize(const McpIndex mcp)
+{
+    return CAN_CHANNELS.physical(CanBus::Datalogger) == mcp || CAN_CHANNELS.physical(CanBus::Debug) == mcp
+               ? CAN_RX_QUEUE_SIZE
+               : CAN_RX_QUEUE_SIZE_FILTERED;
+}
+
+// === receive and transmit queues and the port on them, only for the controllers in use, RX interrupt-driven if its INT pin is set in BoardConf.h ===
+#if CAN_USES_MCP(0)
+can_frame can_rx_frames_motor[rxQueueSize(McpIndex::Motor)];
+CanRx can_rx_motor(mcp2515_motor, CS_CAN_MOTOR, can_rx_frames_motor);
+CanTx can_tx_motor(mcp2515_motor, CS_CAN_MOTOR);
+Mcp2515Port can_port_motor(can_tx_motor, &can_rx_motor);
+#define CAN_PORT_MOTOR &can_port_motor
+#else
+#define CAN_PORT_MOTOR nullptr
+#endif
+#if CAN_USES_MCP(1)
+can_frame can_rx_frames_BMS[rxQueueSize(McpIndex::Bms)];
+CanRx can_rx_BMS(mcp2515_BMS, CS_CAN_BMS, can_rx_frames_BMS);
+CanTx can_tx_BMS(mcp2515_BMS, CS_CAN_BMS);
+Mcp2515Port can_port_BMS(can_tx_BMS, &can_rx_BMS);
+#define CAN_PORT_BMS &can_port_BMS
+#else
+#define CAN_PORT_BMS nullptr
+#endif
+#if CAN_USES_MCP(2)
+can_frame can_rx_frames_DL[rxQueueSize(McpIndex::Datalogger)];
+CanRx can_rx_DL(mcp2515_DL, CS_CAN_DL, can_rx_frames_DL);
+CanTx can_tx_DL(mcp2515_DL, CS_CAN_DL);
+Mcp2515Port can_port_DL(can_tx_DL, &can_rx_DL);
+#define CAN_PORT_DL &can_port_DL
+#else
+#define CAN_PORT_DL nullptr
+#endif
+
+Mcp2515Port *const CAN_PORTS[NUM_MCP] = {CAN_PORT_MOTOR, CAN_PORT_BMS, CAN_PORT_DL}; // nullptr if the controller carries no bus, indexed by McpIndex
+
+/**
+ * @brief Returns the port of a logical bus.
+ * @param bus Logical bus.
+ * @return Port of the controller carrying it, see CAN_CHANNELS.
+ */
+CanPort &canPort(const CanBus bus)
+{
+    return *CAN_PORTS[static_cast<uint8_t>(CAN_CHANNELS.physical(bus))];
+}
 
 constexpr uint16_t BUSSIN_MILLIS = 2000;       // The amount of time that the buzzer will buzz for
 constexpr uint16_t BMS_OVERRIDE_MILLIS = 1000; // The maximum amount of time to wait for the BMS to start HV, if passed, assume started but not reading response
 
+constexpr uint32_t TICK_BUDGET_US = 700; // Scheduler time per 1ms sub-tick for non-critical tasks, the rest is left for loop()
+
 constexpr uint16_t BRAKE_THRESHOLD = BRAKE_TABLE[0].in; // The threshold for the brake pedal to be considered pressed
 
 bool brake_pressed = false; // boolean for brake light on VCU (for ignition)
 
+constexpr uint8_t ADC_PINS[] = {APPS_5V, APPS_3V3, BRAKE_IN, HALL_SENSOR}; // indexed by AdcChannel
+constexpr uint8_t NUM_ADC_PINS = sizeof(ADC_PINS) / sizeof(ADC_PINS[0]);
+constexpr uint8_t NUM_PEDAL_ADC_PINS = PEDAL_ADC_OVERSAMPLED; // APPS 5V, APPS 3V3 and brake are oversampled to ADC_BITS, see AdcSampler
+static_assert(NUM_ADC_PINS == PEDAL_ADC_SLOTS, "Pedal::FILTER_DELAY_US is computed for another ADC rotation");
+static_assert(NUM_ADC_PINS <= ADC_SAMPLER_MAX_CHANNELS, "AdcSampler can't rotate through that many inputs");
+
+/**
+ * @brief Returns the latest value of an analog input.
+ * @param channel Input to read.
+ * @return ADC value, from AdcSampler at once, or from a blocking analogRead() if ADC_FREE_RUNNING is 0.
+ * ADC_BITS for the pedal inputs, 10 bit for the hall sensor.
+ */
+uint16_t sampleAdc(const AdcChannel channel)
+{
+#if ADC_FREE_RUNNING
+    return AdcSampler::read(static_cast<uint8_t>(channel));
+#else
+    return analogRead(ADC_PINS[static_cast<uint8_t>(channel)]);
+#endif
+}
+
 /**
  * @brief Global car state structure.
  * @see CarState
@@ -65,19 +155,139 @@ struct CarState car = {
     {}, // TelemetryFrameAdc
     {}, // TelemetryFrameDigital
     {}, // TelemetryFrameState
+    {}, // TelemetryFrameScheduler
+    {}, // TelemetryFrameCan
+    {}, // TelemetryFrameLatency
     0,  // millis
     0   // status_millis
 };
 
 // Global objects
-Pedal pedal(mcp2515_motor, car, car.pedal.apps_5v);
-BMS bms(mcp2515_BMS, car);
-Telemetry telem(mcp2515_DL, car);
+Pedal pedal(canPort(CanBus::Motor), car, car.pedal.apps_5v);
+BMS bms(canPort(CanBus::Bms), car);
+Telemetry telem(canPort(CanBus::Datalogger), car);
+
+// === received frame handlers, see CAN_ROUTES ===
+void onMotorSpeed(const can_frame &frame)
+{
+    pedal.onMotorSpeed(frame);
+}
+void onMotorWarnErr(const can_frame &frame)
+{
+    pedal.onMotorWarnErr(frame);
+}
+void onBmsInfo(const can_frame &frame)
+{
+    bms.onInfo(frame);
+}
+
+constexpr McpIndex RX_BUS_MOTOR = CAN_CHANNELS.physical(CanBus::Motor); // controller the motor frames are received on
+constexpr McpIndex RX_BUS_BMS = CAN_CHANNELS.physical(CanBus::Bms);     // controller the BMS frames are received on
+
+/**
+ * @brief Received frame routes, sorted at compile time, frames without a route are dropped.
+ */
+constexpr CanRoute CAN_ROUTES[] = {
+    // bus,       CAN ID,             mux (data[0]),      min dlc, handler
+    {RX_BUS_MOTOR, Pedal::MOTOR_READ, Pedal::SPEED_IST, 3, onMotorSpeed},
+    {RX_BUS_MOTOR, Pedal::MOTOR_READ, Pedal::WARN_ERR, 5, onMotorWarnErr},
+    {RX_BUS_BMS, BMS_INFO_EXT, CAN_NO_MUX, 7, onBmsInfo}};
+constexpr CanDispatch<sizeof(CAN_ROUTES) / sizeof(CAN_ROUTES[0])> can_dispatch(CAN_ROUTES);
+static_assert(can_dispatch.unique(), "CAN_ROUTES has two routes for the same bus, ID and mux");
+
+// === acceptance masks and filters, planned from the routes, so frames nobody handles never leave the MCP2515 ===
+constexpr auto RX_IDS_MOTOR = can_dispatch.ids(McpIndex::Motor);
+constexpr auto RX_IDS_BMS = can_dispatch.ids(McpIndex::Bms);
+constexpr auto RX_IDS_DL = can_dispatch.ids(McpIndex::Datalogger);
+constexpr CanFilterPlan CAN_FILTERS[NUM_MCP] = {planCanFilters(RX_IDS_MOTOR.ids, RX_IDS_MOTOR.count),
+                                                planCanFilters(RX_IDS_BMS.ids, RX_IDS_BMS.count),
+                                                planCanFilters(RX_IDS_DL.ids, RX_IDS_DL.count)}; // indexed by McpIndex
+static_assert(RX_IDS_MOTOR.count == 0 || CAN_FILTERS[0].valid, "too many IDs to plan on the motor controller");
+static_assert(RX_IDS_BMS.count == 0 || CAN_FILTERS[1].valid, "too many IDs to plan on the BMS controller");
+static_assert(RX_IDS_DL.count == 0 || CAN_FILTERS[2].valid, "too many IDs to plan on the datalogger controller");
+static_assert(CAN_FILTERS[0].unwanted == 0 && CAN_FILTERS[1].unwanted == 0 && CAN_FILTERS[2].unwanted == 0,
+              "filters pass unrouted IDs, check CAN_FILTERS[].accepts() or relax this");
+
+/**
+ * @brief Brings a controller in use up, in setup() and again after bus-off.
+ * A controller without routes keeps its filters open, the dispatch drops what it receives.
+ * @param mcp Controller, one of MCPS.
+ * @return true if every step succeeded.
+ */
+bool initCan(MCP2515 &mcp)
+{
+    uint8_t index = 0;
+    while (index < NUM_MCP - 1 && MCPS[index] != &mcp)
+        ++index;
+    bool ok = mcp.reset() == MCP2515::ERROR_OK;
+    ok = mcp.setBitrate(CAN_RATE, MCP2515_CRYSTAL_FREQ) == MCP2515::ERROR_OK && ok;
+    if (CAN_FILTERS[index].valid)
+        ok = CAN_FILTERS[index].apply(mcp) == MCP2515::ERROR_OK && ok;
+    return mcp.setNormalMode() == MCP2515::ERROR_OK && ok;
+}
+
+// === error state polling and bus-off recovery, one per controller in use ===
+#if CAN_USES_MCP(0)
+CanHealth can_health_motor(McpIndex::Motor, mcp2515_motor, can_tx_motor, &can_rx_motor, initCan, CAN_RATE_KBPS);
+#endif
+#if CAN_USES_MCP(1)
+CanHealth can_health_BMS(McpIndex::Bms, mcp2515_BMS, can_tx_BMS, &can_rx_BMS, initCan, CAN_RATE_KBPS);
+#endif
+#if CAN_USES_MCP(2)
+CanHealth can_health_DL(McpIndex::Datalogger, mcp2515_DL, can_tx_DL, &can_rx_DL, initCan, CAN_RATE_KBPS);
+#endif
+CanHealth *const CAN_HEALTH[] = {
+#if CAN_USES_MCP(0)
+    &can_health_motor,
+#endif
+#if CAN_USES_MCP(1)
+    &can_health_BMS,
+#endif
+#if CAN_USES_MCP(2)
+    &can_health_DL,
+#endif
+};
+constexpr uint8_t NUM_CAN_HEALTH = sizeof(CAN_HEALTH) / sizeof(CAN_HEALTH[0]);
+
+/**
+ * @brief Hands every frame received since the last call to its handler.
+ */
+void canReceive()
+{
+    can_frame frame;
+    for (uint8_t i = 0; i < NUM_MCP; ++i)
+    {
+        if (CAN_PORTS[i] == nullptr)
+            continue;
+        while (CAN_PORTS[i]->read(&frame) == MCP2515::ERROR_OK)
+            can_dispatch.dispatch(static_cast<McpIndex>(i), frame);
+    }
+}
 
+Scheduler<8, NUM_LANES, 2> scheduler(
+    10000, // period_us, CAN lane
+    100,   // spin_threshold_us
+    10     // sub_ticks, 1ms fast lane for pedal sampling
+);
+
+void schedulerSample()
+{
+    car.millis = scheduler.nowMs();
+    pedal.latency.mark(LatencyStage::Sample);
+    pedal.update(sampleAdc(AdcChannel::Apps5v), sampleAdc(AdcChannel::Apps3v3), sampleAdc(AdcChannel::Brake));
+    brake_pressed = (car.pedal.brake >= BRAKE_THRESHOLD);
+    digitalWrite(BRAKE_LIGHT, brake_pressed ? HIGH : LOW);
+}
+void schedulerSampleHall()
+{
+    car.pedal.hall_sensor = sampleAdc(AdcChannel::Hall);
+}
 void scheduler_pedal()
 {
+    SpiStats::tick(); // SPI bytes of the last 10ms
+    canReceive(); // first, so the torque command sees the latest motor rpm
     pedal.sendFrame();
-    pedal.readMotor();
+    pedal.checkMotorTimeout();
 }
 void scheduler_bms()
 {
@@ -96,10 +306,36 @@ void schedulerTelemetryBms()
     telem.sendBms();
 }
 
-Scheduler<2, NUM_MCP> scheduler(
-    10000, // period_us
-    500    // spin_threshold_us
-);
+uint8_t can_health_entry = 0; // next controller to send the health of, cycles through CAN_HEALTH
+
+void schedulerCanHealth()
+{
+    for (uint8_t i = 0; i < NUM_CAN_HEALTH; ++i)
+        CAN_HEALTH[i]->poll(car.millis);
+    CAN_HEALTH[can_health_entry]->report(car.can);
+    can_health_entry = (can_health_entry + 1) % NUM_CAN_HEALTH;
+    telem.sendCan();
+}
+
+uint8_t latency_entry = 0; // next pedal latency stage to send, cycles through all
+
+void schedulerTelemetryLatency()
+{
+    pedal.latency.report(static_cast<LatencyStage>(latency_entry), car.latency);
+    latency_entry = (latency_entry + 1) % LATENCY_STAGES;
+    telem.sendLatency();
+}
+
+#if SCHEDULER_STATS
+uint8_t scheduler_stats_entry = 0; // next Scheduler stats entry to send, cycles through all
+
+void schedulerTelemetryScheduler()
+{
+    car.scheduler.mux = scheduler.getStatsEntry(scheduler_stats_entry, car.scheduler.values);
+    scheduler_stats_entry = (scheduler_stats_entry + 1) % scheduler.statsEntries();
+    telem.sendScheduler();
+}
+#endif
 
 /**
  * @brief Setup function for initializing the VCU system.
@@ -114,11 +350,23 @@ void setup()
 
     for (uint8_t i = 0; i < NUM_MCP; ++i)
     {
-        MCPS[i].reset();
-        MCPS[i].setBitrate(CAN_RATE, MCP2515_CRYSTAL_FREQ);
-        MCPS[i].setNormalMode();
+        if (CAN_PORTS[i] != nullptr)
+            initCan(*MCPS[i]);
+        else
+            MCPS[i]->reset(); // carries no bus, stays in configuration mode, off the bus
     }
 
+#if defined(INT_CAN_MOTOR) && CAN_USES_MCP(0)
+    can_rx_motor.begin(INT_CAN_MOTOR);
+#endif
+#if defined(INT_CAN_BMS) && CAN_USES_MCP(1)
+    can_rx_BMS.begin(INT_CAN_BMS);
+#endif
+#if defined(INT_CAN_DL) && CAN_USES_MCP(2)
+    can_rx_DL.begin(INT_CAN_DL);
+#endif
+    pedal.begin(); // cyclic motor reads, after the controller reset
+
     // init GPIO pins (MCP2515 CS pins initialized in constructor))
     for (uint8_t i = 0; i < INPUT_COUNT; ++i)
     {
@@ -129,16 +377,30 @@ void setup()
         pinMode(pins_out[i], OUTPUT);
         digitalWrite(pins_out[i], LOW);
     }
+#if ADC_FREE_RUNNING
+    AdcSampler::begin(ADC_PINS, NUM_ADC_PINS, NUM_PEDAL_ADC_PINS); // after pinMode(INPUT), the inputs are sampled from now on
+#endif
 
 #if DEBUG_CAN
-    Debug_CAN::initialize(&mcp2515_DL); // Currently using motor CAN for debug messages, should change to other
+    Debug_CAN::initialize(&canPort(CanBus::Debug));
     DBGLN_GENERAL("Debug CAN initialized");
 #endif
 
-    scheduler.addTask(McpIndex::Motor, scheduler_pedal, 1);
-    scheduler.addTask(McpIndex::Datalogger, schedulerTelemetryPedal, 1);
-    scheduler.addTask(McpIndex::Datalogger, schedulerTelemetryMotor, 1);
-    scheduler.addTask(McpIndex::Datalogger, schedulerTelemetryBms, 10);
+    scheduler.setTickBudget(TICK_BUDGET_US);
+    scheduler.addFastTask(schedulerSample);
+    scheduler.addFastTask(schedulerSampleHall, 10); // once per period, only sent as telemetry
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Motor), scheduler_pedal, 1, TaskPriority::Critical);
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerTelemetryPedal, 1, TaskPriority::Normal);
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerTelemetryMotor, 1, TaskPriority::Normal);
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerTelemetryBms, 10, TaskPriority::Low);
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerCanHealth, 10, TaskPriority::Normal);
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerTelemetryLatency, 10, TaskPriority::Low);
+#if SCHEDULER_STATS
+    scheduler.addTask(CAN_CHANNELS.lane(CanBus::Datalogger), schedulerTelemetryScheduler, 10, TaskPriority::Low);
+#endif
+#if SCHEDULER_TIMER_TICK
+    scheduler.beginTimerTick();
+#endif
     DBGLN_GENERAL("Setup complete, entering main loop");
 }
 
@@ -149,14 +411,15 @@ void setup()
 void loop()
 {
     // DBG_HALL_SENSOR(analogRead(HALL_SENSOR));
-    car.millis = millis();
-    pedal.update(analogRead(APPS_5V), analogRead(APPS_3V3), analogRead(BRAKE_IN));
-
-    brake_pressed = (car.pedal.brake >= BRAKE_THRESHOLD);
-    digitalWrite(BRAKE_LIGHT, brake_pressed ? HIGH : LOW);
+    // car.millis, pedal and hall sampling and brake light are updated in the Scheduler fast lane, see schedulerSample()
+    // nothing below changes between ticks, so sleep until the next one instead of re-running it, see Scheduler::idle()
+    scheduler.idle(*micros);
+#if SCHEDULER_TIMER_TICK
+    scheduler.updateTimerTick(*micros);
+#else
     scheduler.update(*micros);
-
-    car.pedal.hall_sensor = analogRead(HALL_SENSOR);
+#endif
+    CanTx::service(); // retry frames left queued because all TX buffers were busy
 
     if (car.pedal.status.bits.force_stop)
     {
@@ -182,7 +445,7 @@ void loop()
             car.pedal.status.bits.car_status = CarStatus::Startin;
             car.status_millis = car.millis;
 
-            scheduler.addTask(McpIndex::Bms, scheduler_bms, 5); // check for HV ready in STARTIN
+            scheduler.addTask(CAN_CHANNELS.lane(CanBus::Bms), scheduler_bms, 5, TaskPriority::High); // check for HV ready in STARTIN
         }
         break;
 
@@ -193,7 +456,7 @@ void loop()
         {
             car.pedal.status.bits.car_status = CarStatus::Init;
             car.status_millis = car.millis;
-            scheduler.removeTask(McpIndex::Bms, scheduler_bms); // stop checking BMS HV ready since return to INIT
+            scheduler.removeTask(CAN_CHANNELS.lane(CanBus::Bms), scheduler_bms); // stop checking BMS HV ready since return to INIT
             break;
         }
         if (car.pedal.status.bits.hv_ready)
@@ -201,7 +464,7 @@ void loop()
             car.pedal.status.bits.car_status = CarStatus::Bussin;
             car.status_millis = car.millis;
             digitalWrite(BUZZER, HIGH);
-            scheduler.removeTask(McpIndex::Bms, scheduler_bms); // stop checking BMS HV ready since is already ready
+            scheduler.removeTask(CAN_CHANNELS.lane(CanBus::Bms), scheduler_bms); // stop checking BMS HV ready since is already ready
             break;
         }
         if (car.millis - car.status_millis >= BMS_OVERRIDE_MILLIS)
@@ -209,7 +472,7 @@ void loop()
             car.pedal.status.bits.car_status = CarStatus::Bussin;
             car.status_millis = car.millis;
             digitalWrite(BUZZER, HIGH);
-            scheduler.removeTask(McpIndex::Bms, scheduler_bms); // stop checking BMS HV ready since override to BUSSIN
+            scheduler.removeTask(CAN_CHANNELS.lane(CanBus::Bms), scheduler_bms); // stop checking BMS HV ready since override to BUSSIN
             break;
         }
         break;
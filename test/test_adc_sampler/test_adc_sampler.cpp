@@ -0,0 +1,132 @@
+/**
+ * @file test_adc_sampler.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks AdcSampler scales the oversampled inputs to ADC_BITS, and converts them ADC_SLOW_DIVIDER times as often as the others
+ * @version 1.0
+ * @date 2026-10-17
+ * @see AdcSampler.hpp
+ *
+ * Native only, the ADC is emulated from the virtual clock and the inputs are set with NativeHost::setAnalog().
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHost.hpp"
+#include "AdcSampler.hpp"
+
+constexpr uint8_t ADC_PINS[] = {APPS_5V, APPS_3V3, BRAKE_IN, HALL_SENSOR}; /**< Same rotation as main.cpp */
+constexpr uint8_t NUM_ADC_PINS = sizeof(ADC_PINS) / sizeof(ADC_PINS[0]);
+constexpr uint8_t NUM_OVERSAMPLED = 3; /**< APPS 5V, APPS 3V3 and brake */
+constexpr uint8_t SLOT_SLOW = 3;       /**< Hall sensor, not oversampled */
+constexpr uint8_t ROTATION = NUM_OVERSAMPLED * ADC_SLOW_DIVIDER + NUM_ADC_PINS - NUM_OVERSAMPLED; /**< Conversions per rotation */
+constexpr uint32_t CONVERSION_US = 1000000UL / ADC_CONVERSION_HZ;                                  /**< One conversion, rounded down */
+
+/**
+ * @brief Sets every input to a value, the slow one to another.
+ * @param oversampled 10 bit value of the oversampled inputs.
+ * @param slow 10 bit value of the slow input.
+ */
+void setInputs(const uint16_t oversampled, const uint16_t slow)
+{
+    for (uint8_t i = 0; i < NUM_OVERSAMPLED; ++i)
+        NativeHost::setAnalog(ADC_PINS[i], oversampled);
+    NativeHost::setAnalog(ADC_PINS[SLOT_SLOW], slow);
+}
+
+void setUp(void)
+{
+    NativeHost::reset();
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_constant_input_scaled(void)
+{
+    setInputs(700, 300);
+    TEST_ASSERT_TRUE(AdcSampler::begin(ADC_PINS, NUM_ADC_PINS, NUM_OVERSAMPLED));
+    for (uint8_t i = 0; i < 10; ++i)
+    {
+        for (uint8_t slot = 0; slot < NUM_OVERSAMPLED; ++slot)
+            TEST_ASSERT_EQUAL_UINT16(adcScale(700), AdcSampler::read(slot));
+        TEST_ASSERT_EQUAL_UINT16(300, AdcSampler::read(SLOT_SLOW)); // 10 bit
+        NativeHost::advanceMicros(1000);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, AdcSampler::read(NUM_ADC_PINS));
+}
+
+void test_rates(void)
+{
+    TEST_ASSERT_TRUE(AdcSampler::begin(ADC_PINS, NUM_ADC_PINS, NUM_OVERSAMPLED));
+    const uint32_t slow_hz = AdcSampler::rateHz(SLOT_SLOW);
+    uint32_t total_hz = slow_hz;
+    for (uint8_t slot = 0; slot < NUM_OVERSAMPLED; ++slot)
+    {
+        TEST_ASSERT_UINT16_WITHIN(ADC_SLOW_DIVIDER, slow_hz * ADC_SLOW_DIVIDER, AdcSampler::rateHz(slot)); // slow_hz is rounded down
+        TEST_ASSERT_EQUAL_UINT32(adcOversampledHz(NUM_ADC_PINS, NUM_OVERSAMPLED), AdcSampler::rateHz(slot));
+        total_hz += AdcSampler::rateHz(slot);
+    }
+    TEST_ASSERT_UINT16_WITHIN(NUM_ADC_PINS, ADC_CONVERSION_HZ, total_hz); // rounded down per slot
+    TEST_ASSERT_EQUAL_UINT32(0, AdcSampler::rateHz(NUM_ADC_PINS));
+}
+
+void test_priming_waits_for_slow_slot(void)
+{
+    setInputs(500, 900);
+    const uint64_t start_us = NativeHost::now();
+    TEST_ASSERT_TRUE(AdcSampler::begin(ADC_PINS, NUM_ADC_PINS, NUM_OVERSAMPLED));
+    // the slow slot comes last in the rotation, so begin() waits for all of it
+    TEST_ASSERT_TRUE(NativeHost::now() - start_us >= ROTATION * CONVERSION_US);
+    TEST_ASSERT_TRUE(AdcSampler::getConversions() >= ROTATION);
+    TEST_ASSERT_EQUAL_UINT16(900, AdcSampler::read(SLOT_SLOW));
+    // the first conversion fills the whole window
+    TEST_ASSERT_EQUAL_UINT16(adcScale(500), AdcSampler::read(0));
+}
+
+void test_slow_slot_divider(void)
+{
+    constexpr uint16_t OLD = 400;
+    constexpr uint16_t NEW = 600;
+    setInputs(OLD, OLD);
+    TEST_ASSERT_TRUE(AdcSampler::begin(ADC_PINS, NUM_ADC_PINS, NUM_OVERSAMPLED));
+    setInputs(NEW, NEW);
+    const uint32_t before = AdcSampler::getConversions();
+    NativeHost::advanceMicros(ROTATION * CONVERSION_US + CONVERSION_US / 2);
+    const uint32_t done = AdcSampler::getConversions() - before; // read() charges the interrupts after converting
+    const uint16_t oversampled = AdcSampler::read(0);
+    TEST_ASSERT_TRUE(done >= ROTATION && done <= ROTATION + 1);
+
+    // one rotation: the slow slot converted once, the oversampled ones ADC_SLOW_DIVIDER times (one more if the rotation overran)
+    TEST_ASSERT_EQUAL_UINT16(NEW, AdcSampler::read(SLOT_SLOW));
+    constexpr uint16_t EXPECTED = ((ADC_OVERSAMPLE_SIZE - ADC_SLOW_DIVIDER) * OLD + ADC_SLOW_DIVIDER * NEW) >> ADC_OVERSAMPLE_BITS;
+    constexpr uint16_t ONE_CONVERSION = (NEW - OLD) >> ADC_OVERSAMPLE_BITS;
+    TEST_ASSERT_UINT16_WITHIN(ONE_CONVERSION, EXPECTED + ONE_CONVERSION / 2, oversampled);
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_constant_input_scaled);
+    RUN_TEST(test_rates);
+    RUN_TEST(test_priming_waits_for_slow_slot);
+#if ADC_OVERSAMPLE_BITS >= 2
+    RUN_TEST(test_slow_slot_divider); // counts the conversions in the window, needs it longer than ADC_SLOW_DIVIDER
+#endif
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
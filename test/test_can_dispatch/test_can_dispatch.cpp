@@ -0,0 +1,130 @@
+/**
+ * @file test_can_dispatch.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks CanDispatch hands every routed frame of the main.cpp CAN_ROUTES to its handler and ignores the rest
+ * @version 1.0
+ * @date 2026-10-17
+ * @see CanDispatch.hpp
+ *
+ * The routes are the ones of main.cpp, with the motor and BMS buses on their own controllers, and the handlers only record the call.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "CanDispatch.hpp"
+#include "Pedal.hpp"
+#include "BMS.hpp"
+
+/**
+ * @brief Handlers of the routes, what the last dispatch() called.
+ */
+enum class Handled : uint8_t
+{
+    None,
+    MotorSpeed,
+    MotorWarnErr,
+    BmsInfo,
+    Mismatch /**< dispatch() returned true without a handler call or the other way round */
+};
+
+Handled handled = Handled::None; /**< Handler called by the last dispatch() */
+
+void onMotorSpeed(const can_frame &) { handled = Handled::MotorSpeed; }
+void onMotorWarnErr(const can_frame &) { handled = Handled::MotorWarnErr; }
+void onBmsInfo(const can_frame &) { handled = Handled::BmsInfo; }
+
+constexpr CanRoute CAN_ROUTES[] = {
+    // bus,           CAN ID,             mux (data[0]),      min dlc, handler
+    {McpIndex::Motor, Pedal::MOTOR_READ, Pedal::SPEED_IST, 3, onMotorSpeed},
+    {McpIndex::Motor, Pedal::MOTOR_READ, Pedal::WARN_ERR, 5, onMotorWarnErr},
+    {McpIndex::Bms, BMS_INFO_EXT, CAN_NO_MUX, 7, onBmsInfo}};
+constexpr CanDispatch<sizeof(CAN_ROUTES) / sizeof(CAN_ROUTES[0])> can_dispatch(CAN_ROUTES);
+static_assert(can_dispatch.unique(), "CAN_ROUTES has two routes for the same bus, ID and mux");
+
+/**
+ * @brief Dispatches one frame, the data after data[0] zeroed.
+ * @param bus Bus the frame is received on.
+ * @param id CAN ID, with flags.
+ * @param dlc Data length.
+ * @param mux data[0].
+ * @return Handler called, Handled::None if the frame was ignored.
+ */
+Handled dispatch(const McpIndex bus, const canid_t id, const uint8_t dlc, const uint8_t mux)
+{
+    can_frame frame = {};
+    frame.can_id = id;
+    frame.can_dlc = dlc;
+    frame.data[0] = mux;
+    handled = Handled::None;
+    const bool taken = can_dispatch.dispatch(bus, frame);
+    return taken == (handled != Handled::None) ? handled : Handled::Mismatch;
+}
+
+void setUp(void)
+{
+    // set stuff up here
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_routes_reach_handlers(void)
+{
+    TEST_ASSERT_EQUAL(Handled::MotorSpeed, dispatch(McpIndex::Motor, Pedal::MOTOR_READ, 3, Pedal::SPEED_IST));
+    TEST_ASSERT_EQUAL(Handled::MotorWarnErr, dispatch(McpIndex::Motor, Pedal::MOTOR_READ, 5, Pedal::WARN_ERR));
+    // no mux, any data[0] goes to the BMS handler
+    TEST_ASSERT_EQUAL(Handled::BmsInfo, dispatch(McpIndex::Bms, BMS_INFO_EXT, 8, 0x42));
+}
+
+void test_unrouted_ignored(void)
+{
+    // unknown ID
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Motor, 0x123, 8, Pedal::SPEED_IST));
+    // routed ID, unrouted register
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Motor, Pedal::MOTOR_READ, 3, 0x11));
+    // routed ID on the other bus
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Motor, BMS_INFO_EXT, 8, 0));
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Datalogger, Pedal::MOTOR_READ, 3, Pedal::SPEED_IST));
+    // the BMS ID as a standard frame
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Bms, BMS_INFO, 8, 0));
+    // shorter than the route's min dlc
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Motor, Pedal::MOTOR_READ, 4, Pedal::WARN_ERR));
+    TEST_ASSERT_EQUAL(Handled::None, dispatch(McpIndex::Motor, Pedal::MOTOR_READ, 0, 0));
+}
+
+void test_ids_per_bus(void)
+{
+    constexpr auto motor = can_dispatch.ids(McpIndex::Motor);
+    constexpr auto bms = can_dispatch.ids(McpIndex::Bms);
+    constexpr auto dl = can_dispatch.ids(McpIndex::Datalogger);
+    TEST_ASSERT_EQUAL_UINT8(1, motor.count);
+    TEST_ASSERT_EQUAL_HEX32(Pedal::MOTOR_READ, motor.ids[0]);
+    TEST_ASSERT_EQUAL_UINT8(1, bms.count);
+    TEST_ASSERT_EQUAL_HEX32(BMS_INFO_EXT, bms.ids[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, dl.count);
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_routes_reach_handlers);
+    RUN_TEST(test_unrouted_ignored);
+    RUN_TEST(test_ids_per_bus);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file test_can_filter.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks planCanFilters() passes every subscribed ID, counts the residual pass-through right, and that the MCP2515 agrees
+ * @version 1.0
+ * @date 2026-10-16
+ * @see CanFilter.hpp
+ *
+ * On the board the datalogger MCP2515 is put in loopback mode, which filters like normal mode, so no bus or other node is needed.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "BoardConf.h"
+#include "CanFilter.hpp"
+
+MCP2515 mcp(CS_CAN_DL);
+
+constexpr canid_t VCU_IDS[] = {0x181, 0x186040F3 | CAN_EFF_FLAG};                             // Bamocar reply, BMS info
+constexpr canid_t SIX_IDS[] = {0x181, 0x182, 0x300, 0x301, 0x690, 0x7FF};                     // fits one filter each
+constexpr canid_t BLOCK_IDS[] = {0x700, 0x701, 0x702, 0x703, 0x704, 0x705, 0x706, 0x707, 0x100}; // has to share filters
+constexpr canid_t MIXED_IDS[] = {0x181, 0x281, 0x381, 0x481, 0x581, 0x1801F340 | CAN_EFF_FLAG, 0x186040F3 | CAN_EFF_FLAG};
+
+constexpr CanFilterPlan VCU_PLAN = planCanFilters(VCU_IDS, sizeof(VCU_IDS) / sizeof(VCU_IDS[0]));
+constexpr CanFilterPlan SIX_PLAN = planCanFilters(SIX_IDS, sizeof(SIX_IDS) / sizeof(SIX_IDS[0]));
+constexpr CanFilterPlan BLOCK_PLAN = planCanFilters(BLOCK_IDS, sizeof(BLOCK_IDS) / sizeof(BLOCK_IDS[0]));
+constexpr CanFilterPlan MIXED_PLAN = planCanFilters(MIXED_IDS, sizeof(MIXED_IDS) / sizeof(MIXED_IDS[0]));
+
+static_assert(VCU_PLAN.valid && VCU_PLAN.unwanted == 0, "two IDs need no shared filter");
+static_assert(SIX_PLAN.valid && SIX_PLAN.unwanted == 0, "six standard IDs need no shared filter");
+static_assert(BLOCK_PLAN.valid && BLOCK_PLAN.unwanted == 0, "0x700-0x707 is one filter with the low 3 bits masked");
+static_assert(!planCanFilters(VCU_IDS, 0).valid, "no IDs is not a plan");
+
+/**
+ * @brief Checks every ID of a plan passes, and that the standard IDs passing match wanted + unwanted.
+ * @param plan Plan, of standard IDs only.
+ * @param ids Subscribed IDs.
+ * @param count Number of IDs.
+ */
+void checkStandardPlan(const CanFilterPlan &plan, const canid_t *ids, const uint8_t count)
+{
+    TEST_ASSERT_TRUE(plan.valid);
+    for (uint8_t i = 0; i < count; ++i)
+        TEST_ASSERT_TRUE(plan.accepts(ids[i]));
+    uint32_t passed = 0;
+    for (canid_t id = 0; id <= CAN_SFF_MASK; ++id)
+        passed += plan.accepts(id);
+    TEST_ASSERT_EQUAL_UINT32(plan.wanted + plan.unwanted, passed);
+}
+
+void setUp(void)
+{
+    // runs before each test
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_exact_plans(void)
+{
+    checkStandardPlan(SIX_PLAN, SIX_IDS, sizeof(SIX_IDS) / sizeof(SIX_IDS[0]));
+    checkStandardPlan(BLOCK_PLAN, BLOCK_IDS, sizeof(BLOCK_IDS) / sizeof(BLOCK_IDS[0]));
+    TEST_ASSERT_TRUE(VCU_PLAN.accepts(VCU_IDS[0]));
+    TEST_ASSERT_TRUE(VCU_PLAN.accepts(VCU_IDS[1]));
+    TEST_ASSERT_FALSE(VCU_PLAN.accepts(0x201));
+    TEST_ASSERT_FALSE(VCU_PLAN.accepts(0x181 | CAN_EFF_FLAG)); // same value, other frame type
+}
+
+void test_mixed_plan(void)
+{
+    char msg[96];
+    TEST_ASSERT_TRUE(MIXED_PLAN.valid);
+    for (uint8_t i = 0; i < sizeof(MIXED_IDS) / sizeof(MIXED_IDS[0]); ++i)
+        TEST_ASSERT_TRUE(MIXED_PLAN.accepts(MIXED_IDS[i]));
+    TEST_ASSERT_TRUE(MIXED_PLAN.mask_ext[0] != MIXED_PLAN.mask_ext[1]); // one mask per frame type
+    snprintf(msg, sizeof(msg), "%lu IDs wanted, %lu others pass", (unsigned long)MIXED_PLAN.wanted, (unsigned long)MIXED_PLAN.unwanted);
+    TEST_MESSAGE(msg);
+}
+
+void test_chip_agrees(void)
+{
+    mcp.reset();
+    mcp.setBitrate(CAN_RATE, MCP2515_CRYSTAL_FREQ);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, BLOCK_PLAN.apply(mcp));
+#ifdef __AVR__
+    mcp.setLoopbackMode();
+#else
+    mcp.setNormalMode();
+#endif
+
+    for (canid_t id = 0; id <= CAN_SFF_MASK; id += 0x11)
+    {
+        const can_frame frame = {id, 0, {}};
+#ifdef __AVR__
+        mcp.sendMessage(&frame);
+        delay(1); // let the frame go round
+#else
+        mcp.injectRx(frame);
+#endif
+        can_frame received;
+        const bool passed = mcp.readMessage(&received) == MCP2515::ERROR_OK;
+        TEST_ASSERT_EQUAL(BLOCK_PLAN.accepts(id), passed);
+    }
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_exact_plans);
+    RUN_TEST(test_mixed_plan);
+    RUN_TEST(test_chip_agrees);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file test_can_health.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks CanHealth reports a healthy controller, refuses sends while nothing is acknowledged, and recovers from bus-off with backoff
+ * @version 1.1
+ * @date 2026-10-17
+ * @see CanHealth.hpp
+ *
+ * On the board the datalogger MCP2515 is put in loopback mode, which never raises an error counter.
+ * Error passive and bus-off need the stand-in's fault injection, so those tests only run natively.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "BoardConf.h"
+#include "CanHealth.hpp"
+
+MCP2515 mcp(CS_CAN_DL);
+CanTx can_tx(mcp, CS_CAN_DL);
+can_frame can_rx_frames[CAN_RX_QUEUE_SIZE];
+CanRx can_rx(mcp, CS_CAN_DL, can_rx_frames);
+uint8_t inits = 0; /**< Calls of initLoopback() */
+
+const can_frame torque = {0x201, 3, {0x90, 0x34, 0x12}};
+
+/**
+ * @brief Puts the controller in loopback mode, as the reinitialisation of the test.
+ * @param mcp_ Controller.
+ * @return true
+ */
+bool initLoopback(MCP2515 &mcp_)
+{
+    ++inits;
+    mcp_.reset();
+    mcp_.setBitrate(CAN_RATE, MCP2515_CRYSTAL_FREQ);
+#ifdef __AVR__
+    mcp_.setLoopbackMode();
+#else
+    mcp_.setNormalMode(); // the stand-in only sends and receives in normal mode
+#endif
+    return true;
+}
+
+CanHealth health(McpIndex::Datalogger, mcp, can_tx, &can_rx, initLoopback, CAN_RATE_KBPS);
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_healthy(void)
+{
+    health.poll(100);
+    TEST_ASSERT_EQUAL(CanBusState::Active, health.getState());
+    TEST_ASSERT_TRUE(can_tx.isOnline());
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&torque));
+
+    TelemetryFrameCan frame;
+    health.report(frame);
+    TEST_ASSERT_EQUAL(McpIndex::Datalogger, frame.bus);
+    TEST_ASSERT_EQUAL_UINT8(0, frame.tec);
+    TEST_ASSERT_EQUAL_UINT16(0, frame.lost);
+}
+
+#ifndef __AVR__
+void test_passive_refuses(void)
+{
+    mcp.setErrorCounts(128, 0); // nobody acknowledges
+    health.poll(200);
+    TEST_ASSERT_EQUAL(CanBusState::Passive, health.getState());
+    TEST_ASSERT_FALSE(can_tx.isOnline());
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_FAILTX, can_tx.send(&torque));
+    TEST_ASSERT_EQUAL_UINT16(1, can_tx.getRefused());
+
+    mcp.setErrorCounts(127, 0); // acknowledged again
+    health.poll(300);
+    TEST_ASSERT_EQUAL(CanBusState::Warning, health.getState());
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&torque));
+    mcp.setErrorCounts(0, 0);
+    can_tx.resetStats();
+}
+
+void test_bus_off_backoff(void)
+{
+    const uint8_t inits_before = inits;
+    mcp.setBusFault(true);
+    can_tx.send(&torque); // the retries take it bus-off
+    health.poll(1000);
+    TEST_ASSERT_EQUAL(CanBusState::BusOff, health.getState());
+    TEST_ASSERT_EQUAL_UINT8(1, health.getBusOffs());
+    TEST_ASSERT_FALSE(can_tx.isOnline());
+
+    health.poll(1000 + CAN_HEALTH_RETRY_MS - 1); // still waiting
+    TEST_ASSERT_EQUAL_UINT8(inits_before, inits);
+    health.poll(1000 + CAN_HEALTH_RETRY_MS);
+    TEST_ASSERT_EQUAL_UINT8(inits_before + 1, inits);
+    TEST_ASSERT_TRUE(can_tx.isOnline());
+
+    // still broken, bus-off again, the next wait is twice as long
+    can_tx.send(&torque);
+    const uint32_t second = 1000 + CAN_HEALTH_RETRY_MS + 100;
+    health.poll(second);
+    TEST_ASSERT_EQUAL_UINT8(2, health.getBusOffs());
+    health.poll(second + 2 * CAN_HEALTH_RETRY_MS - 1);
+    TEST_ASSERT_EQUAL_UINT8(inits_before + 1, inits);
+
+    mcp.setBusFault(false);
+    health.poll(second + 2 * CAN_HEALTH_RETRY_MS);
+    TEST_ASSERT_EQUAL_UINT8(inits_before + 2, inits);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&torque));
+    health.poll(second + 2 * CAN_HEALTH_RETRY_MS + 100);
+    TEST_ASSERT_EQUAL(CanBusState::Active, health.getState());
+    TEST_ASSERT_EQUAL_UINT8(2, health.getReinits());
+}
+#endif
+
+void setup()
+{
+    initLoopback(mcp);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_healthy);
+#ifndef __AVR__
+    RUN_TEST(test_passive_refuses);
+    RUN_TEST(test_bus_off_backoff);
+#endif
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file test_can_port.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Runs Pedal, BMS and Telemetry against simulated Bamocar, BMS and datalogger nodes on a VirtualCanBus,
+ * times the bus, and checks SocketCanPort on vcan0 when it exists
+ * @version 1.0
+ * @date 2026-10-16
+ * @see CanPort.hpp, VirtualCanBus.hpp, SocketCanPort.hpp
+ *
+ * Native only: the four receive queues alone take half the ATmega328P SRAM, and SocketCAN is a Linux host interface.
+ * Create vcan0 with `ip link add dev vcan0 type vcan && ip link set up vcan0`, the test is ignored without it.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "CarState.hpp"
+#include "Pedal.hpp"
+#include "BMS.hpp"
+#include "Telemetry.hpp"
+#include "VirtualCanBus.hpp"
+#include "SocketCanPort.hpp"
+#include <chrono>
+
+constexpr uint16_t BENCH_FRAMES = 10000; /**< Frames sent for the throughput benchmark */
+
+VirtualCanBus bus;
+VirtualCanPort vcu(bus);     /**< Pedal, BMS and Telemetry, as with all CAN_CHANNEL_* on one controller */
+VirtualCanPort bamocar(bus); /**< Simulated motor controller */
+VirtualCanPort bms_node(bus); /**< Simulated Kclear BMS */
+VirtualCanPort logger(bus);  /**< Simulated datalogger */
+
+CarState car = {};
+Pedal pedal(vcu, car, car.pedal.apps_5v);
+BMS bms(vcu, car);
+Telemetry telem(vcu, car);
+
+/**
+ * @brief Empties the receive queue of a port.
+ * @param port Port to drain.
+ * @return Frames taken.
+ */
+uint16_t drain(CanPort &port)
+{
+    can_frame frame;
+    uint16_t count = 0;
+    while (port.read(&frame) == MCP2515::ERROR_OK)
+        ++count;
+    return count;
+}
+
+/**
+ * @brief Hands the frames the VCU received to their handler, as canReceive() of main.cpp.
+ */
+void vcuReceive()
+{
+    can_frame frame;
+    while (vcu.read(&frame) == MCP2515::ERROR_OK)
+    {
+        if (frame.can_id == BMS_INFO_EXT)
+            bms.onInfo(frame);
+        else if (frame.can_id == Pedal::MOTOR_READ && frame.data[0] == Pedal::SPEED_IST)
+            pedal.onMotorSpeed(frame);
+    }
+}
+
+/**
+ * @brief Simulated Kclear BMS, goes to precharge on a start command and to run one step later, then reports.
+ * @param state Upper nibble of data[6]: 3 standby, 4 precharge, 5 run.
+ */
+void bmsStep(uint8_t &state)
+{
+    if (state == 0x40)
+        state = 0x50;
+    can_frame frame;
+    while (bms_node.read(&frame) == MCP2515::ERROR_OK)
+    {
+        if (frame.can_id == BMS_SEND_CMD && frame.data[0] == 0x01 && state == 0x30)
+            state = 0x40;
+    }
+    const can_frame info = {BMS_INFO_EXT, 8, {0, 0, 0, 0, 0, 0, state, 0}};
+    bms_node.send(&info);
+}
+
+void setUp(void)
+{
+    drain(vcu);
+    drain(bamocar);
+    drain(bms_node);
+    drain(logger);
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_cyclic_read_requests(void)
+{
+    pedal.begin();
+    can_frame frame;
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, bamocar.read(&frame));
+    TEST_ASSERT_EQUAL_HEX32(0x201, frame.can_id);
+    TEST_ASSERT_EQUAL_HEX8(Pedal::SPEED_IST, frame.data[1]);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, bamocar.read(&frame));
+    TEST_ASSERT_EQUAL_HEX8(Pedal::WARN_ERR, frame.data[1]);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_NOMSG, bamocar.read(&frame));
+}
+
+void test_bms_starts_hv(void)
+{
+    uint8_t state = 0x30;
+    for (uint8_t step = 0; step < 5 && !bms.hvReady(); ++step)
+    {
+        bmsStep(state);
+        vcuReceive();
+        bms.checkHv();
+    }
+    TEST_ASSERT_TRUE(bms.hvReady());
+    TEST_ASSERT_EQUAL_HEX8(0x50, state);
+}
+
+void test_telemetry_reaches_logger(void)
+{
+    telem.sendPedal();
+    can_frame frame;
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, logger.read(&frame));
+    TEST_ASSERT_EQUAL_HEX32(TELEMETRY_PEDAL_MSG, frame.can_id);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_NOMSG, vcu.read(&frame)); // own frames aren't received back
+}
+
+void test_full_queue_drops(void)
+{
+    const can_frame frame = {0x300, 8, {0}};
+    const uint16_t dropped = logger.getDropped();
+    for (uint8_t i = 0; i <= VIRTUAL_CAN_RX_SIZE; ++i)
+        bamocar.send(&frame);
+    TEST_ASSERT_EQUAL_UINT16(dropped + 1, logger.getDropped());
+    TEST_ASSERT_EQUAL_UINT16(VIRTUAL_CAN_RX_SIZE, drain(logger));
+}
+
+void test_bus_throughput(void)
+{
+    const can_frame torque = {0x201, 3, {0x90, 0x34, 0x12}};
+    const uint32_t frames_before = bus.getFrames();
+    uint32_t received = 0;
+    const auto start = std::chrono::steady_clock::now(); // wall clock, micros() is virtual time natively
+    for (uint16_t i = 0; i < BENCH_FRAMES; ++i)
+    {
+        vcu.send(&torque);
+        received += drain(bamocar) + drain(bms_node) + drain(logger);
+    }
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32(BENCH_FRAMES, bus.getFrames() - frames_before);
+    TEST_ASSERT_EQUAL_UINT32(3UL * BENCH_FRAMES, received);
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "virtual bus: %u frames to 3 nodes in %lu us, %lu frames/s", BENCH_FRAMES,
+             (unsigned long)(elapsed_s * 1e6), (unsigned long)(elapsed_s > 0 ? BENCH_FRAMES / elapsed_s : 0));
+    TEST_MESSAGE(msg);
+}
+
+#if CAN_PORT_SOCKETCAN
+void test_socketcan_missing_interface(void)
+{
+    SocketCanPort port;
+    const can_frame frame = {0x201, 3, {0x90, 0x34, 0x12}};
+    TEST_ASSERT_FALSE(port.open("nosuchcan0"));
+    TEST_ASSERT_FALSE(port.isOpen());
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_FAILTX, port.send(&frame));
+}
+
+void test_socketcan_vcan(void)
+{
+    SocketCanPort sender;
+    SocketCanPort receiver;
+    if (!sender.open("vcan0") || !receiver.open("vcan0"))
+        TEST_IGNORE_MESSAGE("vcan0 not available");
+
+    const can_frame sent = {0x1801F340 | CAN_EFF_FLAG, 2, {0x01, 0x01}};
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, sender.send(&sent, true));
+    uint32_t sent_us;
+    TEST_ASSERT_TRUE(sender.takeStamp(sent_us));
+
+    can_frame got;
+    MCP2515::ERROR result = MCP2515::ERROR_NOMSG;
+    for (uint16_t tries = 0; tries < 1000 && result != MCP2515::ERROR_OK; ++tries) // vcan delivers at once, but not inside send()
+        result = receiver.read(&got);
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, result);
+    TEST_ASSERT_EQUAL_HEX32(sent.can_id, got.can_id);
+    TEST_ASSERT_EQUAL_UINT8(sent.can_dlc, got.can_dlc);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(sent.data, got.data, sent.can_dlc);
+}
+#endif
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cyclic_read_requests);
+    RUN_TEST(test_bms_starts_hv);
+    RUN_TEST(test_telemetry_reaches_logger);
+    RUN_TEST(test_full_queue_drops);
+    RUN_TEST(test_bus_throughput);
+#if CAN_PORT_SOCKETCAN
+    RUN_TEST(test_socketcan_missing_interface);
+    RUN_TEST(test_socketcan_vcan);
+#endif
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,232 @@
+/**
+ * @file test_can_tx_bench.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks CanTx sends frames unchanged and by ID priority, CanRx reads them back unchanged with the fast SPI
+ * instructions, and compares the tick time and SPI bytes of blocking and queued sends
+ * @version 1.3
+ * @date 2026-10-17
+ * @see CanTx.hpp, CanRx.hpp, SpiStats.hpp
+ *
+ * On the board the datalogger MCP2515 is put in loopback mode, so no bus or other node is needed.
+ * The priority test needs the TX buffers to stay busy, which the loopback never does, so it only runs natively.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "BoardConf.h"
+#include "CanRx.hpp"
+#include "CanTx.hpp"
+#include "SpiStats.hpp"
+
+constexpr uint8_t FRAMES_PER_TICK = 4; /**< Frames sent per tick, as the telemetry ticks of main.cpp */
+constexpr uint16_t BENCH_TICKS = 100;  /**< Ticks timed for the benchmark */
+
+MCP2515 mcp(CS_CAN_DL);
+CanTx can_tx(mcp, CS_CAN_DL);
+can_frame can_rx_frames[CAN_RX_QUEUE_SIZE];
+CanRx can_rx(mcp, CS_CAN_DL, can_rx_frames);
+
+const can_frame frames[FRAMES_PER_TICK] = {
+    {0x201, 3, {0x90, 0x34, 0x12}},                     // torque command
+    {0x700, 8, {1, 2, 3, 4, 5, 6, 7, 8}},               // telemetry
+    {0x1801F340 | CAN_EFF_FLAG, 2, {0x01, 0x01}},       // BMS command, extended
+    {0x7FF | CAN_RTR_FLAG, 0, {}}};                     // remote frame, highest standard ID
+
+/**
+ * @brief Takes the next frame the controller sent, from the loopback RX on the board.
+ * @param frame Output frame.
+ * @return true if a frame was taken.
+ */
+bool takeSent(can_frame &frame)
+{
+#ifdef __AVR__
+    return mcp.readMessage(&frame) == MCP2515::ERROR_OK;
+#else
+    return mcp.popTx(frame);
+#endif
+}
+
+/**
+ * @brief Drops every frame sent so far.
+ */
+void dropSent()
+{
+    can_frame frame;
+    while (takeSent(frame))
+        ;
+}
+
+void setUp(void)
+{
+    CanTx::waitIdle();
+    dropSent();
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_frames_unchanged(void)
+{
+    for (uint8_t i = 0; i < FRAMES_PER_TICK; ++i)
+    {
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&frames[i]));
+        CanTx::waitIdle();
+        delay(1); // loopback: let the frame go round
+        can_frame sent;
+        TEST_ASSERT_TRUE(takeSent(sent));
+        TEST_ASSERT_EQUAL_HEX32(frames[i].can_id, sent.can_id);
+        TEST_ASSERT_EQUAL_UINT8(frames[i].can_dlc, sent.can_dlc);
+        if (!(frames[i].can_id & CAN_RTR_FLAG))
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(frames[i].data, sent.data, frames[i].can_dlc);
+    }
+}
+
+#if CAN_RX_FAST_SPI
+void test_rx_fast_path(void)
+{
+#ifndef __AVR__
+    mcp.setNormalMode(); // the stand-in only receives in normal mode, its loopback mode doesn't loop back
+#endif
+    for (uint8_t i = 0; i < FRAMES_PER_TICK; ++i)
+    {
+#ifdef __AVR__
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&frames[i]));
+        CanTx::waitIdle();
+        delay(1); // loopback: let the frame go round
+#else
+        TEST_ASSERT_TRUE(mcp.injectRx(frames[i]));
+#endif
+        SpiStats::reset();
+        can_frame received;
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_rx.read(&received));
+        // RX STATUS, READ RX BUFFER of 6 + DLC bytes, RX STATUS finding both buffers empty
+        TEST_ASSERT_EQUAL_UINT32(2 + 6 + frames[i].can_dlc + 2, SpiStats::total().bytes);
+        TEST_ASSERT_EQUAL_UINT32(3, SpiStats::total().selects);
+        TEST_ASSERT_EQUAL_HEX32(frames[i].can_id, received.can_id);
+        TEST_ASSERT_EQUAL_UINT8(frames[i].can_dlc, received.can_dlc);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(frames[i].data, received.data, frames[i].can_dlc);
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_NOMSG, can_rx.read(&received));
+    }
+#ifndef __AVR__
+    mcp.setLoopbackMode();
+#endif
+}
+#endif
+
+#ifndef __AVR__
+void test_priority_order(void)
+{
+    const can_frame filler = {0x700, 1, {0}};
+    const can_frame telemetry = {0x710, 1, {0}};
+    const can_frame torque = {0x201, 3, {0x90, 0x34, 0x12}};
+
+    // fill the wire and all 3 TX buffers, nothing is drained until the end
+    for (uint8_t i = 0; i < MCP2515::TX_QUEUE_SIZE + 3; ++i)
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&filler));
+    TEST_ASSERT_FALSE(can_tx.pending());
+    can_tx.resetStats();
+
+    for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE - 1; ++i)
+        TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&telemetry));
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_OK, can_tx.send(&torque)); // queued last
+    TEST_ASSERT_EQUAL(MCP2515::ERROR_ALLTXBUSY, can_tx.send(&telemetry));
+    TEST_ASSERT_EQUAL_UINT32(1, can_tx.getDropped());
+    TEST_ASSERT_EQUAL_UINT8(CAN_TX_QUEUE_SIZE, can_tx.getHighWater());
+
+    dropSent();
+    CanTx::service();
+    TEST_ASSERT_FALSE(can_tx.pending());
+    can_frame sent;
+    while (takeSent(sent) && sent.can_id == filler.can_id)
+        ;
+    TEST_ASSERT_EQUAL_HEX32(torque.can_id, sent.can_id); // sent first though queued last
+    for (uint8_t i = 0; i < CAN_TX_QUEUE_SIZE - 1; ++i)
+    {
+        TEST_ASSERT_TRUE(takeSent(sent));
+        TEST_ASSERT_EQUAL_HEX32(telemetry.can_id, sent.can_id);
+    }
+    can_tx.resetStats();
+}
+#endif
+
+void test_tick_benchmark(void)
+{
+    char msg[128];
+    unsigned long tick_us = 0;
+    for (uint16_t t = 0; t < BENCH_TICKS; ++t)
+    {
+        const unsigned long start = micros();
+        for (uint8_t i = 0; i < FRAMES_PER_TICK; ++i)
+            mcp.sendMessage(&frames[i]);
+        tick_us += micros() - start;
+        delay(1);
+        dropSent();
+    }
+    const unsigned long blocking_us = tick_us;
+
+    tick_us = 0;
+    unsigned long total_us = 0;
+    SpiStats::reset();
+    for (uint16_t t = 0; t < BENCH_TICKS; ++t)
+    {
+        const unsigned long start = micros();
+        for (uint8_t i = 0; i < FRAMES_PER_TICK; ++i)
+            can_tx.send(&frames[i]);
+        tick_us += micros() - start;
+        CanTx::waitIdle();
+        total_us += micros() - start;
+        delay(1);
+        dropSent();
+    }
+
+    snprintf(msg, sizeof(msg), "%u frames per tick, blocking sendMessage: %lu us per tick",
+             (unsigned)FRAMES_PER_TICK, blocking_us / BENCH_TICKS);
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "CanTx: %lu us per tick until send() returns, %lu us until SPI is idle",
+             tick_us / BENCH_TICKS, total_us / BENCH_TICKS);
+    TEST_MESSAGE(msg);
+    // sendMessage() clocks 17 + DLC bytes per frame, see CanTx::send() with CAN_TX_ASYNC 0
+    unsigned long blocking_bytes = 0;
+    for (uint8_t i = 0; i < FRAMES_PER_TICK; ++i)
+        blocking_bytes += 17 + frames[i].can_dlc;
+    const unsigned long spi_bytes = SpiStats::total().bytes / BENCH_TICKS;
+    snprintf(msg, sizeof(msg), "SPI bytes per tick: %lu blocking sendMessage, %lu CanTx", blocking_bytes, spi_bytes);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(tick_us < blocking_us);
+    TEST_ASSERT_TRUE(spi_bytes < blocking_bytes);
+}
+
+void setup()
+{
+    mcp.reset();
+    mcp.setBitrate(CAN_RATE, MCP2515_CRYSTAL_FREQ);
+    mcp.setLoopbackMode();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_unchanged);
+#if CAN_RX_FAST_SPI
+    RUN_TEST(test_rx_fast_path);
+#endif
+#ifndef __AVR__
+    RUN_TEST(test_priority_order);
+#endif
+    RUN_TEST(test_tick_benchmark);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
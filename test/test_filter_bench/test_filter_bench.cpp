@@ -0,0 +1,372 @@
+/**
+ * @file test_filter_bench.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks the FilterChain stages give the same output as ExponentialFilter and AverageFilter, that the median rejects spikes,
+ * that the low-passes designed from a cutoff have the gain and delay they were designed for, and compares their size and time per sample
+ * @version 1.3
+ * @date 2026-10-17
+ * @see SignalProcessing.hpp
+ *
+ * On the board the times are turned into CPU cycles per sample, natively into nanoseconds.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "SignalProcessing.hpp"
+
+#include <math.h>
+
+#ifndef __AVR__
+#include <chrono>
+#endif
+
+constexpr uint16_t NUM_SAMPLES = 256;  /**< Length of the test signal */
+constexpr uint16_t BENCH_ROUNDS = 40;  /**< Passes over the test signal for the benchmark */
+constexpr uint8_t AVERAGE_SIZE = 16;   /**< Window of the average filters */
+constexpr uint32_t DESIGN_HZ = 1000;   /**< Sample rate of the designed filters, as the pedal */
+constexpr uint32_t DESIGN_CHZ = 1500;  /**< Cutoff of the designed filters, 15 Hz */
+
+using OnePole = LowPassStage<DESIGN_HZ, DESIGN_CHZ, 12>;
+using Biquad = BiquadLowPassStage<DESIGN_HZ, DESIGN_CHZ, 12>;
+using Fir = FirLowPassStage<15, DESIGN_HZ, 3000, 12>; /**< 7 sample delay, 30 Hz as 15 taps can't roll off sooner */
+
+uint16_t signal_in[NUM_SAMPLES]; /**< 12 bit test signal, ramps with noise, see makeSignal() */
+volatile uint16_t sink;          /**< Keeps the benchmarked results alive */
+
+/**
+ * @brief Wall clock time, micros() is virtual on the native build.
+ * @return Microseconds.
+ */
+unsigned long benchMicros()
+{
+#ifdef __AVR__
+    return micros();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Fills signal_in with a 12 bit pedal sweep plus pseudo-random noise.
+ */
+void makeSignal()
+{
+    uint16_t lcg = 1;
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        lcg = lcg * 25173 + 13849;
+        signal_in[i] = 1300 + (i * 4) + (lcg >> 10) % 64;
+    }
+}
+
+/**
+ * @brief Time per sample of a filter over the benchmark, as a printable figure.
+ * @param us Microseconds for BENCH_ROUNDS * NUM_SAMPLES samples.
+ * @return CPU cycles per sample on the board, nanoseconds natively.
+ */
+unsigned long perSample(unsigned long us)
+{
+    constexpr unsigned long SAMPLES = static_cast<unsigned long>(BENCH_ROUNDS) * NUM_SAMPLES;
+#ifdef __AVR__
+    return us * (F_CPU / 1000000UL) / SAMPLES;
+#else
+    return us * 1000UL / SAMPLES;
+#endif
+}
+
+/**
+ * @brief Times BENCH_ROUNDS passes of the test signal through a filter.
+ * @tparam F Filter type, a Filter or a FilterStage.
+ * @param filter Filter to feed.
+ * @return Microseconds.
+ */
+template <typename F>
+unsigned long bench(F &filter)
+{
+    const unsigned long start = benchMicros();
+    for (uint16_t r = 0; r < BENCH_ROUNDS; ++r)
+    {
+        for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+        {
+            filter.addSample(signal_in[i]);
+            sink = filter.getFiltered();
+        }
+    }
+    return benchMicros() - start;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_ema_matches(void)
+{
+    ExponentialFilter<uint16_t, uint32_t> reference;
+    FilterChain<EmaStage<31, 1>> chain;
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        reference.addSample(signal_in[i]);
+        TEST_ASSERT_EQUAL_UINT16(reference.getFiltered(), chain.addSample(signal_in[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT16(sizeof(uint16_t), sizeof(chain)); // state only, no vtable pointer
+}
+
+void test_average_matches(void)
+{
+    AverageFilter<uint16_t, uint32_t, AVERAGE_SIZE> reference{};
+    AverageStage<AVERAGE_SIZE> stage;
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        reference.addSample(signal_in[i]);
+        TEST_ASSERT_EQUAL_UINT16(reference.getFiltered(), stage.addSample(signal_in[i]));
+    }
+}
+
+void test_chain_composes(void)
+{
+    EmaStage<3, 1> ema;
+    RateLimitStage<10> limit;
+    FilterChain<EmaStage<3, 1>, RateLimitStage<10>> chain;
+
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+        TEST_ASSERT_EQUAL_UINT16(limit.addSample(ema.addSample(signal_in[i])), chain.addSample(signal_in[i]));
+    TEST_ASSERT_EQUAL_UINT16(limit.getFiltered(), chain.getFiltered());
+
+    RateLimitStage<10> step;
+    step.addSample(100);
+    TEST_ASSERT_EQUAL_UINT16(110, step.addSample(500));
+    TEST_ASSERT_EQUAL_UINT16(100, step.addSample(0));
+    TEST_ASSERT_EQUAL_UINT16(95, step.addSample(95));
+}
+
+void test_median_matches_sort(void)
+{
+    MedianStage<5> stage;
+    uint16_t window[5];
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        const uint16_t out = stage.addSample(signal_in[i]);
+        // reference: sort a copy of the last 5 samples, the first repeated before there are 5
+        for (uint8_t k = 0; k < 5; ++k)
+            window[k] = signal_in[i >= 4 - k ? i - (4 - k) : 0];
+        for (uint8_t a = 1; a < 5; ++a)
+            for (uint8_t b = a; b > 0 && window[b - 1] > window[b]; --b)
+            {
+                const uint16_t t = window[b];
+                window[b] = window[b - 1];
+                window[b - 1] = t;
+            }
+        TEST_ASSERT_EQUAL_UINT16(window[2], out);
+    }
+
+    // a step comes through once it is the majority of the window, DELAY_US later
+    MedianStage<5, uint16_t, 1000> median_step;
+    median_step.addSample(0);
+    uint32_t late_us = 0;
+    while (median_step.addSample(1000) != 1000)
+        late_us += 1000;
+    TEST_ASSERT_EQUAL_UINT32(median_step.DELAY_US, late_us);
+}
+
+void test_median_rejects_spikes(void)
+{
+    ExponentialFilter<uint16_t, uint32_t> ema;
+    MedianEmaFilter<5, 15, 1> hybrid;
+    uint16_t ema_worst = 0;
+    uint16_t hybrid_worst = 0;
+    for (uint16_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        const bool spike = (i % 50 == 40) || (i % 50 == 41); // 2 sample EMI bursts to full scale
+        const uint16_t sample = spike ? 4095 : 2000;
+        ema.addSample(sample);
+        hybrid.addSample(sample);
+        if (i >= 200) // settled, and 4 bursts in
+        {
+            ema_worst = ema.getFiltered() - 2000 > ema_worst ? ema.getFiltered() - 2000 : ema_worst;
+            hybrid_worst = hybrid.getFiltered() - 2000 > hybrid_worst ? hybrid.getFiltered() - 2000 : hybrid_worst;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, hybrid_worst);
+    TEST_ASSERT_TRUE(ema_worst > 100); // 2 * 2095 / 32, near the 10% pedal fault margin once the 2 sensors disagree
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "2 sample spike: EMA 31:1 +%u, median 5 + EMA 15:1 +%u", ema_worst, hybrid_worst);
+    TEST_MESSAGE(msg);
+}
+
+/**
+ * @brief Checks a designed stage settles on a constant exactly, and lags a slow ramp by its DELAY_US.
+ * @tparam F Stage type.
+ */
+template <typename F>
+void checkDcAndDelay()
+{
+    F filter;
+    for (uint16_t i = 0; i < 2000; ++i)
+        filter.addSample(3000);
+    TEST_ASSERT_EQUAL_UINT16(3000, filter.getFiltered());
+
+    // ramp 2 LSB per sample, from 100 so the start is settled; the lag in samples is the delay at DC
+    F ramp;
+    uint16_t out = 0;
+    for (uint16_t i = 0; i < 1000; ++i)
+        out = ramp.addSample(100 + 2 * i);
+    const int32_t lag_us = static_cast<int32_t>((100 + 2 * 999 - out) * 1000000L / 2 / DESIGN_HZ);
+    TEST_ASSERT_INT32_WITHIN(1000000L / DESIGN_HZ, static_cast<int32_t>(F::DELAY_US), lag_us);
+}
+
+/**
+ * @brief Peak to peak output of a designed stage for a sine, after it settles.
+ * @tparam F Stage type.
+ * @param freq_hz Frequency of the sine.
+ * @return Output peak to peak, the input is 2000.
+ */
+template <typename F>
+uint16_t sineResponse(uint16_t freq_hz)
+{
+    F filter;
+    uint16_t low = 0xFFFF;
+    uint16_t high = 0;
+    for (uint16_t i = 0; i < 2000; ++i)
+    {
+        const uint16_t out = filter.addSample(static_cast<uint16_t>(2048 + 1000 * sin(2 * M_PI * freq_hz * i / DESIGN_HZ)));
+        if (i >= 1000)
+        {
+            low = out < low ? out : low;
+            high = out > high ? out : high;
+        }
+    }
+    return high - low;
+}
+
+void test_designed_filters(void)
+{
+    checkDcAndDelay<OnePole>();
+    checkDcAndDelay<Biquad>();
+    checkDcAndDelay<Fir>();
+
+    // the same delay buys the biquad a faster roll-off than the one pole
+    const uint16_t one_pole_pass = sineResponse<OnePole>(2);
+    const uint16_t one_pole_stop = sineResponse<OnePole>(100);
+    const uint16_t biquad_pass = sineResponse<Biquad>(2);
+    const uint16_t biquad_stop = sineResponse<Biquad>(100);
+    const uint16_t fir_stop = sineResponse<Fir>(250); // past the ~3.3 * fs / TAPS = 220 Hz wide transition band of 15 taps
+    TEST_ASSERT_UINT16_WITHIN(60, 2000, one_pole_pass);
+    TEST_ASSERT_UINT16_WITHIN(60, 2000, biquad_pass);
+    TEST_ASSERT_TRUE(biquad_stop < 2000 / 40); // 2nd order, -33dB at 6.7x the cutoff
+    TEST_ASSERT_TRUE(one_pole_stop < 2000 / 5);
+    TEST_ASSERT_TRUE(biquad_stop < one_pole_stop / 4);
+    TEST_ASSERT_TRUE(fir_stop < 2000 / 20);
+
+    // a full scale step overshoots the biquad by ~4%, clamped at the input range
+    Biquad step;
+    step.addSample(0);
+    uint16_t peak = 0;
+    for (uint16_t i = 0; i < 500; ++i)
+    {
+        const uint16_t out = step.addSample(4095);
+        peak = out > peak ? out : peak;
+    }
+    TEST_ASSERT_EQUAL_UINT16(4095, peak);
+    TEST_ASSERT_EQUAL_UINT16(4095, step.getFiltered());
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "15 Hz at 1 kHz: one pole %lu us, biquad %lu us, 15 tap FIR (30 Hz) %lu us delay",
+             (unsigned long)OnePole::DELAY_US, (unsigned long)Biquad::DELAY_US, (unsigned long)Fir::DELAY_US);
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "2000 p-p in: 100 Hz one pole %u, biquad %u, 250 Hz FIR %u p-p out", one_pole_stop, biquad_stop, fir_stop);
+    TEST_MESSAGE(msg);
+}
+
+void test_filter_benchmark(void)
+{
+    ExponentialFilter<uint16_t, uint32_t> ema_virtual_target;
+    Filter<uint16_t, uint32_t> *volatile ema_virtual = &ema_virtual_target; // call through the base, as a generic caller would
+    ExponentialFilter<uint16_t, uint32_t> ema_direct;
+    FilterChain<EmaStage<31, 1>> ema_chain;
+    AverageFilter<uint16_t, uint32_t, AVERAGE_SIZE> average{};
+    AverageStage<AVERAGE_SIZE> average_stage;
+    FilterChain<AverageStage<4>, EmaStage<15, 1>, RateLimitStage<64>> pipeline;
+    MedianStage<5> median;
+    MedianEmaFilter<5, 15, 1> median_ema;
+    OnePole one_pole;
+    Biquad biquad;
+    Fir fir;
+
+    const unsigned long virtual_us = bench(*ema_virtual);
+    const unsigned long direct_us = bench(ema_direct);
+    const unsigned long chain_us = bench(ema_chain);
+    const unsigned long average_us = bench(average);
+    const unsigned long average_stage_us = bench(average_stage);
+    const unsigned long pipeline_us = bench(pipeline);
+    const unsigned long median_us = bench(median);
+    const unsigned long median_ema_us = bench(median_ema);
+    const unsigned long one_pole_us = bench(one_pole);
+    const unsigned long biquad_us = bench(biquad);
+    const unsigned long fir_us = bench(fir);
+
+    char msg[96];
+#ifdef __AVR__
+    const char *unit = "cycles";
+#else
+    const char *unit = "ns";
+#endif
+    snprintf(msg, sizeof(msg), "ExponentialFilter via Filter*: %lu %s/sample, %u bytes", perSample(virtual_us), unit, (unsigned)sizeof(ema_virtual_target));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "ExponentialFilter direct:      %lu %s/sample, %u bytes", perSample(direct_us), unit, (unsigned)sizeof(ema_direct));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "FilterChain<EmaStage>:         %lu %s/sample, %u bytes", perSample(chain_us), unit, (unsigned)sizeof(ema_chain));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "AverageFilter<%u>:             %lu %s/sample, %u bytes", AVERAGE_SIZE, perSample(average_us), unit, (unsigned)sizeof(average));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "AverageStage<%u>:              %lu %s/sample, %u bytes", AVERAGE_SIZE, perSample(average_stage_us), unit, (unsigned)sizeof(average_stage));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "Average<4>, Ema<15,1>, RateLimit<64>: %lu %s/sample, %u bytes", perSample(pipeline_us), unit, (unsigned)sizeof(pipeline));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "MedianStage<5>:                %lu %s/sample, %u bytes", perSample(median_us), unit, (unsigned)sizeof(median));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "MedianEmaFilter<5, 15, 1>:     %lu %s/sample, %u bytes", perSample(median_ema_us), unit, (unsigned)sizeof(median_ema));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "LowPassStage (one pole):       %lu %s/sample, %u bytes", perSample(one_pole_us), unit, (unsigned)sizeof(one_pole));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "BiquadLowPassStage:            %lu %s/sample, %u bytes", perSample(biquad_us), unit, (unsigned)sizeof(biquad));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "FirLowPassStage<15>:           %lu %s/sample, %u bytes", perSample(fir_us), unit, (unsigned)sizeof(fir));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(sizeof(ema_chain) < sizeof(ema_direct));
+}
+
+void setup()
+{
+    makeSignal();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_ema_matches);
+    RUN_TEST(test_average_matches);
+    RUN_TEST(test_chain_composes);
+    RUN_TEST(test_median_matches_sort);
+    RUN_TEST(test_median_rejects_spikes);
+    RUN_TEST(test_designed_filters);
+    RUN_TEST(test_filter_benchmark);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file test_scheduler_bench.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks StaticScheduler runs the same tasks as Scheduler, and compares their size and dispatch time
+ * @version 1.4
+ * @date 2026-10-17
+ * @see StaticScheduler.hpp, Scheduler.hpp
+ *
+ */
+// time only the dispatch, without the stats
+#define SCHEDULER_STATS 0
+
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "Scheduler.hpp"
+#include "StaticScheduler.hpp"
+
+#ifndef __AVR__
+#include <chrono>
+#endif
+
+constexpr uint16_t TRACE_LEN = 512;    /**< Task runs recorded per scheduler */
+constexpr uint16_t TEST_TICKS = 100;   /**< Ticks compared for equivalence */
+constexpr uint16_t BENCH_TICKS = 1000; /**< Ticks timed for the benchmark */
+
+constexpr LaneIndex LANE_MOTOR = 0; /**< All three controllers in use, so the lanes follow McpIndex */
+constexpr LaneIndex LANE_DL = 2;    /**< Datalogger lane */
+
+uint8_t trace[TRACE_LEN]; /**< Task ids in run order */
+uint16_t trace_len = 0;
+
+void record(uint8_t id)
+{
+    if (trace_len < TRACE_LEN)
+        trace[trace_len++] = id;
+}
+
+void taskA() { record(0); }
+void taskB() { record(1); }
+void taskC() { record(2); }
+void taskD() { record(3); }
+void taskE() { record(4); }
+
+/**
+ * @brief Wall clock time, micros() is virtual on the native build.
+ * @return Microseconds.
+ */
+unsigned long benchMicros()
+{
+#ifdef __AVR__
+    return micros();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// same task set as main.cpp: one task on the motor bus, telemetry every tick, every 10 and every 5 ticks
+Scheduler<3, 3> dynamic_scheduler(10000, 0);
+StaticScheduler<10000, 0,
+                StaticTask<taskA, 1, LANE_MOTOR>,
+                StaticTask<taskB, 1, LANE_DL>,
+                StaticTask<taskC, 10, LANE_DL, 3>,
+                StaticTask<taskD, 5, LANE_DL, 0>>
+    static_scheduler;
+static_assert(decltype(static_scheduler)::hyperperiod() == 10, "hyperperiod is the LCM of the intervals");
+
+// runtime tasks stay on a Scheduler, ticked from the StaticScheduler
+Scheduler<2, 1> runtime_scheduler(10000, 0);
+void runtimeTick() { runtime_scheduler.runTick(*micros); }
+StaticScheduler<10000, 0,
+                StaticTask<taskA, 1, LANE_MOTOR>,
+                StaticTask<runtimeTick, 1, LANE_MOTOR>>
+    mixed_scheduler;
+
+void setUp(void)
+{
+    trace_len = 0;
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_static_matches_dynamic(void)
+{
+    dynamic_scheduler.addTask(LANE_MOTOR, taskA, 1, TaskPriority::Normal, 0);
+    dynamic_scheduler.addTask(LANE_DL, taskB, 1, TaskPriority::Normal, 0);
+    dynamic_scheduler.addTask(LANE_DL, taskC, 10, TaskPriority::Normal, 3);
+    dynamic_scheduler.addTask(LANE_DL, taskD, 5, TaskPriority::Normal, 0);
+
+    uint8_t dynamic_trace[TRACE_LEN];
+    for (uint16_t i = 0; i < TEST_TICKS; ++i)
+        dynamic_scheduler.runTick(*micros);
+    const uint16_t dynamic_len = trace_len;
+    for (uint16_t i = 0; i < dynamic_len; ++i)
+        dynamic_trace[i] = trace[i];
+
+    trace_len = 0;
+    for (uint16_t i = 0; i < TEST_TICKS; ++i)
+        static_scheduler.runTick();
+
+    TEST_ASSERT_EQUAL_UINT16(TEST_TICKS * 2 + TEST_TICKS / 10 + TEST_TICKS / 5, dynamic_len);
+    TEST_ASSERT_EQUAL_UINT16(dynamic_len, trace_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(dynamic_trace, trace, dynamic_len);
+}
+
+void test_static_drives_runtime_tasks(void)
+{
+    TEST_ASSERT_TRUE(runtime_scheduler.addTask(LANE_MOTOR, taskE, 2));
+    for (uint16_t i = 0; i < TEST_TICKS; ++i)
+        mixed_scheduler.runTick();
+    TEST_ASSERT_EQUAL_UINT16(TEST_TICKS + TEST_TICKS / 2, trace_len);
+
+    trace_len = 0;
+    TEST_ASSERT_TRUE(runtime_scheduler.removeTask(LANE_MOTOR, taskE));
+    for (uint16_t i = 0; i < TEST_TICKS; ++i)
+        mixed_scheduler.runTick();
+    TEST_ASSERT_EQUAL_UINT16(TEST_TICKS, trace_len);
+}
+
+void test_dispatch_benchmark(void)
+{
+    char msg[96];
+    unsigned long start = benchMicros();
+    for (uint16_t i = 0; i < BENCH_TICKS; ++i)
+        dynamic_scheduler.runTick(*benchMicros);
+    const unsigned long dynamic_us = benchMicros() - start;
+
+    start = benchMicros();
+    for (uint16_t i = 0; i < BENCH_TICKS; ++i)
+        static_scheduler.runTick();
+    const unsigned long static_us = benchMicros() - start;
+
+    snprintf(msg, sizeof(msg), "SRAM: Scheduler<3, 3> %u bytes, StaticScheduler %u bytes",
+             (unsigned)sizeof(dynamic_scheduler), (unsigned)sizeof(static_scheduler));
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "%u ticks: Scheduler %lu us, StaticScheduler %lu us",
+             (unsigned)BENCH_TICKS, dynamic_us, static_us);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(sizeof(static_scheduler) < sizeof(dynamic_scheduler));
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_static_matches_dynamic);
+    RUN_TEST(test_static_drives_runtime_tasks);
+    RUN_TEST(test_dispatch_benchmark);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file test_scheduler_budget.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks the Scheduler tick budget: Critical tasks run past it, other tasks are deferred to the next period and keep their phase
+ * @version 1.0
+ * @date 2026-10-17
+ * @see Scheduler.hpp
+ *
+ * Native only, the tasks burn virtual time with NativeHost::advanceMicros() to use up the budget.
+ */
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHost.hpp"
+#include "Scheduler.hpp"
+
+constexpr uint32_t PERIOD_US = 10000; /**< Scheduler period */
+constexpr uint32_t BUDGET_US = 100;   /**< Tick budget for non-Critical tasks */
+constexpr uint32_t BURN_US = 150;     /**< Time the Critical task takes when burning, over the budget */
+constexpr uint8_t MAX_RUNS = 16;      /**< Runs recorded per task */
+
+Scheduler<2, 1> scheduler(PERIOD_US, 0);
+
+bool burn = false;          /**< Critical task uses up the budget */
+uint8_t critical_runs = 0;  /**< Runs of the Critical task */
+uint32_t normal_ticks[MAX_RUNS]; /**< Ticks the Normal task ran in */
+uint8_t normal_runs = 0;    /**< Runs of the Normal task */
+
+void criticalTask()
+{
+    ++critical_runs;
+    if (burn)
+        NativeHost::advanceMicros(BURN_US);
+}
+
+void normalTask()
+{
+    if (normal_runs < MAX_RUNS)
+        normal_ticks[normal_runs++] = scheduler.getTicks() - 1; // the tick being run, getTicks() already counts it
+}
+
+/**
+ * @brief Moves the virtual clock on until the scheduler has run ticks more ticks.
+ * @param ticks Ticks to run.
+ */
+void runTicks(const uint8_t ticks)
+{
+    for (uint8_t i = 0; i < ticks; ++i)
+    {
+        const uint32_t before = scheduler.getTicks();
+        while (scheduler.getTicks() == before)
+        {
+            NativeHost::advanceMicros(100);
+            scheduler.update(*micros);
+        }
+    }
+}
+
+void setUp(void)
+{
+    // set stuff up here
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_deferred_run_keeps_phase(void)
+{
+    NativeHost::reset();
+    scheduler.synchronize(*micros);
+    scheduler.setTickBudget(BUDGET_US);
+    TEST_ASSERT_TRUE(scheduler.addTask(0, criticalTask, 1, TaskPriority::Critical));
+    TEST_ASSERT_TRUE(scheduler.addTask(0, normalTask, 5, TaskPriority::Normal, 2));
+
+    runTicks(12); // ticks 0 to 11, within budget
+    TEST_ASSERT_EQUAL_UINT8(12, critical_runs);
+    TEST_ASSERT_EQUAL_UINT8(2, normal_runs);
+    TEST_ASSERT_EQUAL_UINT32(2, normal_ticks[0]);
+    TEST_ASSERT_EQUAL_UINT32(7, normal_ticks[1]);
+    TEST_ASSERT_EQUAL_UINT16(0, scheduler.getDeferrals());
+
+    burn = true;
+    runTicks(2); // ticks 12 and 13, the Normal task is due in 12 but the Critical task used up the budget
+    TEST_ASSERT_EQUAL_UINT8(14, critical_runs);
+    TEST_ASSERT_EQUAL_UINT8(2, normal_runs);
+    TEST_ASSERT_EQUAL_UINT16(2, scheduler.getDeferrals());
+
+    burn = false;
+    runTicks(10); // ticks 14 to 23: the retry in 14, then back on phase 2
+    TEST_ASSERT_EQUAL_UINT8(24, critical_runs);
+    TEST_ASSERT_EQUAL_UINT8(5, normal_runs);
+    TEST_ASSERT_EQUAL_UINT32(14, normal_ticks[2]);
+    TEST_ASSERT_EQUAL_UINT32(17, normal_ticks[3]);
+    TEST_ASSERT_EQUAL_UINT32(22, normal_ticks[4]);
+    TEST_ASSERT_EQUAL_UINT16(2, scheduler.getDeferrals());
+
+#if SCHEDULER_STATS
+    uint16_t values[3];
+    TEST_ASSERT_EQUAL_UINT8(scheduler.STATS_MUX_BUDGET, scheduler.getStatsEntry(2, values));
+    TEST_ASSERT_EQUAL_UINT16(2, values[0]);
+    TEST_ASSERT_EQUAL_UINT16(BUDGET_US, values[1]);
+    TEST_ASSERT_EQUAL_UINT16(2, values[2]); // deferred for two ticks in a row
+#endif
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_deferred_run_keeps_phase);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
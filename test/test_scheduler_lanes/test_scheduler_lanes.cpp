@@ -0,0 +1,85 @@
+/**
+ * @file test_scheduler_lanes.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks the Scheduler balances phases per lane, and that CanChannelMap numbers lanes over the controllers in use
+ * @version 1.0
+ * @date 2026-10-17
+ * @see Scheduler.hpp, CanChannel.hpp
+ *
+ */
+#define SCHEDULER_STATS 0
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Scheduler.hpp"
+#include "CanChannel.hpp"
+
+constexpr LaneIndex LANE_MOTOR = 0; /**< Motor lane */
+constexpr LaneIndex LANE_BMS = 1;   /**< BMS lane */
+
+void taskA() {}
+void taskB() {}
+void taskC() {}
+
+// two lanes, e.g. two controllers in use, see CanChannelMap
+Scheduler<2, 2> lane_scheduler(10000, 0);
+
+// everything on the datalogger controller, as with a board that only has that transceiver fitted
+constexpr CanChannelMap DL_ONLY = {{McpIndex::Datalogger, McpIndex::Datalogger, McpIndex::Datalogger, McpIndex::Datalogger}};
+// motor and BMS controllers, the datalogger and debug buses on the BMS one
+constexpr CanChannelMap NO_DL = {{McpIndex::Motor, McpIndex::Bms, McpIndex::Bms, McpIndex::Bms}};
+
+static_assert(DL_ONLY.controllers() == 1 && DL_ONLY.lane(CanBus::Motor) == 0, "one controller in use is lane 0");
+static_assert(NO_DL.controllers() == 2 && NO_DL.lane(CanBus::Datalogger) == 1, "the BMS controller is the second lane");
+
+void setUp(void)
+{
+    // set stuff up here
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_phase_balances_per_lane(void)
+{
+    TEST_ASSERT_TRUE(lane_scheduler.addTask(LANE_MOTOR, taskA, 2, TaskPriority::Normal, 0));
+    TEST_ASSERT_TRUE(lane_scheduler.addTask(LANE_BMS, taskB, 2, TaskPriority::Normal, 1));
+    // both phases have one task over all lanes, only phase 1 is free on the motor lane
+    TEST_ASSERT_TRUE(lane_scheduler.addTask(LANE_MOTOR, taskC, 2));
+    TEST_ASSERT_TRUE(lane_scheduler.firesAt(LANE_MOTOR, 1, 1));
+    TEST_ASSERT_EQUAL_UINT8(1, lane_scheduler.tickLoad(LANE_MOTOR, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, lane_scheduler.tickLoad(LANE_MOTOR, 1));
+    TEST_ASSERT_EQUAL_UINT8(2, lane_scheduler.tickLoad(1));
+}
+
+void test_lane_out_of_range(void)
+{
+    TEST_ASSERT_FALSE(lane_scheduler.addTask(2, taskA, 1));
+    TEST_ASSERT_FALSE(lane_scheduler.firesAt(2, 0, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, lane_scheduler.tickLoad(2, 0));
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_phase_balances_per_lane);
+    RUN_TEST(test_lane_out_of_range);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file test_scheduler_timebase.cpp
+ * @author Planeson, Red Bird Racing
+ * @brief Checks the Scheduler timebase counts missed sub-ticks without running them, in update() and updateTimerTick(), and across the micros() wrap
+ * @version 1.0
+ * @date 2026-10-17
+ * @see Scheduler.hpp
+ *
+ * Native only, the virtual clock is moved with NativeHost::advanceMicros() to make the scheduler late.
+ */
+#define SCHEDULER_TIMER_TICK 1
+
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHost.hpp"
+#include "Scheduler.hpp"
+
+constexpr uint32_t PERIOD_US = 10000; /**< Scheduler period */
+constexpr uint8_t SUB_TICKS = 4;      /**< Sub-ticks per period, 2.5ms so nowMs() has a remainder to carry */
+constexpr uint32_t TICK_US = PERIOD_US / SUB_TICKS;
+constexpr uint32_t WRAP_START_US = 0xFFFFFFFFUL - 3 * TICK_US; /**< micros() a few sub-ticks before it wraps */
+
+Scheduler<1, 1, 1> loop_scheduler(PERIOD_US, 0, SUB_TICKS);  /**< Driven by update() */
+Scheduler<1, 1, 1> timer_scheduler(PERIOD_US, 0, SUB_TICKS); /**< Driven by updateTimerTick() */
+Scheduler<1, 1, 1> wrap_scheduler(PERIOD_US, 0, SUB_TICKS);  /**< Driven by update() across the micros() wrap */
+Scheduler<1, 1, 1> wrap_timer_scheduler(PERIOD_US, 0, SUB_TICKS); /**< Driven by updateTimerTick() across the micros() wrap */
+
+uint16_t runs = 0; /**< Runs of the fast lane task, once per sub-tick that ran */
+
+void countRun() { ++runs; }
+
+/**
+ * @brief Checks the timebase of a scheduler.
+ * @param scheduler Scheduler to check.
+ * @param ticks Sub-ticks it should have counted.
+ */
+void checkTimebase(const Scheduler<1, 1, 1> &scheduler, const uint32_t ticks)
+{
+    TEST_ASSERT_EQUAL_UINT32(ticks, scheduler.getTicks());
+    TEST_ASSERT_EQUAL_UINT32(ticks * TICK_US / 1000, scheduler.nowMs());
+}
+
+/**
+ * @brief Moves the virtual clock on, then updates the scheduler once.
+ * @param scheduler Scheduler to update.
+ * @param us Microseconds to move the clock on.
+ * @param timer Use updateTimerTick() instead of update().
+ */
+void step(Scheduler<1, 1, 1> &scheduler, const uint32_t us, const bool timer)
+{
+    NativeHost::advanceMicros(us);
+    if (timer)
+        scheduler.updateTimerTick(*micros);
+    else
+        scheduler.update(*micros);
+}
+
+/**
+ * @brief Runs a scheduler on time, late by a few sub-ticks, then on time again, checking the timebase after each.
+ * @param scheduler Scheduler, started on the current time.
+ * @param timer Use updateTimerTick() instead of update().
+ */
+void runLate(Scheduler<1, 1, 1> &scheduler, const bool timer)
+{
+    TEST_ASSERT_TRUE(scheduler.addFastTask(countRun));
+    runs = 0;
+
+    step(scheduler, TICK_US, timer);
+    step(scheduler, TICK_US, timer);
+    checkTimebase(scheduler, 2);
+    TEST_ASSERT_EQUAL_UINT16(2, runs);
+
+    step(scheduler, 4 * TICK_US + 100, timer); // 3 sub-ticks missed, only the last one runs
+    checkTimebase(scheduler, 6);
+    TEST_ASSERT_EQUAL_UINT16(3, runs);
+
+    step(scheduler, TICK_US, timer);
+    step(scheduler, TICK_US, timer);
+    checkTimebase(scheduler, 8);
+    TEST_ASSERT_EQUAL_UINT16(5, runs);
+}
+
+void setUp(void)
+{
+    // set stuff up here
+}
+
+void tearDown(void)
+{
+    // runs after each test
+    // optional in the sense that this can be empty
+    // to ensure it compiles on all platforms, do not remove this empty function
+}
+
+void test_update_counts_missed(void)
+{
+    NativeHost::reset();
+    loop_scheduler.synchronize(*micros);
+    runLate(loop_scheduler, false);
+}
+
+void test_timer_tick_counts_missed(void)
+{
+    NativeHost::reset();
+    TEST_ASSERT_TRUE(timer_scheduler.beginTimerTick());
+    timer_scheduler.synchronize(*micros);
+    runLate(timer_scheduler, true);
+}
+
+void test_update_across_wrap(void)
+{
+    NativeHost::reset();
+    NativeHost::advanceMicros(WRAP_START_US);
+    wrap_scheduler.synchronize(*micros);
+    runLate(wrap_scheduler, false); // the late step crosses the wrap
+    TEST_ASSERT_TRUE(static_cast<uint32_t>(NativeHost::now()) < WRAP_START_US);
+}
+
+void test_timer_tick_across_wrap(void)
+{
+    NativeHost::reset();
+    NativeHost::advanceMicros(WRAP_START_US);
+    TEST_ASSERT_TRUE(wrap_timer_scheduler.beginTimerTick());
+    wrap_timer_scheduler.synchronize(*micros);
+    runLate(wrap_timer_scheduler, true);
+    TEST_ASSERT_TRUE(static_cast<uint32_t>(NativeHost::now()) < WRAP_START_US);
+}
+
+void setup()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_update_counts_missed);
+    RUN_TEST(test_timer_tick_counts_missed);
+    RUN_TEST(test_update_across_wrap);
+    RUN_TEST(test_timer_tick_across_wrap);
+    UNITY_END();
+}
+
+void loop()
+{
+    // not used
+}
+
+#ifndef ARDUINO
+int main()
+{
+    setup();
+    return 0;
+}
+#endif